@@ -40,6 +40,7 @@
 #include "Account.h"
 #include "Query.h"
 #include "gnc-engine.h"
+#include "gnc-event.h"
 #include "engine-helpers.h"
 #include "gnc-prefs.h"
 #include "gnc-ui-util.h"
@@ -104,6 +105,36 @@ struct _transactioninfo
     guint32 ref_id;
 };
 
+typedef struct
+{
+    time64 date;
+    Split *split;
+    /* To tell whether split is still there: events are suspended at
+     * times, e.g. while a transaction is cloned or a book destroyed, so
+     * the index doesn't hear of every change. */
+    GncGUID guid;
+    guint serial;
+} MatchCandidate;
+
+typedef struct
+{
+    /* MatchCandidates sorted by date posted. A split's candidate is
+     * only live while members maps the split to its serial, so removing
+     * a split needn't search for it. */
+    GArray *candidates;
+    GHashTable *members;
+    /* The range of dates posted loaded so far. */
+    time64 start, end;
+} MatchAccount;
+
+struct _match_index
+{
+    /* Account -> MatchAccount */
+    GHashTable *accounts;
+    guint next_serial;
+    gint handler_id;
+};
+
 /* Some simple getters and setters for the above data types. */
 
 GList *
@@ -802,18 +833,310 @@ static void split_find_match (GNCImportTransInfo * trans_info,
 }/* end split_find_match */
 
 
+/********************************************************************\
+ *   Candidate index                                                *
+\********************************************************************/
+
+static gint
+compare_candidates (gconstpointer a, gconstpointer b)
+{
+    const MatchCandidate *ca = a, *cb = b;
+    return (ca->date < cb->date) ? -1 : (ca->date > cb->date) ? 1 : 0;
+}
+
+/* The position of the first candidate posted on or after date. */
+static guint
+match_index_lower_bound (GArray *candidates, time64 date)
+{
+    guint lo = 0, hi = candidates->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (g_array_index (candidates, MatchCandidate, mid).date < date)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void
+match_index_insert (GNCImportMatchIndex *match_index,
+                    MatchAccount *match_account, Split *split)
+{
+    Transaction *trans = xaccSplitGetParent (split);
+    MatchCandidate candidate;
+
+    if (!trans)
+        return;
+    candidate.date = xaccTransGetDate (trans);
+    /* Splits outside the loaded range come with the query that loads
+     * their dates. */
+    if (candidate.date < match_account->start ||
+        candidate.date > match_account->end)
+        return;
+    candidate.split = split;
+    candidate.guid = *xaccSplitGetGUID (split);
+    candidate.serial = ++match_index->next_serial;
+    g_array_insert_val (match_account->candidates,
+                        match_index_lower_bound (match_account->candidates,
+                                                 candidate.date),
+                        candidate);
+    g_hash_table_insert (match_account->members, split,
+                         GUINT_TO_POINTER (candidate.serial));
+}
+
+static void
+match_index_remove (MatchAccount *match_account, Split *split)
+{
+    g_hash_table_remove (match_account->members, split);
+}
+
+static gboolean
+match_candidate_live (MatchAccount *match_account, Account *account,
+                      const MatchCandidate *candidate)
+{
+    Split *split;
+
+    if (GPOINTER_TO_UINT (g_hash_table_lookup (match_account->members,
+                                               candidate->split))
+        != candidate->serial)
+        return FALSE;
+    split = xaccSplitLookup (&candidate->guid, gnc_account_get_book (account));
+    return split == candidate->split &&
+        xaccSplitGetAccount (split) == account &&
+        xaccSplitGetParent (split) &&
+        xaccTransGetDate (xaccSplitGetParent (split)) == candidate->date;
+}
+
+/* Drop the candidates that are no longer live once they outnumber the
+ * live ones. */
+static void
+match_index_compact (MatchAccount *match_account, Account *account)
+{
+    GArray *candidates = match_account->candidates;
+    guint i, live = 0;
+
+    if (candidates->len / 2 < g_hash_table_size (match_account->members))
+        return;
+    for (i = 0; i < candidates->len; i++)
+    {
+        MatchCandidate *candidate = &g_array_index (candidates,
+                                                    MatchCandidate, i);
+        if (match_candidate_live (match_account, account, candidate))
+            g_array_index (candidates, MatchCandidate, live++) = *candidate;
+        else if (GPOINTER_TO_UINT (g_hash_table_lookup (match_account->members,
+                                                        candidate->split))
+                 == candidate->serial)
+            g_hash_table_remove (match_account->members, candidate->split);
+    }
+    g_array_set_size (candidates, live);
+}
+
+/* Add the account's splits posted from start to end to its candidates,
+ * through a query so that a backend loading on demand loads them. */
+static void
+match_index_load (GNCImportMatchIndex *match_index,
+                  MatchAccount *match_account, Account *account,
+                  time64 start, time64 end)
+{
+    QofQuery *query = qof_query_create_for (GNC_ID_SPLIT);
+    GList *node;
+
+    qof_query_set_book (query, gnc_account_get_book (account));
+    xaccQueryAddSingleAccountMatch (query, account, QOF_QUERY_AND);
+    xaccQueryAddDateMatchTT (query, TRUE, start, TRUE, end, QOF_QUERY_AND);
+    for (node = qof_query_run (query); node; node = node->next)
+    {
+        Split *split = node->data;
+        Transaction *trans = xaccSplitGetParent (split);
+        MatchCandidate candidate;
+
+        if (!trans || g_hash_table_contains (match_account->members, split))
+            continue;
+        candidate.date = xaccTransGetDate (trans);
+        candidate.split = split;
+        candidate.guid = *xaccSplitGetGUID (split);
+        candidate.serial = ++match_index->next_serial;
+        g_array_append_val (match_account->candidates, candidate);
+        g_hash_table_insert (match_account->members, split,
+                             GUINT_TO_POINTER (candidate.serial));
+    }
+    qof_query_destroy (query);
+    g_array_sort (match_account->candidates, compare_candidates);
+}
+
+/* The account's entry, with at least the splits posted from start to
+ * end loaded. When the range has to grow, it grows by at least what
+ * is loaded already, so that a statement's worth of windows costs only
+ * a few queries. */
+static MatchAccount *
+match_index_get_account (GNCImportMatchIndex *match_index, Account *account,
+                         time64 start, time64 end)
+{
+    MatchAccount *match_account = g_hash_table_lookup (match_index->accounts,
+                                                       account);
+    time64 span;
+
+    if (!match_account)
+    {
+        match_account = g_new0 (MatchAccount, 1);
+        match_account->candidates = g_array_new (FALSE, FALSE,
+                                                 sizeof (MatchCandidate));
+        match_account->members = g_hash_table_new (g_direct_hash,
+                                                   g_direct_equal);
+        match_account->start = start;
+        match_account->end = end;
+        g_hash_table_insert (match_index->accounts, account, match_account);
+        match_index_load (match_index, match_account, account, start, end);
+        return match_account;
+    }
+
+    match_index_compact (match_account, account);
+    span = match_account->end - match_account->start;
+    if (start < match_account->start)
+    {
+        time64 load_start = MIN (start, match_account->start - span);
+        match_index_load (match_index, match_account, account,
+                          load_start, match_account->start - 1);
+        match_account->start = load_start;
+    }
+    if (end > match_account->end)
+    {
+        time64 load_end = MAX (end, match_account->end + span);
+        match_index_load (match_index, match_account, account,
+                          match_account->end + 1, load_end);
+        match_account->end = load_end;
+    }
+    return match_account;
+}
+
+static gboolean
+match_index_account_in_book (gpointer key, gpointer value, gpointer user_data)
+{
+    return gnc_account_get_book (key) == user_data;
+}
+
+/* Keep the candidates of the accounts seen so far in step with the
+ * book. */
+static void
+match_index_event_handler (QofInstance *entity, QofEventId event_type,
+                           gpointer user_data, gpointer event_data)
+{
+    GNCImportMatchIndex *match_index = user_data;
+    MatchAccount *match_account;
+
+    /* The book's instances go without events of their own. */
+    if (QOF_IS_BOOK (entity) && event_type == QOF_EVENT_DESTROY)
+    {
+        g_hash_table_foreach_remove (match_index->accounts,
+                                     match_index_account_in_book, entity);
+        return;
+    }
+    if (!GNC_IS_ACCOUNT (entity))
+        return;
+    match_account = g_hash_table_lookup (match_index->accounts, entity);
+    if (!match_account)
+        return;
+
+    switch (event_type)
+    {
+    case GNC_EVENT_ITEM_ADDED:
+    case GNC_EVENT_ITEM_CHANGED:
+        /* The parent transaction was committed; its date may differ. */
+        match_index_remove (match_account, event_data);
+        match_index_insert (match_index, match_account, event_data);
+        break;
+    case GNC_EVENT_ITEM_REMOVED:
+        match_index_remove (match_account, event_data);
+        break;
+    case QOF_EVENT_DESTROY:
+        g_hash_table_remove (match_index->accounts, entity);
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+match_index_free_account (gpointer data)
+{
+    MatchAccount *match_account = data;
+
+    g_array_free (match_account->candidates, TRUE);
+    g_hash_table_destroy (match_account->members);
+    g_free (match_account);
+}
+
+GNCImportMatchIndex *
+gnc_import_MatchIndex_new (void)
+{
+    GNCImportMatchIndex *match_index = g_new0 (GNCImportMatchIndex, 1);
+
+    match_index->accounts = g_hash_table_new_full (g_direct_hash,
+                                                   g_direct_equal, NULL,
+                                                   match_index_free_account);
+    match_index->handler_id =
+        qof_event_register_handler (match_index_event_handler, match_index);
+    return match_index;
+}
+
+void
+gnc_import_MatchIndex_delete (GNCImportMatchIndex *match_index)
+{
+    if (!match_index)
+        return;
+    qof_event_unregister_handler (match_index->handler_id);
+    g_hash_table_destroy (match_index->accounts);
+    g_free (match_index);
+}
+
 /** /brief Iterate through all splits of the originating account of the given
    transaction, and find all matching splits there. */
 void gnc_import_find_split_matches(GNCImportTransInfo *trans_info,
                                    gint process_threshold,
                                    double fuzzy_amount_difference,
-                                   gint match_date_hardlimit)
+                                   gint match_date_hardlimit,
+                                   GNCImportMatchIndex *match_index)
 {
     GList * list_element;
-    Query *query = qof_query_create_for(GNC_ID_SPLIT);
+    Query *query;
+    Account *importaccount;
+    time64 download_time;
     g_assert (trans_info);
 
+    importaccount =
+        xaccSplitGetAccount (gnc_import_TransInfo_get_fsplit (trans_info));
+    download_time = xaccTransGetDate (gnc_import_TransInfo_get_trans (trans_info));
+
+    /* With an index, the splits of the originating account in the date
+       window are a range of its date-sorted candidates. */
+    if (match_index && importaccount)
+    {
+        time64 start = download_time - match_date_hardlimit * 86400;
+        time64 end = download_time + match_date_hardlimit * 86400;
+        MatchAccount *match_account =
+            match_index_get_account (match_index, importaccount, start, end);
+        GArray *candidates = match_account->candidates;
+        guint i;
+
+        for (i = match_index_lower_bound (candidates, start);
+             i < candidates->len; i++)
+        {
+            MatchCandidate *candidate = &g_array_index (candidates,
+                                                        MatchCandidate, i);
+            if (candidate->date > end)
+                break;
+            if (match_candidate_live (match_account, importaccount, candidate))
+                split_find_match (trans_info, candidate->split,
+                                  process_threshold, fuzzy_amount_difference);
+        }
+        return;
+    }
+
     /* Get list of splits of the originating account. */
+    query = qof_query_create_for(GNC_ID_SPLIT);
     {
         /* We used to traverse *all* splits of the account by using
            xaccAccountGetSplitList, which is a bad idea because 90% of these
@@ -821,10 +1144,6 @@ void gnc_import_find_split_matches(GNCImportTransInfo *trans_info,
            rather use a query according to the date region, which is
            implemented here.
         */
-        Account *importaccount =
-            xaccSplitGetAccount (gnc_import_TransInfo_get_fsplit (trans_info));
-        time64 download_time = xaccTransGetDate (gnc_import_TransInfo_get_trans (trans_info));
-
         qof_query_set_book (query, gnc_get_current_book());
         xaccQueryAddSingleAccountMatch (query, importaccount,
                                         QOF_QUERY_AND);
@@ -833,18 +1152,6 @@ void gnc_import_find_split_matches(GNCImportTransInfo *trans_info,
                                  TRUE, download_time + match_date_hardlimit * 86400,
                                  QOF_QUERY_AND);
         list_element = qof_query_run (query);
-        /* Sigh. Doesn't help too much. We still create and run one query
-           for each imported transaction. Maybe it would improve
-           performance further if there is one single (master-)query at
-           the beginning, matching the full date range and all accounts in
-           question. However, this doesn't quite work because this function
-           here is called from each gnc_gen_trans_list_add_trans(), which
-           is called one at a time. Therefore the whole importer would
-           have to change its behaviour: Accept the imported txns via
-           gnc_gen_trans_list_add_trans(), and only when
-           gnc_gen_trans_list_run() is called, then calculate all the
-           different match candidates. That's too much work for now.
-        */
     }
 
     /* Traverse that list, calling split_find_match on each one. Note
@@ -1193,7 +1500,8 @@ static gint compare_probability (gconstpointer a,
  */
 void
 gnc_import_TransInfo_init_matches (GNCImportTransInfo *trans_info,
-                                   GNCImportSettings *settings)
+                                   GNCImportSettings *settings,
+                                   GNCImportMatchIndex *match_index)
 {
     GNCImportMatchInfo * best_match = NULL;
     g_assert (trans_info);
@@ -1203,7 +1511,8 @@ gnc_import_TransInfo_init_matches (GNCImportTransInfo *trans_info,
     gnc_import_find_split_matches(trans_info,
                                   gnc_import_Settings_get_display_threshold (settings),
                                   gnc_import_Settings_get_fuzzy_amount (settings),
-                                  gnc_import_Settings_get_match_date_hardlimit (settings));
+                                  gnc_import_Settings_get_match_date_hardlimit (settings),
+                                  match_index);
 
     if (trans_info->match_list != NULL)
     {
@@ -33,6 +33,7 @@
 
 typedef struct _transactioninfo GNCImportTransInfo;
 typedef struct _selected_match_info GNCImportSelectedMatchInfo;
+typedef struct _match_index GNCImportMatchIndex;
 typedef struct _matchinfo
 {
     Transaction * trans;
@@ -89,11 +90,16 @@ gboolean gnc_import_exists_online_id (Transaction *trans);
  * values like 14 (days) might be appropriate, whereas for use cases
  * with paper checks (e.g. OFX, QIF), values like 42 (days) seem more
  * appropriate.
+ *
+ * @param match_index The import session's candidate index, which
+ * finds the splits in the date window without running a query. May
+ * be NULL, in which case the current book is queried.
  */
 void gnc_import_find_split_matches(GNCImportTransInfo *trans_info,
                                    gint process_threshold,
                                    double fuzzy_amount_difference,
-                                   gint match_date_hardlimit);
+                                   gint match_date_hardlimit,
+                                   GNCImportMatchIndex *match_index);
 
 /** Iterates through all splits of the originating account of
  * trans_info. Sorts the resulting list and sets the selected_match
@@ -103,10 +109,27 @@ void gnc_import_find_split_matches(GNCImportTransInfo *trans_info,
  * found, sorted, and selected.
  *
  * @param settings The structure that holds all the user preferences.
+ *
+ * @param match_index The import session's candidate index, or NULL.
  */
 void
 gnc_import_TransInfo_init_matches (GNCImportTransInfo *trans_info,
-                                   GNCImportSettings *settings);
+                                   GNCImportSettings *settings,
+                                   GNCImportMatchIndex *match_index);
+
+/** Create an index of the splits that imported transactions may
+ * duplicate, for use by the matching functions above during one
+ * import session.  Each account's splits are loaded by a query for the
+ * dates a transaction is matched against, widened as later ones need,
+ * and kept sorted by date posted, so that every match is a binary
+ * search for the start of its date window.  The index follows splits
+ * being added to, removed from and changed in the accounts it holds,
+ * and checks each split is still there before using it.
+ */
+GNCImportMatchIndex *gnc_import_MatchIndex_new (void);
+
+/** Free an index made by gnc_import_MatchIndex_new(). */
+void gnc_import_MatchIndex_delete (GNCImportMatchIndex *match_index);
 
 /** This function is intended to be called when the importer dialog is
  * finished. It should be called once for each imported transaction
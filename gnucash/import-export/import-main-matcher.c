@@ -65,6 +65,7 @@ struct _main_matcher_info
     GNCTransactionProcessedCB transaction_processed_cb;
     gpointer user_data;
     GNCImportPendingMatches *pending_matches;
+    GNCImportMatchIndex *match_index;
 };
 
 enum downloaded_cols
@@ -139,6 +140,7 @@ void gnc_gen_trans_list_delete (GNCImportMainMatcher *info)
     }
     else
         gnc_import_Settings_delete (info->user_settings);
+    gnc_import_MatchIndex_delete (info->match_index);
     g_free (info);
 }
 
@@ -529,6 +531,7 @@ GNCImportMainMatcher *gnc_gen_trans_list_new (GtkWidget *parent,
 
     info = g_new0 (GNCImportMainMatcher, 1);
     info->pending_matches = gnc_import_PendingMatches_new();
+    info->match_index = gnc_import_MatchIndex_new();
 
     /* Initialize user Settings. */
     info->user_settings = gnc_import_Settings_new ();
@@ -598,6 +601,7 @@ GNCImportMainMatcher * gnc_gen_trans_assist_new (GtkWidget *parent,
 
     info = g_new0 (GNCImportMainMatcher, 1);
     info->pending_matches = gnc_import_PendingMatches_new();
+    info->match_index = gnc_import_MatchIndex_new();
 
     /* Initialize user Settings. */
     info->user_settings = gnc_import_Settings_new ();
@@ -933,7 +937,8 @@ void gnc_gen_trans_list_add_trans_with_ref_id(GNCImportMainMatcher *gui, Transac
         gnc_import_TransInfo_set_ref_id(transaction_info, ref_id);
 
         gnc_import_TransInfo_init_matches(transaction_info,
-                                          gui->user_settings);
+                                          gui->user_settings,
+                                          gui->match_index);
 
         selected_match =
             gnc_import_TransInfo_get_selected_match(transaction_info);
@@ -0,0 +1,229 @@
+extern "C" {
+#include <config.h>
+#include <unittest-support.h>
+
+#include <glib.h>
+#include <gtk/gtk.h> /* for references in import-backend.h */
+#include "import-backend.h"
+#include "Account.h"
+#include "Split.h"
+#include "cashobjects.h"
+#include "gnc-commodity.h"
+#include "gnc-session.h"
+#include "test-engine-stuff.h"
+}
+
+#include <vector>
+
+static const gchar *suitename = "/import-export/import-backend";
+
+#define DAY (24 * 60 * 60)
+#define START_TIME ((time64)1262347200) /* 2010-01-01 12:00 UTC */
+#define MATCH_DATE_HARDLIMIT 42
+/* Low enough that every split in the date window is listed. */
+#define DISPLAY_EVERYTHING (-1000)
+
+typedef struct
+{
+    QofBook *book;
+    Account *account;
+    gnc_commodity *currency;
+} Fixture;
+
+static Transaction *
+add_transaction (Fixture *fixture, time64 date, gint64 amount, gboolean commit)
+{
+    Transaction *trans = xaccMallocTransaction (fixture->book);
+    Split *split = xaccMallocSplit (fixture->book);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, fixture->currency);
+    xaccTransSetDatePostedSecs (trans, date);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, fixture->account);
+    xaccSplitSetAmount (split, gnc_numeric_create (amount, 100));
+    xaccSplitSetValue (split, gnc_numeric_create (amount, 100));
+    if (commit)
+        xaccTransCommitEdit (trans);
+    return trans;
+}
+
+static void
+setup (Fixture *fixture, gconstpointer pData)
+{
+    fixture->book = qof_session_get_book (gnc_get_current_session ());
+    fixture->currency = gnc_commodity_new (fixture->book, "US Dollar",
+                                           "CURRENCY", "USD", NULL, 100);
+    fixture->account = xaccMallocAccount (fixture->book);
+    xaccAccountBeginEdit (fixture->account);
+    xaccAccountSetCommodity (fixture->account, fixture->currency);
+    xaccAccountCommitEdit (fixture->account);
+}
+
+static void
+teardown (Fixture *fixture, gconstpointer pData)
+{
+    gnc_clear_current_session ();
+    test_clear_error_list ();
+}
+
+/* The number of matches that find_split_matches adds to info. */
+static guint
+find_matches (GNCImportTransInfo *info, GNCImportMatchIndex *match_index)
+{
+    guint before = g_list_length (gnc_import_TransInfo_get_match_list (info));
+
+    gnc_import_find_split_matches (info, DISPLAY_EVERYTHING, 0.0,
+                                   MATCH_DATE_HARDLIMIT, match_index);
+    return g_list_length (gnc_import_TransInfo_get_match_list (info)) - before;
+}
+
+/* Find matches for imports on each of the first days, with and
+ * without the index, and check that both find the whole window. */
+static void
+test_index_finds_date_window (Fixture *fixture, gconstpointer pData)
+{
+    const int days = 200;
+    GNCImportMatchIndex *match_index = gnc_import_MatchIndex_new ();
+
+    for (int i = 0; i < days; i++)
+        add_transaction (fixture, START_TIME + i * DAY, 1000 + i, TRUE);
+
+    for (int i = 0; i < days; i += 7)
+    {
+        Transaction *imported = add_transaction (fixture, START_TIME + i * DAY,
+                                                 1000 + i, FALSE);
+        GNCImportTransInfo *info = gnc_import_TransInfo_new (imported, NULL);
+        guint expected = MIN (i + MATCH_DATE_HARDLIMIT, days - 1) -
+            MAX (i - MATCH_DATE_HARDLIMIT, 0) + 1;
+
+        g_assert_cmpuint (find_matches (info, NULL), ==, expected);
+        g_assert_cmpuint (find_matches (info, match_index), ==, expected);
+        gnc_import_TransInfo_delete (info);
+    }
+
+    gnc_import_MatchIndex_delete (match_index);
+}
+
+/* Splits added, moved in time or removed after the account was indexed
+ * are found, or not, accordingly. */
+static void
+test_index_follows_edits (Fixture *fixture, gconstpointer pData)
+{
+    GNCImportMatchIndex *match_index = gnc_import_MatchIndex_new ();
+    Transaction *far, *near, *imported;
+    GNCImportTransInfo *info;
+
+    near = add_transaction (fixture, START_TIME, 100, TRUE);
+    far = add_transaction (fixture, START_TIME + 365 * DAY, 100, TRUE);
+    imported = add_transaction (fixture, START_TIME, 100, FALSE);
+    info = gnc_import_TransInfo_new (imported, NULL);
+
+    g_assert_cmpuint (find_matches (info, match_index), ==, 1);
+
+    add_transaction (fixture, START_TIME + DAY, 100, TRUE);
+    xaccTransBeginEdit (far);
+    xaccTransSetDatePostedSecs (far, START_TIME - DAY);
+    xaccTransCommitEdit (far);
+    xaccTransBeginEdit (near);
+    xaccTransDestroy (near);
+    xaccTransCommitEdit (near);
+
+    g_assert_cmpuint (find_matches (info, match_index), ==, 2);
+    g_assert_cmpuint (find_matches (info, NULL), ==, 2);
+
+    gnc_import_TransInfo_delete (info);
+    gnc_import_MatchIndex_delete (match_index);
+}
+
+/* Splits that go while events are suspended are noticed when used. */
+static void
+test_index_suspended_events (Fixture *fixture, gconstpointer pData)
+{
+    GNCImportMatchIndex *match_index = gnc_import_MatchIndex_new ();
+    Transaction *gone, *imported;
+    GNCImportTransInfo *info;
+
+    gone = add_transaction (fixture, START_TIME, 100, TRUE);
+    add_transaction (fixture, START_TIME + DAY, 100, TRUE);
+    imported = add_transaction (fixture, START_TIME, 100, FALSE);
+    info = gnc_import_TransInfo_new (imported, NULL);
+
+    g_assert_cmpuint (find_matches (info, match_index), ==, 2);
+
+    qof_event_suspend ();
+    xaccTransBeginEdit (gone);
+    xaccTransDestroy (gone);
+    xaccTransCommitEdit (gone);
+    qof_event_resume ();
+
+    g_assert_cmpuint (find_matches (info, match_index), ==, 1);
+    g_assert_cmpuint (find_matches (info, NULL), ==, 1);
+
+    gnc_import_TransInfo_delete (info);
+    gnc_import_MatchIndex_delete (match_index);
+}
+
+/* A statement of a few thousand lines matched against an account with
+ * years of history. */
+static void
+test_match_performance (Fixture *fixture, gconstpointer pData)
+{
+    const int history = 20000, statement = 2000;
+    std::vector<GNCImportTransInfo*> infos;
+    GNCImportMatchIndex *match_index;
+    gdouble query_time, index_time;
+
+    for (int i = 0; i < history; i++)
+        add_transaction (fixture, START_TIME + (i / 4) * DAY,
+                         1000 + i % 97, TRUE);
+    for (int i = 0; i < statement; i++)
+    {
+        time64 date = START_TIME + ((history - statement + i) / 4) * DAY;
+        Transaction *imported = add_transaction (fixture, date,
+                                                 1000 + i % 97, FALSE);
+        infos.push_back (gnc_import_TransInfo_new (imported, NULL));
+    }
+
+    g_test_timer_start ();
+    for (auto info : infos)
+        gnc_import_find_split_matches (info, 3, 0.0, MATCH_DATE_HARDLIMIT, NULL);
+    query_time = g_test_timer_elapsed ();
+
+    g_test_timer_start ();
+    match_index = gnc_import_MatchIndex_new ();
+    for (auto info : infos)
+        gnc_import_find_split_matches (info, 3, 0.0, MATCH_DATE_HARDLIMIT,
+                                       match_index);
+    index_time = g_test_timer_elapsed ();
+    gnc_import_MatchIndex_delete (match_index);
+
+    g_test_message ("Matching %d imports against %d splits: "
+                    "%.3f s with a query each, %.3f s with the index",
+                    statement, history, query_time, index_time);
+    for (auto info : infos)
+        gnc_import_TransInfo_delete (info);
+}
+
+int
+main (int argc, char *argv[])
+{
+    int result;
+    qof_init();
+    cashobjects_register();
+    g_test_init (&argc, &argv, NULL);
+
+    GNC_TEST_ADD (suitename, "index finds date window", Fixture, NULL, setup,
+                  test_index_finds_date_window, teardown);
+    GNC_TEST_ADD (suitename, "index follows edits", Fixture, NULL, setup,
+                  test_index_follows_edits, teardown);
+    GNC_TEST_ADD (suitename, "index survives suspended events", Fixture, NULL,
+                  setup, test_index_suspended_events, teardown);
+    if (g_test_perf ())
+        GNC_TEST_ADD (suitename, "match performance", Fixture, NULL, setup,
+                      test_match_performance, teardown);
+    result = g_test_run();
+
+    qof_close();
+    return result;
+}
@@ -830,6 +830,36 @@
             domestic (timespecCanonicalDayTime date))))
       #f))
 
+;; The same as gnc:exchange-by-pricedb-nearest for a list of (foreign
+;; date) lists, but converting all of them in one pass over the
+;; pricedb. Returns a list of <gnc-monetary> in the same order.
+(define (gnc:exchange-list-by-pricedb-nearest foreign-date-list domestic)
+  (let* ((direct (map (lambda (foreign-date)
+                        (or (gnc:exchange-by-euro (car foreign-date) domestic
+                                                  (cadr foreign-date))
+                            (gnc:exchange-if-same (car foreign-date) domestic)))
+                      foreign-date-list))
+         (amounts (gnc-pricedb-convert-balances-nearest-price
+                   (gnc-pricedb-get-db (gnc-get-current-book))
+                   (filter-map
+                    (lambda (foreign-date direct-result)
+                      (and (not direct-result)
+                           (let ((foreign (car foreign-date)))
+                             (list (gnc:gnc-monetary-commodity foreign)
+                                   (gnc:gnc-monetary-amount foreign)
+                                   (timespecCanonicalDayTime
+                                    (cadr foreign-date))))))
+                    foreign-date-list direct)
+                   domestic)))
+    (reverse
+     (fold (lambda (direct-result results)
+             (cons (or direct-result
+                       (let ((amount (car amounts)))
+                         (set! amounts (cdr amounts))
+                         (gnc:make-gnc-monetary domestic amount)))
+                   results))
+           '() direct))))
+
 ;; Exchange by the nearest price from pricelist. This function takes
 ;; the <gnc-monetary> 'foreign' amount, the <gnc:commodity*>
 ;; 'domestic' commodity, a <gnc:time-pair> 'date' and the
@@ -982,6 +1012,34 @@
         )
   )
 
+;; Like gnc:sum-collector-commodity with gnc:exchange-by-pricedb-nearest,
+;; for a list of commodity-collectors each exchanged at the matching
+;; <gnc:time-pair> in 'dates'. All the exchanges are done with one
+;; gnc:exchange-list-by-pricedb-nearest. Returns a list of <gnc-monetary>.
+(define (gnc:sum-collectors-commodity-by-pricedb-nearest collectors dates domestic)
+  (let* ((foreign-list '())
+         (balances (map (lambda (foreign date)
+                          (let ((balance (gnc:make-commodity-collector)))
+                            (foreign
+                             'format
+                             (lambda (curr val)
+                               (if (gnc-commodity-equiv domestic curr)
+                                   (balance 'add domestic val)
+                                   (set! foreign-list
+                                         (cons (list balance
+                                                     (gnc:make-gnc-monetary curr val)
+                                                     date)
+                                               foreign-list))))
+                             #f)
+                            balance))
+                        collectors dates)))
+    (for-each (lambda (item exchanged)
+                ((car item) 'add domestic (gnc:gnc-monetary-amount exchanged)))
+              foreign-list
+              (gnc:exchange-list-by-pricedb-nearest (map cdr foreign-list)
+                                                    domestic))
+    (map (lambda (balance) (balance 'getmonetary domestic #f)) balances)))
+
 ;; As above, but adds only the commodities of other stocks and
 ;; mutual-funds. Returns a commodity-collector, (not a <gnc:monetary>)
 ;; which (still) may have several different commodities in it -- if
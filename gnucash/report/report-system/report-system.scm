@@ -61,10 +61,12 @@
 (export gnc:exchange-by-pricedb-helper)
 (export gnc:exchange-by-pricedb-latest )
 (export gnc:exchange-by-pricedb-nearest)
+(export gnc:exchange-list-by-pricedb-nearest)
 (export gnc:exchange-by-pricealist-nearest)
 (export gnc:case-exchange-fn)
 (export gnc:case-exchange-time-fn)
 (export gnc:sum-collector-commodity)
+(export gnc:sum-collectors-commodity-by-pricedb-nearest)
 (export gnc:sum-collector-stocks)
 (export gnc-commodity-collector-contains-commodity?)
 
@@ -250,6 +250,14 @@
        c report-currency
        (lambda (a b) (exchange-fn a b date))))
 
+    ;; The same for a list of commodity-collectors, each at the matching
+    ;; date. The pricedb's nearest prices are looked up all at once.
+    (define (collectors->monetaries cs dates)
+      (if (eq? price-source 'pricedb-nearest)
+          (gnc:sum-collectors-commodity-by-pricedb-nearest
+           cs dates report-currency)
+          (map collector->monetary cs dates)))
+
     ;; Add two gnc-monetary objects in the same currency.
     (define (monetary+ a b)
       (if (and (gnc:gnc-monetary? a) (gnc:gnc-monetary? b))
@@ -334,19 +342,21 @@
 				 (assoc-ref classified-accounts ACCT-TYPE-LIABILITY)))))
 	      (account-reformat (if inc-exp?
 				    (lambda (account result)
-				      (map (lambda (collector date-interval)
-					     (gnc:monetary-neg (collector->monetary collector (second date-interval))))
-					   result dates-list))
+				      (map gnc:monetary-neg
+					   (collectors->monetaries
+					    result (map second dates-list))))
 				    (lambda (account result)
 				      (let ((commodity-collector (gnc:make-commodity-collector)))
-					(collector-end (fold (lambda (next date list-collector)
-							       (commodity-collector 'merge next #f)
-							       (collector-add list-collector
-									      (collector->monetary
-									       commodity-collector date)))
-							     (collector-into-list)
-							     result
-							     dates-list))))))
+					(collectors->monetaries
+					 (reverse
+					  (fold (lambda (next running-list)
+						  (let ((running (gnc:make-commodity-collector)))
+						    (commodity-collector 'merge next #f)
+						    (running 'merge commodity-collector #f)
+						    (cons running running-list)))
+						'()
+						result))
+					 dates-list)))))
 	      (work (category-by-account-report-work inc-exp?
 					  dates-list
 					  the-acount-destination-alist
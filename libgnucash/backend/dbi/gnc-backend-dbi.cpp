@@ -788,6 +788,13 @@ GncDbiBackend<Type>::session_end ()
 {
     ENTER (" ");
 
+    /* This is the last chance to write anything commit() is holding,
+     * including what earlier flushes couldn't. */
+    if (m_conn != nullptr && (!flush_pending () || has_pending ()))
+    {
+        PERR ("Changes held for writing couldn't be saved.");
+        set_error (ERR_BACKEND_SERVER_ERR);
+    }
     finalize_version_info ();
     connect(nullptr);
 
@@ -888,6 +895,11 @@ GncDbiBackend<Type>::safe_sync (QofBook* book)
     g_return_if_fail (book != nullptr);
 
     ENTER ("book=%p, primary=%p", book, m_book);
+    /* Whatever commit() is holding is saved if the rewrite fails. */
+    flush_pending ();
+    /* sync() rewrites the tables from what is in memory. */
+    if (transactions_deferred())
+        GncSqlBackend::load (m_book, LOAD_TYPE_LOAD_ALL);
     if (!conn->begin_transaction())
     {
         LEAVE("Failed to obtain a transaction.");
@@ -931,6 +943,9 @@ GncDbiBackend<DbType::DBI_MYSQL>::safe_sync (QofBook* book)
     g_return_if_fail (book != nullptr);
 
     ENTER ("book=%p, primary=%p", book, m_book);
+    flush_pending ();
+    if (transactions_deferred())
+        GncSqlBackend::load (m_book, LOAD_TYPE_LOAD_ALL);
     if (!conn->table_operation (TableOpType::backup))
     {
         set_error(ERR_BACKEND_SERVER_ERR);
@@ -29,6 +29,8 @@ extern "C"
 #include <gnc-locale-utils.h>
 }
 
+#include <clocale>
+#include <cstring>
 #include <string>
 #include <regex>
 #include <sstream>
@@ -80,16 +82,35 @@ GncDbiSqlStatement::add_where_cond(QofIdTypeConst type_name,
     }
 }
 
+GncDbiCNumericLocale::GncDbiCNumericLocale() noexcept
+{
+    auto locale = setlocale (LC_NUMERIC, nullptr);
+    m_pushed = locale == nullptr || strcmp (locale, "C") != 0;
+    if (m_pushed)
+        gnc_push_locale (LC_NUMERIC, "C");
+}
+
+GncDbiCNumericLocale::~GncDbiCNumericLocale() noexcept
+{
+    if (m_pushed)
+        gnc_pop_locale (LC_NUMERIC);
+}
+
+static GncDbiProviderPtr
+make_provider (DbType type)
+{
+    return type == DbType::DBI_SQLITE ?
+        make_dbi_provider<DbType::DBI_SQLITE>() :
+        type == DbType::DBI_MYSQL ?
+        make_dbi_provider<DbType::DBI_MYSQL>() :
+        make_dbi_provider<DbType::DBI_PGSQL>();
+}
+
 GncDbiSqlConnection::GncDbiSqlConnection (DbType type, QofBackend* qbe,
                                           dbi_conn conn, bool ignore_lock) :
-    m_qbe{qbe}, m_conn{conn},
-    m_provider{type == DbType::DBI_SQLITE ?
-            make_dbi_provider<DbType::DBI_SQLITE>() :
-            type == DbType::DBI_MYSQL ?
-            make_dbi_provider<DbType::DBI_MYSQL>() :
-            make_dbi_provider<DbType::DBI_PGSQL>()},
-    m_conn_ok{true}, m_last_error{ERR_BACKEND_NO_ERR}, m_error_repeat{0},
-    m_retry{false}, m_sql_savepoint{0}
+    m_qbe{qbe}, m_conn{conn}, m_type{type}, m_provider{make_provider(type)},
+    m_reader{false}, m_conn_ok{true}, m_last_error{ERR_BACKEND_NO_ERR},
+    m_error_repeat{0}, m_retry{false}, m_sql_savepoint{0}
 {
     if (!lock_database(ignore_lock))
         throw std::runtime_error("Failed to lock database!");
@@ -100,6 +121,14 @@ GncDbiSqlConnection::GncDbiSqlConnection (DbType type, QofBackend* qbe,
     }
 }
 
+GncDbiSqlConnection::GncDbiSqlConnection (DbType type, QofBackend* qbe,
+                                          dbi_conn conn) :
+    m_qbe{qbe}, m_conn{conn}, m_type{type}, m_provider{make_provider(type)},
+    m_reader{true}, m_conn_ok{true}, m_last_error{ERR_BACKEND_NO_ERR},
+    m_error_repeat{0}, m_retry{false}, m_sql_savepoint{0}
+{
+}
+
 bool
 GncDbiSqlConnection::lock_database (bool ignore_lock)
 {
@@ -239,12 +268,39 @@ GncDbiSqlConnection::~GncDbiSqlConnection()
 {
     if (m_conn)
     {
-        unlock_database();
+        if (!m_reader)
+            unlock_database();
         dbi_conn_close(m_conn);
         m_conn = nullptr;
     }
 }
 
+GncSqlConnection*
+GncDbiSqlConnection::open_reader () const noexcept
+{
+    auto conn = dbi_conn_open (dbi_conn_get_driver (m_conn));
+    if (conn == nullptr)
+        return nullptr;
+    for (auto option = dbi_conn_get_option_list (m_conn, nullptr);
+         option != nullptr; option = dbi_conn_get_option_list (m_conn, option))
+    {
+        auto value = dbi_conn_get_option (m_conn, option);
+        if (value != nullptr)
+            dbi_conn_set_option (conn, option, value);
+        else
+            dbi_conn_set_option_numeric (conn, option,
+                                         dbi_conn_get_option_numeric (m_conn,
+                                                                      option));
+    }
+    if (dbi_conn_connect (conn) < 0)
+    {
+        PWARN ("Unable to open another connection to the database");
+        dbi_conn_close (conn);
+        return nullptr;
+    }
+    return new GncDbiSqlConnection (m_type, m_qbe, conn);
+}
+
 GncSqlResultPtr
 GncDbiSqlConnection::execute_select_statement (const GncSqlStatementPtr& stmt)
     noexcept
@@ -252,16 +308,30 @@ GncDbiSqlConnection::execute_select_statement (const GncSqlStatementPtr& stmt)
     dbi_result result;
 
     DEBUG ("SQL: %s\n", stmt->to_sql());
-    gnc_push_locale (LC_NUMERIC, "C");
-    do
+    /* Readers run on other threads, where switching the process' locale
+     * would upset this one. The SQL backend holds the "C" locale for as
+     * long as they run. */
+    if (m_reader)
     {
-        init_error ();
         result = dbi_conn_query (m_conn, stmt->to_sql());
+        if (result == nullptr)
+        {
+            PERR ("Error executing SQL %s\n", stmt->to_sql());
+            return nullptr;
+        }
+        return GncSqlResultPtr(new GncDbiSqlResult (this, result));
+    }
+    {
+        GncDbiCNumericLocale c_locale;
+        do
+        {
+            init_error ();
+            result = dbi_conn_query (m_conn, stmt->to_sql());
+        }
+        while (m_retry);
     }
-    while (m_retry);
     if (result == nullptr)
         PERR ("Error executing SQL %s\n", stmt->to_sql());
-    gnc_pop_locale (LC_NUMERIC);
     return GncSqlResultPtr(new GncDbiSqlResult (this, result));
 }
 
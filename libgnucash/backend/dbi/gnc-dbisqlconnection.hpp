@@ -35,6 +35,21 @@
 using StrVec = std::vector<std::string>;
 class GncDbiProvider;
 
+/**
+ * Switches LC_NUMERIC to "C", which libdbi needs to convert numbers, for as
+ * long as it lives. The locale is left alone if it is "C" already, as it is
+ * while the SQL backend reads ahead on other threads and setlocale mustn't
+ * be called.
+ */
+class GncDbiCNumericLocale
+{
+public:
+    GncDbiCNumericLocale() noexcept;
+    ~GncDbiCNumericLocale() noexcept;
+private:
+    bool m_pushed;
+};
+
 /**
  * Encapsulate a libdbi dbi_conn connection.
  */
@@ -80,15 +95,22 @@ public:
      */
     bool verify() noexcept override;
     bool retry_connection(const char* msg) noexcept override;
+    GncSqlConnection* open_reader () const noexcept override;
     dbi_result table_manage_backup(const std::string& table_name, TableOpType op);
     bool table_operation (TableOpType op) noexcept;
     std::string add_columns_ddl(const std::string& table_name,
                                 const ColVec& info_vec) const noexcept;
     bool drop_indexes() noexcept;
 private:
+    /** A reader, from open_reader(). */
+    GncDbiSqlConnection (DbType type, QofBackend* qbe, dbi_conn conn);
     QofBackend* m_qbe;
     dbi_conn m_conn;
+    DbType m_type;
     std::unique_ptr<GncDbiProvider> m_provider;
+    /** Opened by open_reader(), so it doesn't hold the lock and reports
+     * errors only by returning nullptr. */
+    bool m_reader;
     /** Used by the error handler routines to flag if the connection is ok to
      * use
      */
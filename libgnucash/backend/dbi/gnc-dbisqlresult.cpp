@@ -31,6 +31,7 @@ extern "C"
 #include <dbi/dbi-dev.h>
 }
 #include <gnc-datetime.hpp>
+#include <cstring>
 #include "gnc-dbisqlresult.hpp"
 #include "gnc-dbisqlconnection.hpp"
 
@@ -84,6 +85,34 @@ GncDbiSqlResult::size() const noexcept
 {
     return dbi_result_get_numrows(m_dbi_result);
 }
+
+const GncDbiSqlResult::Column*
+GncDbiSqlResult::column (const char* name) noexcept
+{
+    if (m_columns.empty() && m_dbi_result != nullptr)
+    {
+        auto count = dbi_result_get_numfields (m_dbi_result);
+        if (count == DBI_FIELD_ERROR)
+            return nullptr;
+        m_columns.reserve (count);
+        for (unsigned int idx = 1; idx <= count; ++idx)
+            m_columns.push_back ({dbi_result_get_field_name (m_dbi_result, idx),
+                        idx,
+                        dbi_result_get_field_type_idx (m_dbi_result, idx),
+                        dbi_result_get_field_attribs_idx (m_dbi_result, idx)});
+    }
+    auto size = m_columns.size();
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        auto& col = m_columns[(m_next_column + i) % size];
+        if (col.name != nullptr && strcmp (col.name, name) == 0)
+        {
+            m_next_column = col.idx % size;
+            return &col;
+        }
+    }
+    return nullptr;
+}
 /* --------------------------------------------------------- */
 
 GncSqlRow&
@@ -103,72 +132,61 @@ GncDbiSqlResult::IteratorImpl::operator++()
 int64_t
 GncDbiSqlResult::IteratorImpl::get_int_at_col(const char* col) const
 {
-    auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    if(type != DBI_TYPE_INTEGER)
+    auto column = m_inst->column (col);
+    if(column == nullptr || column->type != DBI_TYPE_INTEGER)
         throw (std::invalid_argument{"Requested integer from non-integer column."});
-    return dbi_result_get_longlong (m_inst->m_dbi_result, col);
+    return dbi_result_get_longlong_idx (m_inst->m_dbi_result, column->idx);
 }
 
 float
 GncDbiSqlResult::IteratorImpl::get_float_at_col(const char* col) const
 {
-    auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    auto attrs = dbi_result_get_field_attribs (m_inst->m_dbi_result, col);
-    if(type != DBI_TYPE_DECIMAL ||
-       (attrs & DBI_DECIMAL_SIZEMASK) != DBI_DECIMAL_SIZE4)
+    auto column = m_inst->column (col);
+    if(column == nullptr || column->type != DBI_TYPE_DECIMAL ||
+       (column->attribs & DBI_DECIMAL_SIZEMASK) != DBI_DECIMAL_SIZE4)
         throw (std::invalid_argument{"Requested float from non-float column."});
-    gnc_push_locale (LC_NUMERIC, "C");
-    auto retval =  dbi_result_get_float(m_inst->m_dbi_result, col);
-    gnc_pop_locale (LC_NUMERIC);
-    return retval;
+    GncDbiCNumericLocale c_locale;
+    return dbi_result_get_float_idx(m_inst->m_dbi_result, column->idx);
 }
 
 double
 GncDbiSqlResult::IteratorImpl::get_double_at_col(const char* col) const
 {
-    auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    auto attrs = dbi_result_get_field_attribs (m_inst->m_dbi_result, col);
-    if(type != DBI_TYPE_DECIMAL ||
-       (attrs & DBI_DECIMAL_SIZEMASK) != DBI_DECIMAL_SIZE8)
+    auto column = m_inst->column (col);
+    if(column == nullptr || column->type != DBI_TYPE_DECIMAL ||
+       (column->attribs & DBI_DECIMAL_SIZEMASK) != DBI_DECIMAL_SIZE8)
         throw (std::invalid_argument{"Requested double from non-double column."});
-    gnc_push_locale (LC_NUMERIC, "C");
-    auto retval =  dbi_result_get_double(m_inst->m_dbi_result, col);
-    gnc_pop_locale (LC_NUMERIC);
-    return retval;
+    GncDbiCNumericLocale c_locale;
+    return dbi_result_get_double_idx(m_inst->m_dbi_result, column->idx);
 }
 
 std::string
 GncDbiSqlResult::IteratorImpl::get_string_at_col(const char* col) const
 {
-    auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    auto attrs = dbi_result_get_field_attribs (m_inst->m_dbi_result, col);
-    if(type != DBI_TYPE_STRING)
+    auto column = m_inst->column (col);
+    if(column == nullptr || column->type != DBI_TYPE_STRING)
         throw (std::invalid_argument{"Requested string from non-string column."});
-    gnc_push_locale (LC_NUMERIC, "C");
-    auto strval = dbi_result_get_string(m_inst->m_dbi_result, col);
+    /* Strings are copied as they are, so unlike the numbers they don't
+     * need the C locale. */
+    auto strval = dbi_result_get_string_idx(m_inst->m_dbi_result, column->idx);
     if (strval == nullptr)
-    {
-        gnc_pop_locale (LC_NUMERIC);
         throw (std::invalid_argument{"Column empty."});
-    }
-    auto retval =  std::string{strval};
-    gnc_pop_locale (LC_NUMERIC);
-    return retval;
+    return std::string{strval};
 }
+
 time64
 GncDbiSqlResult::IteratorImpl::get_time64_at_col (const char* col) const
 {
     auto result = (dbi_result_t*) (m_inst->m_dbi_result);
-    auto type = dbi_result_get_field_type (result, col);
-    auto attrs = dbi_result_get_field_attribs (result, col);
-    if (type != DBI_TYPE_DATETIME)
+    auto column = m_inst->column (col);
+    if (column == nullptr || column->type != DBI_TYPE_DATETIME)
         throw (std::invalid_argument{"Requested time64 from non-time64 column."});
-    gnc_push_locale (LC_NUMERIC, "C");
+    GncDbiCNumericLocale c_locale;
 #if HAVE_LIBDBI_TO_LONGLONG
     /* A less evil hack than the one required by libdbi-0.8, but
      * still necessary to work around the same bug.
      */
-    auto retval = dbi_result_get_as_longlong(result, col);
+    auto retval = dbi_result_get_as_longlong_idx(result, column->idx);
 #else
     /* A seriously evil hack to work around libdbi bug #15
      * https://sourceforge.net/p/libdbi/bugs/15/. When libdbi
@@ -177,15 +195,22 @@ GncDbiSqlResult::IteratorImpl::get_time64_at_col (const char* col) const
      * Note: 0.9 is available in Debian Jessie and Fedora 21.
      */
     auto row = dbi_result_get_currow (result);
-    auto idx = dbi_result_get_field_idx (result, col) - 1;
+    auto idx = column->idx - 1;
     time64 retval = result->rows[row]->field_values[idx].d_datetime;
 #endif //HAVE_LIBDBI_TO_LONGLONG
     if (retval < MINTIME || retval > MAXTIME)
         retval = 0;
-    gnc_pop_locale (LC_NUMERIC);
     return retval;
 }
 
+bool
+GncDbiSqlResult::IteratorImpl::is_col_null(const char* col) const noexcept
+{
+    auto column = m_inst->column (col);
+    if (column == nullptr)
+        return true;
+    return dbi_result_field_is_null_idx(m_inst->m_dbi_result, column->idx);
+}
 
 /* --------------------------------------------------------- */
 
@@ -27,6 +27,7 @@
 
 #include "gnc-backend-dbi.h"
 #include <gnc-sql-result.hpp>
+#include <vector>
 
 class GncDbiSqlConnection;
 
@@ -38,7 +39,7 @@ class GncDbiSqlResult : public GncSqlResult
 public:
     GncDbiSqlResult(const GncDbiSqlConnection* conn, dbi_result result) :
         m_conn{conn}, m_dbi_result{result}, m_iter{this}, m_row{&m_iter},
-        m_sentinel{nullptr} {}
+        m_sentinel{nullptr}, m_next_column{0} {}
     ~GncDbiSqlResult();
     uint64_t size() const noexcept;
     int dberror() const noexcept;
@@ -58,21 +59,33 @@ protected:
         virtual double get_double_at_col (const char* col) const;
         virtual std::string get_string_at_col (const char* col)const;
         virtual time64 get_time64_at_col (const char* col) const;
-        virtual bool is_col_null(const char* col) const noexcept
-        {
-            return dbi_result_field_is_null(m_inst->m_dbi_result, col);
-        }
+        virtual bool is_col_null(const char* col) const noexcept;
     private:
         GncDbiSqlResult* m_inst;
     };
 
 private:
+    /** A field of the result set, looked up once rather than by libdbi
+     * on every get.
+     */
+    struct Column
+    {
+        const char* name;
+        unsigned int idx;     /**< libdbi's field index, starting at 1. */
+        unsigned short type;
+        unsigned int attribs;
+    };
+    const Column* column (const char* name) noexcept;
+
     const GncDbiSqlConnection* m_conn;
     dbi_result m_dbi_result;
     IteratorImpl m_iter;
     GncSqlRow m_row;
     GncSqlRow m_sentinel;
-
+    std::vector<Column> m_columns;
+    /* Rows are nearly always read in column order, so the column after
+     * the last one found is tried first. */
+    std::size_t m_next_column;
 };
 
 #endif //__GNC_DBISQLRESULT_HPP__
@@ -44,6 +44,7 @@ extern "C"
 #include <TransLog.h>
 #include "Transaction.h"
 #include "Split.h"
+#include "Query.h"
 #include "gnc-commodity.h"
 #include "gncAddress.h"
 #include "gncCustomer.h"
@@ -241,6 +242,67 @@ setup_business (Fixture* fixture, gconstpointer pData)
         fixture->filename = NULL;
 }
 
+#define LOAD_PERF_TRANSACTIONS 20000
+
+/* A book with enough transactions for timing a load. */
+static void
+setup_large (Fixture* fixture, gconstpointer pData)
+{
+    QofSession* session = qof_session_new ();
+    gchar* url = (gchar*)pData;
+    QofBook* book = qof_session_get_book (session);
+    Account* root = gnc_book_get_root_account (book);
+    Account* accts[2];
+    gnc_commodity_table* table = gnc_commodity_table_get_table (book);
+    gnc_commodity* currency = gnc_commodity_table_lookup (table,
+                                                          GNC_COMMODITY_NS_CURRENCY,
+                                                          "CAD");
+
+    for (int i = 0; i < 2; ++i)
+    {
+        auto name = g_strdup_printf ("Bank %d", i + 1);
+        accts[i] = xaccMallocAccount (book);
+        xaccAccountBeginEdit (accts[i]);
+        xaccAccountSetType (accts[i], ACCT_TYPE_BANK);
+        xaccAccountSetName (accts[i], name);
+        xaccAccountSetCommodity (accts[i], currency);
+        gnc_account_append_child (root, accts[i]);
+        xaccAccountCommitEdit (accts[i]);
+        g_free (name);
+    }
+
+    for (int i = 0; i < LOAD_PERF_TRANSACTIONS; ++i)
+    {
+        auto desc = g_strdup_printf ("Transaction %d", i);
+        auto num = g_strdup_printf ("%d", i);
+        auto value = gnc_numeric_create (100 + i % 1000, 100);
+        auto tx = xaccMallocTransaction (book);
+        xaccTransBeginEdit (tx);
+        xaccTransSetCurrency (tx, currency);
+        xaccTransSetDescription (tx, desc);
+        xaccTransSetNum (tx, num);
+        xaccTransSetDatePostedSecsNormalized (tx, 1262347200 + i * 3600);
+        for (int j = 0; j < 2; ++j)
+        {
+            auto split = xaccMallocSplit (book);
+            xaccSplitSetParent (split, tx);
+            xaccSplitSetAccount (split, accts[j]);
+            xaccSplitSetMemo (split, desc);
+            xaccSplitSetAmount (split, j ? gnc_numeric_neg (value) : value);
+            xaccSplitSetValue (split, j ? gnc_numeric_neg (value) : value);
+        }
+        xaccTransCommitEdit (tx);
+        g_free (num);
+        g_free (desc);
+    }
+
+    fixture->session = session;
+    if (g_strcmp0 (url, "sqlite3") == 0)
+        fixture->filename = g_strdup_printf ("/tmp/test-sqlite-%d", getpid ());
+    else
+        fixture->filename = NULL;
+}
+
 static void
 destroy_database (gchar* url)
 {
@@ -419,6 +481,300 @@ test_dbi_store_and_reload (Fixture* fixture, gconstpointer pData)
     qof_session_destroy (session_3);
 }
 
+/* The same, with INSERTs of only a few rows each so that batches fill up
+ * and are written in the middle of the save as well as at its end. */
+static void
+test_dbi_store_and_reload_batched (Fixture* fixture, gconstpointer pData)
+{
+    g_setenv ("GNC_SQL_BATCH_SIZE", "3", TRUE);
+    test_dbi_store_and_reload (fixture, pData);
+    g_unsetenv ("GNC_SQL_BATCH_SIZE");
+}
+
+/* The same, reading the transactions a few at a time. */
+static void
+test_dbi_store_and_reload_paged (Fixture* fixture, gconstpointer pData)
+{
+    g_setenv ("GNC_SQL_PAGE_SIZE", "2", TRUE);
+    test_dbi_store_and_reload (fixture, pData);
+    g_unsetenv ("GNC_SQL_PAGE_SIZE");
+}
+
+/* The same, reading the tables ahead of the load on other connections.
+ * That leaves the load unpaged, so the transactions are read ahead too. */
+static void
+test_dbi_store_and_reload_threaded (Fixture* fixture, gconstpointer pData)
+{
+    g_setenv ("GNC_SQL_LOAD_THREADS", "3", TRUE);
+    test_dbi_store_and_reload (fixture, pData);
+    g_unsetenv ("GNC_SQL_LOAD_THREADS");
+}
+
+static void
+redescribe_tx (QofInstance* inst, gpointer data)
+{
+    auto tx = GNC_TRANSACTION (inst);
+    xaccTransBeginEdit (tx);
+    xaccTransSetDescription (tx, "Held");
+    xaccTransCommitEdit (tx);
+    xaccTransBeginEdit (tx);
+    xaccTransSetDescription (tx, static_cast<const char*>(data));
+    xaccTransCommitEdit (tx);
+}
+
+static void
+find_any_tx (QofInstance* inst, gpointer data)
+{
+    auto tx = static_cast<Transaction**>(data);
+    if (*tx == nullptr)
+        *tx = GNC_TRANSACTION (inst);
+}
+
+/* Save the session, then open it again with commit() holding the changes,
+ * edit it and end the session: everything held, including objects edited
+ * twice and a new one, must have been written when it is opened again. A
+ * transaction open for edit during a flush must keep its place, so that
+ * rolling the edit back doesn't leave it in the database. */
+static void
+test_dbi_write_behind (Fixture* fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto loglevel = static_cast<GLogLevelFlags> (G_LOG_LEVEL_WARNING |
+                                                 G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (nullptr, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                                                 (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto session_2 = qof_session_new ();
+    qof_session_begin (session_2, url, FALSE, TRUE, TRUE);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+
+    g_setenv ("GNC_SQL_WRITE_BEHIND", "600000", TRUE);
+    auto session_3 = qof_session_new ();
+    qof_session_begin (session_3, url, FALSE, FALSE, FALSE);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    qof_session_load (session_3, NULL);
+    g_unsetenv ("GNC_SQL_WRITE_BEHIND");
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    auto book_3 = qof_session_get_book (session_3);
+    qof_collection_foreach (qof_book_get_collection (book_3, GNC_ID_TRANS),
+                            redescribe_tx, (gpointer)"Written behind");
+    auto root = gnc_book_get_root_account (book_3);
+    auto acct = xaccMallocAccount (book_3);
+    xaccAccountBeginEdit (acct);
+    xaccAccountSetType (acct, ACCT_TYPE_EXPENSE);
+    xaccAccountSetName (acct, "Written behind");
+    xaccAccountSetCommodity (acct, xaccAccountGetCommodity (gnc_account_nth_child (root, 0)));
+    gnc_account_append_child (root, acct);
+    xaccAccountCommitEdit (acct);
+    auto sql_be = reinterpret_cast<GncSqlBackend*>(qof_session_get_backend (session_3));
+    Transaction* tx = nullptr;
+    qof_collection_foreach (qof_book_get_collection (book_3, GNC_ID_TRANS),
+                            find_any_tx, &tx);
+    g_assert (tx != nullptr);
+    xaccTransBeginEdit (tx);
+    xaccTransSetDescription (tx, "Cancelled");
+    g_assert (sql_be->flush_pending ());
+    g_assert (sql_be->has_pending ());
+    xaccTransRollbackEdit (tx);
+    g_assert_cmpstr (xaccTransGetDescription (tx), == , "Written behind");
+    g_assert (qof_book_session_not_saved (book_3));
+    qof_session_end (session_3);
+    g_assert (!qof_book_session_not_saved (book_3));
+
+    auto session_4 = qof_session_new ();
+    qof_session_begin (session_4, url, TRUE, FALSE, FALSE);
+    g_assert_cmpint (qof_session_get_error (session_4), == , ERR_BACKEND_NO_ERR);
+    qof_session_load (session_4, NULL);
+    g_assert_cmpint (qof_session_get_error (session_4), == , ERR_BACKEND_NO_ERR);
+    compare_books (book_3, qof_session_get_book (session_4));
+
+    qof_session_destroy (session_3);
+    qof_session_end (session_4);
+    qof_session_destroy (session_4);
+}
+
+/* Each account in book_2 has the same balances in book_3. */
+static void
+compare_account_balances (QofBook* book_2, QofBook* book_3)
+{
+    auto accounts = gnc_account_get_descendants (gnc_book_get_root_account (book_2));
+    for (auto node = accounts; node != nullptr; node = node->next)
+    {
+        auto acc_2 = GNC_ACCOUNT (node->data);
+        auto acc_3 = xaccAccountLookup (qof_instance_get_guid (acc_2), book_3);
+        g_assert (acc_3 != nullptr);
+        g_assert (gnc_numeric_equal (xaccAccountGetBalance (acc_2),
+                                     xaccAccountGetBalance (acc_3)));
+        g_assert (gnc_numeric_equal (xaccAccountGetClearedBalance (acc_2),
+                                     xaccAccountGetClearedBalance (acc_3)));
+        g_assert (gnc_numeric_equal (xaccAccountGetReconciledBalance (acc_2),
+                                     xaccAccountGetReconciledBalance (acc_3)));
+    }
+    g_list_free (accounts);
+}
+
+/* Each account in book_3 has the same balance as its twin in book_2 as of,
+ * and the same changes between, the dates of its splits. */
+static void
+compare_period_balances (QofBook* book_2, QofBook* book_3)
+{
+    auto accounts = gnc_account_get_descendants (gnc_book_get_root_account (book_2));
+    for (auto node = accounts; node != nullptr; node = node->next)
+    {
+        auto acc_2 = GNC_ACCOUNT (node->data);
+        auto acc_3 = xaccAccountLookup (qof_instance_get_guid (acc_2), book_3);
+        std::vector<time64> dates {gnc_time (nullptr) + 86400};
+        for (auto split = xaccAccountGetSplitList (acc_2); split != nullptr;
+             split = split->next)
+            dates.push_back (xaccTransGetDate (xaccSplitGetParent (GNC_SPLIT (split->data))) + 1);
+        std::sort (dates.begin(), dates.end());
+
+        for (auto date : dates)
+            g_assert (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (acc_2, date),
+                                         xaccAccountGetBalanceAsOfDate (acc_3, date)));
+        if (dates.size() < 2)
+            continue;
+        std::vector<gnc_numeric> changes_2 (dates.size() - 1);
+        std::vector<gnc_numeric> changes_3 (dates.size() - 1);
+        xaccAccountGetBalanceChangesForPeriods (acc_2, dates.data(), dates.size(),
+                                                changes_2.data());
+        xaccAccountGetBalanceChangesForPeriods (acc_3, dates.data(), dates.size(),
+                                                changes_3.data());
+        for (size_t ind = 0; ind < changes_2.size(); ind++)
+            g_assert (gnc_numeric_equal (changes_2[ind], changes_3[ind]));
+    }
+    g_list_free (accounts);
+}
+
+/* Save the session, then open it again leaving the transactions in the
+ * database. The balances, including those the database sums for past
+ * dates and periods, must be right from the start, a query must bring in
+ * the transactions it needs, and loading the rest must give back the whole
+ * book. */
+static void
+test_dbi_lazy_load (Fixture* fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto loglevel = static_cast<GLogLevelFlags> (G_LOG_LEVEL_WARNING |
+                                                 G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (nullptr, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                                                 (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto session_2 = qof_session_new ();
+    qof_session_begin (session_2, url, FALSE, TRUE, TRUE);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    auto book_2 = qof_session_get_book (session_2);
+
+    g_setenv ("GNC_SQL_LAZY_LOAD", "1", TRUE);
+    auto session_3 = qof_session_new ();
+    qof_session_begin (session_3, url, TRUE, FALSE, FALSE);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    qof_session_load (session_3, NULL);
+    g_unsetenv ("GNC_SQL_LAZY_LOAD");
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    auto book_3 = qof_session_get_book (session_3);
+    g_assert_cmpuint (qof_collection_count (qof_book_get_collection (book_3, GNC_ID_TRANS)),
+                      < , qof_collection_count (qof_book_get_collection (book_2, GNC_ID_TRANS)));
+    compare_account_balances (book_2, book_3);
+    compare_period_balances (book_2, book_3);
+
+    auto accounts = gnc_account_get_descendants (gnc_book_get_root_account (book_2));
+    for (auto node = accounts; node != nullptr; node = node->next)
+    {
+        auto acc_2 = GNC_ACCOUNT (node->data);
+        auto acc_3 = xaccAccountLookup (qof_instance_get_guid (acc_2), book_3);
+        auto query = qof_query_create_for (GNC_ID_SPLIT);
+        qof_query_set_book (query, book_3);
+        xaccQueryAddSingleAccountMatch (query, acc_3, QOF_QUERY_AND);
+        g_assert_cmpuint (g_list_length (qof_query_run (query)), == ,
+                          g_list_length (xaccAccountGetSplitList (acc_2)));
+        qof_query_destroy (query);
+    }
+    g_list_free (accounts);
+    compare_account_balances (book_2, book_3);
+
+    qof_session_ensure_all_data_loaded (session_3);
+    compare_books (book_2, book_3);
+    compare_account_balances (book_2, book_3);
+
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+}
+
+/* Time loading a book of LOAD_PERF_TRANSACTIONS transactions. */
+static void
+test_dbi_load_performance (Fixture* fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto loglevel = static_cast<GLogLevelFlags> (G_LOG_LEVEL_WARNING |
+                                                 G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (nullptr, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                                                 (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto session_2 = qof_session_new ();
+    qof_session_begin (session_2, url, FALSE, TRUE, TRUE);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+
+    auto session_3 = qof_session_new ();
+    qof_session_begin (session_3, url, TRUE, FALSE, FALSE);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    g_test_timer_start ();
+    qof_session_load (session_3, NULL);
+    auto elapsed = g_test_timer_elapsed ();
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    auto book = qof_session_get_book (session_3);
+    g_assert_cmpuint (qof_collection_count (qof_book_get_collection (book, GNC_ID_TRANS)),
+                      == , LOAD_PERF_TRANSACTIONS);
+    g_test_message ("Loading %d transactions took %.3f s",
+                    LOAD_PERF_TRANSACTIONS, elapsed);
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+
+    g_setenv ("GNC_SQL_LOAD_THREADS", "4", TRUE);
+    auto session_4 = qof_session_new ();
+    qof_session_begin (session_4, url, TRUE, FALSE, FALSE);
+    g_assert_cmpint (qof_session_get_error (session_4), == , ERR_BACKEND_NO_ERR);
+    g_test_timer_start ();
+    qof_session_load (session_4, NULL);
+    elapsed = g_test_timer_elapsed ();
+    g_assert_cmpint (qof_session_get_error (session_4), == , ERR_BACKEND_NO_ERR);
+    book = qof_session_get_book (session_4);
+    g_assert_cmpuint (qof_collection_count (qof_book_get_collection (book, GNC_ID_TRANS)),
+                      == , LOAD_PERF_TRANSACTIONS);
+    g_test_message ("Loading them while reading ahead on 4 connections "
+                    "took %.3f s", elapsed);
+    qof_session_end (session_4);
+    qof_session_destroy (session_4);
+    g_unsetenv ("GNC_SQL_LOAD_THREADS");
+}
+
 /** Test the safe_save mechanism.  Beware that this test used on its
  * own doesn't ensure that the resave is done safely, only that the
  * database is intact and unchanged after the save. To observe the
@@ -640,12 +996,25 @@ create_dbi_test_suite (const char* dbm_name, const char* url)
     auto subsuite = g_strdup_printf ("%s/%s", suitename, dbm_name);
     GNC_TEST_ADD (subsuite, "store_and_reload", Fixture, url, setup,
                   test_dbi_store_and_reload, teardown);
+    GNC_TEST_ADD (subsuite, "store_and_reload_batched", Fixture, url, setup,
+                  test_dbi_store_and_reload_batched, teardown);
+    GNC_TEST_ADD (subsuite, "store_and_reload_paged", Fixture, url, setup,
+                  test_dbi_store_and_reload_paged, teardown);
+    GNC_TEST_ADD (subsuite, "store_and_reload_threaded", Fixture, url, setup,
+                  test_dbi_store_and_reload_threaded, teardown);
+    GNC_TEST_ADD (subsuite, "lazy_load", Fixture, url, setup,
+                  test_dbi_lazy_load, teardown);
+    GNC_TEST_ADD (subsuite, "write_behind", Fixture, url, setup,
+                  test_dbi_write_behind, teardown);
     GNC_TEST_ADD (subsuite, "safe_save", Fixture, url, setup_memory,
                   test_dbi_safe_save, teardown);
     GNC_TEST_ADD (subsuite, "version_control", Fixture, url, setup_memory,
                   test_dbi_version_control, teardown);
     GNC_TEST_ADD (subsuite, "business_store_and_reload", Fixture, url,
                   setup_business, test_dbi_version_control, teardown);
+    if (g_test_perf () && g_strcmp0 (dbm_name, "sqlite3") == 0)
+        GNC_TEST_ADD (subsuite, "load_performance", Fixture, url, setup_large,
+                      test_dbi_load_performance, teardown);
     g_free (subsuite);
 
 }
@@ -221,8 +221,7 @@ GncSqlAccountBackend::load_all (GncSqlBackend* sql_be)
     pBook = sql_be->book();
 
     std::stringstream sql;
-    sql << "SELECT * FROM " << TABLE_NAME;
-    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    auto stmt = sql_be->create_statement_from_sql(select_all_sql());
     auto result = sql_be->execute_select_statement(stmt);
     for (auto row : *result)
         load_single_account (sql_be, row, l_accounts_needing_parents);
@@ -275,30 +274,33 @@ GncSqlAccountBackend::load_all (GncSqlBackend* sql_be)
 			     });
     }
 
-#if LOAD_TRANSACTIONS_AS_NEEDED
-    /* Load starting balances */
-    auto bal_slist = gnc_sql_get_account_balances_slist (sql_be);
-    for (auto bal = bal_slist; bal != NULL; bal = bal->next)
+    /* Transactions are loaded as they are needed, so start every account
+     * from its balance in the database. */
+    if (sql_be->transactions_deferred())
     {
-        acct_balances_t* balances = (acct_balances_t*)bal->data;
-
-        qof_instance_increase_editlevel (balances->acct);
-        g_object_set (balances->acct,
-                      "start-balance", &balances->balance,
-                      "start-cleared-balance", &balances->cleared_balance,
-                      "start-reconciled-balance", &balances->reconciled_balance,
-                      NULL);
+        auto bal_slist = gnc_sql_get_account_balances_slist (sql_be);
+        for (auto bal = bal_slist; bal != NULL; bal = bal->next)
+        {
+            acct_balances_t* balances = (acct_balances_t*)bal->data;
 
-        qof_instance_decrease_editlevel (balances->acct);
-    }
-    if (bal_slist != NULL)
-    {
-        g_slist_free (bal_slist);
+            gnc_account_set_start_balance (balances->acct, balances->balance);
+            gnc_account_set_start_cleared_balance (balances->acct,
+                                                   balances->cleared_balance);
+            gnc_account_set_start_reconciled_balance (balances->acct,
+                                                      balances->reconciled_balance);
+        }
+        g_slist_free_full (bal_slist, g_free);
     }
-#endif
     LEAVE ("");
 }
 
+std::vector<std::string>
+GncSqlAccountBackend::load_all_queries (GncSqlBackend* sql_be) const
+{
+    return {select_all_sql (),
+            gnc_sql_slots_subquery_sql ("SELECT DISTINCT guid FROM " + m_table_name)};
+}
+
 /* ================================================================= */
 bool
 GncSqlAccountBackend::commit (GncSqlBackend* sql_be, QofInstance* inst)
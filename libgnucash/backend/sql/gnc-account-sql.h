@@ -36,6 +36,7 @@ class GncSqlAccountBackend : public GncSqlObjectBackend
 public:
     GncSqlAccountBackend();
     void load_all(GncSqlBackend*) override;
+    std::vector<std::string> load_all_queries(GncSqlBackend*) const override;
     bool commit(GncSqlBackend*, QofInstance*) override;
 };
 
@@ -230,9 +230,7 @@ GncSqlBillTermBackend::load_all (GncSqlBackend* sql_be)
 
     g_return_if_fail (sql_be != NULL);
 
-    std::stringstream sql;
-    sql << "SELECT * FROM " << TABLE_NAME;
-    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    auto stmt = sql_be->create_statement_from_sql(select_all_sql());
     auto result = sql_be->execute_select_statement(stmt);
     InstanceVec instances;
     BillTermParentGuidVec l_billterms_needing_parents;
@@ -283,6 +281,12 @@ GncSqlBillTermBackend::load_all (GncSqlBackend* sql_be)
     }
 }
 
+std::vector<std::string>
+GncSqlBillTermBackend::load_all_queries (GncSqlBackend* sql_be) const
+{
+    return {select_all_sql ()};
+}
+
 /* ================================================================= */
 
 static void
@@ -330,9 +330,7 @@ GncSqlBudgetBackend::load_all (GncSqlBackend* sql_be)
     InstanceVec instances;
     g_return_if_fail (sql_be != NULL);
 
-    std::stringstream sql;
-    sql << "SELECT * FROM " << BUDGET_TABLE;
-    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    auto stmt = sql_be->create_statement_from_sql(select_all_sql());
     auto result = sql_be->execute_select_statement(stmt);
     for (auto row : *result)
     {
@@ -345,6 +343,12 @@ GncSqlBudgetBackend::load_all (GncSqlBackend* sql_be)
         gnc_sql_slots_load_for_instancevec (sql_be, instances);
 }
 
+std::vector<std::string>
+GncSqlBudgetBackend::load_all_queries (GncSqlBackend* sql_be) const
+{
+    return {select_all_sql ()};
+}
+
 /* ================================================================= */
 void
 GncSqlBudgetBackend::create_tables (GncSqlBackend* sql_be)
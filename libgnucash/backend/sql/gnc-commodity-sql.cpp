@@ -142,9 +142,7 @@ GncSqlCommodityBackend::load_all (GncSqlBackend* sql_be)
     gnc_commodity_table* pTable;
 
     pTable = gnc_commodity_table_get_table (sql_be->book());
-    std::stringstream sql;
-    sql << "SELECT * FROM " << COMMODITIES_TABLE;
-    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    auto stmt = sql_be->create_statement_from_sql(select_all_sql());
     auto result = sql_be->execute_select_statement(stmt);
 
     for (auto row : *result)
@@ -161,12 +159,19 @@ GncSqlCommodityBackend::load_all (GncSqlBackend* sql_be)
                 sql_be->commodity_for_postload_processing(pCommodity);
             qof_instance_set_guid (QOF_INSTANCE (pCommodity), &guid);
         }
-
-        auto sql = g_strdup_printf ("SELECT DISTINCT guid FROM %s", COMMODITIES_TABLE);
-        gnc_sql_slots_load_for_sql_subquery (sql_be, sql,
-                                             (BookLookupFn)gnc_commodity_find_commodity_by_guid);
-        g_free (sql);
     }
+
+    auto sql = g_strdup_printf ("SELECT DISTINCT guid FROM %s", COMMODITIES_TABLE);
+    gnc_sql_slots_load_for_sql_subquery (sql_be, sql,
+                                         (BookLookupFn)gnc_commodity_find_commodity_by_guid);
+    g_free (sql);
+}
+
+std::vector<std::string>
+GncSqlCommodityBackend::load_all_queries (GncSqlBackend* sql_be) const
+{
+    return {select_all_sql (),
+            gnc_sql_slots_subquery_sql ("SELECT DISTINCT guid FROM " + m_table_name)};
 }
 /* ================================================================= */
 static gboolean
@@ -42,6 +42,7 @@ class GncSqlCommodityBackend : public GncSqlObjectBackend
 public:
     GncSqlCommodityBackend();
     void load_all(GncSqlBackend*) override;
+    std::vector<std::string> load_all_queries(GncSqlBackend*) const override;
     bool commit(GncSqlBackend*, QofInstance*) override;
 };
 
@@ -37,6 +37,7 @@ class GncSqlEmployeeBackend : public GncSqlObjectBackend
 public:
     GncSqlEmployeeBackend();
     void load_all(GncSqlBackend*) override;
+    std::vector<std::string> load_all_queries(GncSqlBackend*) const override;
     void create_tables(GncSqlBackend*) override;
     bool commit(GncSqlBackend*, QofInstance*) override;
     bool write(GncSqlBackend*) override;
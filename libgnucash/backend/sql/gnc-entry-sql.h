@@ -37,6 +37,7 @@ class GncSqlEntryBackend : public GncSqlObjectBackend
 public:
     GncSqlEntryBackend();
     void load_all(GncSqlBackend*) override;
+    std::vector<std::string> load_all_queries(GncSqlBackend*) const override;
     void create_tables(GncSqlBackend*) override;
     bool write(GncSqlBackend*) override;
 };
@@ -129,9 +129,7 @@ GncSqlInvoiceBackend::load_all (GncSqlBackend* sql_be)
 {
     g_return_if_fail (sql_be != NULL);
 
-    std::stringstream sql;
-    sql << "SELECT * FROM " << TABLE_NAME;
-    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    auto stmt = sql_be->create_statement_from_sql(select_all_sql());
     auto result = sql_be->execute_select_statement(stmt);
     InstanceVec instances;
 
@@ -146,6 +144,12 @@ GncSqlInvoiceBackend::load_all (GncSqlBackend* sql_be)
         gnc_sql_slots_load_for_instancevec (sql_be, instances);
 }
 
+std::vector<std::string>
+GncSqlInvoiceBackend::load_all_queries (GncSqlBackend* sql_be) const
+{
+    return {select_all_sql ()};
+}
+
 /* ================================================================= */
 void
 GncSqlInvoiceBackend::create_tables (GncSqlBackend* sql_be)
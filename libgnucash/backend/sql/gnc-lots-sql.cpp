@@ -124,9 +124,7 @@ GncSqlLotsBackend::load_all (GncSqlBackend* sql_be)
 {
     g_return_if_fail (sql_be != NULL);
 
-    std::stringstream sql;
-    sql << "SELECT * FROM " << TABLE_NAME;
-    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    auto stmt = sql_be->create_statement_from_sql(select_all_sql());
     if (stmt != nullptr)
     {
         auto result = sql_be->execute_select_statement(stmt);
@@ -142,6 +140,13 @@ GncSqlLotsBackend::load_all (GncSqlBackend* sql_be)
     }
 }
 
+std::vector<std::string>
+GncSqlLotsBackend::load_all_queries (GncSqlBackend* sql_be) const
+{
+    return {select_all_sql (),
+            gnc_sql_slots_subquery_sql ("SELECT DISTINCT guid FROM " + m_table_name)};
+}
+
 /* ================================================================= */
 void
 GncSqlLotsBackend::create_tables (GncSqlBackend* sql_be)
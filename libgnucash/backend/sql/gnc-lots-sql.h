@@ -36,6 +36,7 @@ class GncSqlLotsBackend : public GncSqlObjectBackend
 public:
     GncSqlLotsBackend();
     void load_all(GncSqlBackend*) override;
+    std::vector<std::string> load_all_queries(GncSqlBackend*) const override;
     void create_tables(GncSqlBackend*) override;
     bool write(GncSqlBackend*) override;
 };
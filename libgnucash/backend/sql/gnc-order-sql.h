@@ -37,6 +37,7 @@ class GncSqlOrderBackend : public GncSqlObjectBackend
 public:
     GncSqlOrderBackend();
     void load_all(GncSqlBackend*) override;
+    std::vector<std::string> load_all_queries(GncSqlBackend*) const override;
     bool write(GncSqlBackend*) override;
 };
 
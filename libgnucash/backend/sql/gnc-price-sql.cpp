@@ -102,9 +102,7 @@ GncSqlPriceBackend::load_all (GncSqlBackend* sql_be)
 
     pBook = sql_be->book();
     pPriceDB = gnc_pricedb_get_db (pBook);
-    std::stringstream sql;
-    sql << "SELECT * FROM " << TABLE_NAME;
-    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    auto stmt = sql_be->create_statement_from_sql(select_all_sql());
     if (stmt != nullptr)
     {
         auto result = sql_be->execute_select_statement(stmt);
@@ -133,6 +131,13 @@ GncSqlPriceBackend::load_all (GncSqlBackend* sql_be)
     }
 }
 
+std::vector<std::string>
+GncSqlPriceBackend::load_all_queries (GncSqlBackend* sql_be) const
+{
+    return {select_all_sql (),
+            gnc_sql_slots_subquery_sql ("SELECT DISTINCT guid FROM " + m_table_name)};
+}
+
 /* ================================================================= */
 void
 GncSqlPriceBackend::create_tables (GncSqlBackend* sql_be)
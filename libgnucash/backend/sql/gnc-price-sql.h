@@ -36,6 +36,7 @@ class GncSqlPriceBackend : public GncSqlObjectBackend
 public:
     GncSqlPriceBackend();
     void load_all(GncSqlBackend*) override;
+    std::vector<std::string> load_all_queries(GncSqlBackend*) const override;
     void create_tables(GncSqlBackend*) override;
     bool commit (GncSqlBackend* sql_be, QofInstance* inst) override;
     bool write(GncSqlBackend*) override;
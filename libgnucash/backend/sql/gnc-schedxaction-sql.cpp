@@ -120,9 +120,7 @@ GncSqlSchedXactionBackend::load_all (GncSqlBackend* sql_be)
 {
     g_return_if_fail (sql_be != NULL);
 
-    std::stringstream sql;
-    sql << "SELECT * FROM " << SCHEDXACTION_TABLE;
-    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    auto stmt = sql_be->create_statement_from_sql(select_all_sql());
     if (stmt == NULL) return;
     auto result = sql_be->execute_select_statement(stmt);
     SchedXactions* sxes;
@@ -145,6 +143,12 @@ GncSqlSchedXactionBackend::load_all (GncSqlBackend* sql_be)
         gnc_sql_slots_load_for_instancevec (sql_be, instances);
 }
 
+std::vector<std::string>
+GncSqlSchedXactionBackend::load_all_queries (GncSqlBackend* sql_be) const
+{
+    return {select_all_sql ()};
+}
+
 
 /* ================================================================= */
 bool
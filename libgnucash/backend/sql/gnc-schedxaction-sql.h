@@ -39,6 +39,7 @@ class GncSqlSchedXactionBackend : public GncSqlObjectBackend
 public:
     GncSqlSchedXactionBackend();
     void load_all(GncSqlBackend*) override;
+    std::vector<std::string> load_all_queries(GncSqlBackend*) const override;
     bool commit (GncSqlBackend* sql_be, QofInstance* inst) override;
 };
 
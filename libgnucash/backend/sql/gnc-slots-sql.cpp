@@ -40,8 +40,10 @@ extern "C"
 #endif
 }
 
+#include <set>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
@@ -655,6 +657,103 @@ save_slot (const char* key, KvpValue* value, slot_info_t & slot_info)
     slot_info.path.erase(curlen);
 }
 
+/* The guid_vals of the frame and list rows saved for key under guid. */
+static std::vector<GncGUID>
+get_saved_child_guids (GncSqlBackend* sql_be, const GncGUID* guid,
+                       const std::string& key)
+{
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    std::vector<GncGUID> guids;
+
+    (void)guid_to_string_buff (guid, guid_buf);
+    std::stringstream sql;
+    sql << "SELECT * FROM " << TABLE_NAME << " WHERE obj_guid='" << guid_buf
+        << "' and name=" << sql_be->quote_string (key)
+        << " and slot_type in ('" << static_cast<int>(KvpValue::Type::FRAME)
+        << "', '" << static_cast<int>(KvpValue::Type::GLIST)
+        << "') and not guid_val is null";
+    auto stmt = sql_be->create_statement_from_sql (sql.str());
+    if (stmt == nullptr)
+        return guids;
+    auto result = sql_be->execute_select_statement (stmt);
+    for (auto row : *result)
+    {
+        try
+        {
+            GncGUID child_guid;
+            auto val = row.get_string_at_col (col_table[guid_val_col]->name());
+            if (string_to_guid (val.c_str(), &child_guid))
+                guids.push_back (child_guid);
+        }
+        catch (std::invalid_argument)
+        {
+            continue;
+        }
+    }
+    delete result;
+    return guids;
+}
+
+/* Delete the saved rows of the slot at key under guid, including those
+ * of any frame or list it holds. */
+static gboolean
+slots_delete_key (GncSqlBackend* sql_be, const GncGUID* guid,
+                  const std::string& key)
+{
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+
+    for (auto& child_guid : get_saved_child_guids (sql_be, guid, key))
+        gnc_sql_slots_delete (sql_be, &child_guid);
+
+    (void)guid_to_string_buff (guid, guid_buf);
+    std::stringstream sql;
+    sql << "DELETE FROM " << TABLE_NAME << " WHERE obj_guid='" << guid_buf
+        << "' and name=" << sql_be->quote_string (key);
+    auto stmt = sql_be->create_statement_from_sql (sql.str());
+    if (stmt == nullptr)
+        return FALSE;
+    return sql_be->execute_nonselect_statement (stmt) != -1;
+}
+
+/* Rewrite the slots of pFrame that changed since it was loaded or last
+ * saved. A frame that only changed somewhere below is not rewritten
+ * itself: its saved row is looked up and its own changes written under
+ * that row's guid. */
+static void
+save_changed_slots (KvpFrame* pFrame, slot_info_t& slot_info)
+{
+    for (auto const& key : pFrame->get_changed_keys())
+    {
+        auto value = pFrame->get_slot ({key});
+        if (value != nullptr && !pFrame->slot_replaced (key) &&
+            value->get_type() == KvpValue::Type::FRAME &&
+            !value->get<KvpFrame*>()->all_changed())
+        {
+            auto guids = get_saved_child_guids (slot_info.be, slot_info.guid,
+                                                key);
+            if (guids.size() == 1)
+            {
+                slot_info_t* pNewInfo = slot_info_copy (&slot_info, &guids[0]);
+                save_changed_slots (value->get<KvpFrame*>(), *pNewInfo);
+                slot_info.is_ok = pNewInfo->is_ok;
+                delete pNewInfo;
+                if (!slot_info.is_ok)
+                    return;
+                continue;
+            }
+        }
+        if (!slots_delete_key (slot_info.be, slot_info.guid, key))
+        {
+            slot_info.is_ok = FALSE;
+            return;
+        }
+        if (value != nullptr)
+            save_slot (key.c_str(), value, slot_info);
+        if (!slot_info.is_ok)
+            return;
+    }
+}
+
 gboolean
 gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infant,
                     QofInstance* inst)
@@ -667,16 +766,29 @@ gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infa
     g_return_val_if_fail (guid != NULL, FALSE);
     g_return_val_if_fail (pFrame != NULL, FALSE);
 
-    // If this is not saving into a new db, clear out the old saved slots first
-    if (!sql_be->pristine() && !is_infant)
+    slot_info.be = sql_be;
+    slot_info.guid = guid;
+
+    /* A new db or a new object has nothing saved to replace. Otherwise
+     * write only what changed since the slots were loaded or last saved,
+     * unless the frame doesn't know, in which case clear out the old
+     * saved slots first. */
+    if (sql_be->pristine() || is_infant)
+    {
+        pFrame->for_each_slot_temp (save_slot, slot_info);
+    }
+    else if (pFrame->all_changed())
     {
         (void)gnc_sql_slots_delete (sql_be, guid);
+        pFrame->for_each_slot_temp (save_slot, slot_info);
+    }
+    else
+    {
+        save_changed_slots (pFrame, slot_info);
     }
 
-    slot_info.be = sql_be;
-    slot_info.guid = guid;
-    pFrame->for_each_slot_temp (save_slot, slot_info);
-
+    if (slot_info.is_ok)
+        pFrame->clear_changes();
     return slot_info.is_ok;
 }
 
@@ -769,6 +881,7 @@ gnc_sql_slots_load (GncSqlBackend* sql_be, QofInstance* inst)
     info.context = NONE;
 
     slots_load_info (&info);
+    info.pKvpFrame->clear_changes();
 }
 
 static void
@@ -823,14 +936,13 @@ load_slot_for_list_item (GncSqlBackend* sql_be, GncSqlRow& row,
     guid = load_obj_guid (sql_be, row);
     g_assert (guid != NULL);
     inst = qof_collection_lookup_entity (coll, guid);
+    if (inst == NULL) return; /* Not one of the objects being loaded. */
 
     slot_info.be = sql_be;
     slot_info.pKvpFrame = qof_instance_get_slots (inst);
     slot_info.context = NONE;
 
     gnc_sql_load_object (sql_be, row, TABLE_NAME, &slot_info, col_table);
-
-
 }
 
 void
@@ -869,9 +981,37 @@ gnc_sql_slots_load_for_instancevec (GncSqlBackend* sql_be, InstanceVec& instance
     auto result = sql_be->execute_select_statement (stmt);
     for (auto row : *result)
         load_slot_for_list_item (sql_be, row, coll);
+    for (auto inst : instances)
+        qof_instance_get_slots (inst)->clear_changes();
 }
 
-static void
+void
+gnc_sql_slots_load_for_instancevec (GncSqlBackend* sql_be,
+                                    InstanceVec& instances,
+                                    const std::string& subquery)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    // Ignore empty list
+    if (instances.empty()) return;
+
+    auto coll = qof_instance_get_collection (instances[0]);
+    auto sql = gnc_sql_slots_subquery_sql (subquery);
+    auto stmt = sql_be->create_statement_from_sql(sql);
+    if (stmt == nullptr)
+    {
+        PERR ("stmt == NULL, SQL = '%s'\n", sql.c_str());
+        return;
+    }
+    auto result = sql_be->execute_select_statement (stmt);
+    for (auto row : *result)
+        load_slot_for_list_item (sql_be, row, coll);
+    delete result;
+    for (auto inst : instances)
+        qof_instance_get_slots (inst)->clear_changes();
+}
+
+static KvpFrame*
 load_slot_for_book_object (GncSqlBackend* sql_be, GncSqlRow& row,
                            BookLookupFn lookup_fn)
 {
@@ -880,19 +1020,20 @@ load_slot_for_book_object (GncSqlBackend* sql_be, GncSqlRow& row,
     const GncGUID* guid;
     QofInstance* inst;
 
-    g_return_if_fail (sql_be != NULL);
-    g_return_if_fail (lookup_fn != NULL);
+    g_return_val_if_fail (sql_be != NULL, nullptr);
+    g_return_val_if_fail (lookup_fn != NULL, nullptr);
 
     guid = load_obj_guid (sql_be, row);
-    g_return_if_fail (guid != NULL);
+    g_return_val_if_fail (guid != NULL, nullptr);
     inst = lookup_fn (guid, sql_be->book());
-    if (inst == NULL) return; /* Silently bail if the guid isn't loaded yet. */
+    if (inst == NULL) return nullptr; /* Silently bail if the guid isn't loaded yet. */
 
     slot_info.be = sql_be;
     slot_info.pKvpFrame = qof_instance_get_slots (inst);
     slot_info.path.clear();
 
     gnc_sql_load_object (sql_be, row, TABLE_NAME, &slot_info, col_table);
+    return slot_info.pKvpFrame;
 }
 
 /**
@@ -904,34 +1045,39 @@ load_slot_for_book_object (GncSqlBackend* sql_be, GncSqlRow& row,
  * @param subquery Subquery SQL string
  * @param lookup_fn Lookup function
  */
+std::string
+gnc_sql_slots_subquery_sql (const std::string& subquery)
+{
+    return std::string{"SELECT * FROM "} + TABLE_NAME + " WHERE " +
+        obj_guid_col_table[0]->name() + " IN (" + subquery + ")";
+}
+
 void gnc_sql_slots_load_for_sql_subquery (GncSqlBackend* sql_be,
                                           const gchar* subquery,
                                           BookLookupFn lookup_fn)
 {
-    gchar* sql;
-
     g_return_if_fail (sql_be != NULL);
 
     // Ignore empty subquery
     if (subquery == NULL) return;
 
-    sql = g_strdup_printf ("SELECT * FROM %s WHERE %s IN (%s)",
-                           TABLE_NAME, obj_guid_col_table[0]->name(),
-                           subquery);
+    auto sql = gnc_sql_slots_subquery_sql (subquery);
 
     // Execute the query and load the slots
     auto stmt = sql_be->create_statement_from_sql(sql);
     if (stmt == nullptr)
     {
-        PERR ("stmt == NULL, SQL = '%s'\n", sql);
-        g_free (sql);
+        PERR ("stmt == NULL, SQL = '%s'\n", sql.c_str());
         return;
     }
-    g_free (sql);
     auto result = sql_be->execute_select_statement(stmt);
+    std::set<KvpFrame*> frames;
     for (auto row : *result)
-        load_slot_for_book_object (sql_be, row, lookup_fn);
+        frames.insert (load_slot_for_book_object (sql_be, row, lookup_fn));
     delete result;
+    frames.erase (nullptr);
+    for (auto frame : frames)
+        frame->clear_changes();
 }
 
 /* ================================================================= */
@@ -87,6 +87,19 @@ void gnc_sql_slots_load (GncSqlBackend* sql_be, QofInstance* inst);
 void gnc_sql_slots_load_for_instancevec (GncSqlBackend* sql_be,
                                          InstanceVec& instances);
 
+/**
+ * gnc_sql_slots_load_for_instancevec - Loads slots for a set of QofInstance*
+ * whose guids are supplied by a subquery of the form "SELECT guid FROM ...",
+ * so that the SQL doesn't grow with the set.
+ *
+ * @param sql_be SQL backend
+ * @param list List of objects
+ * @param subquery Subquery SQL string selecting the guids of the objects
+ */
+void gnc_sql_slots_load_for_instancevec (GncSqlBackend* sql_be,
+                                         InstanceVec& instances,
+                                         const std::string& subquery);
+
 typedef QofInstance* (*BookLookupFn) (const GncGUID* guid,
                                       const QofBook* book);
 
@@ -103,6 +116,15 @@ void gnc_sql_slots_load_for_sql_subquery (GncSqlBackend* sql_be,
                                           const gchar* subquery,
                                           BookLookupFn lookup_fn);
 
+/**
+ * gnc_sql_slots_subquery_sql - The SELECT that
+ * gnc_sql_slots_load_for_sql_subquery runs for the subquery.
+ *
+ * @param subquery Subquery SQL string
+ * @return The SQL of the slots SELECT
+ */
+std::string gnc_sql_slots_subquery_sql (const std::string& subquery);
+
 void gnc_sql_init_slots_handler (void);
 
 #endif /* GNC_SLOTS_SQL_H */
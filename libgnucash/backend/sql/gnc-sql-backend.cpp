@@ -32,10 +32,12 @@ extern "C"
 #include <gncTaxTable.h>
 #include <gncInvoice.h>
 #include <gnc-pricedb.h>
+#include <gnc-locale-utils.h>
 }
 
 #include <algorithm>
 #include <cassert>
+#include <system_error>
 
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
@@ -79,14 +81,56 @@ static EntryVec version_table
     gnc_sql_make_table_entry<CT_INT>(VERSION_COL_NAME, 0, COL_NNUL)
 };
 
+#define DEFAULT_BATCH_SIZE 500
+#define DEFAULT_PAGE_SIZE 10000
+/* commit() writes what it is holding once it holds this many objects, even if
+ * the timeout hasn't expired. */
+#define MAX_PENDING_COMMITS 1000
+
 GncSqlBackend::GncSqlBackend(GncSqlConnection *conn, QofBook* book) :
     QofBackend {}, m_conn{conn}, m_book{book}, m_loading{false},
-    m_in_query{false}, m_is_pristine_db{false}
+    m_in_query{false}, m_is_pristine_db{false}, m_batch_inserts{false},
+    m_batch_size{DEFAULT_BATCH_SIZE}, m_lazy_load{false},
+    m_all_tx_loaded{false}, m_load_threads{0}, m_page_size{DEFAULT_PAGE_SIZE},
+    m_write_behind{0}, m_flush_source{0}
 {
+    auto batch_size = g_getenv ("GNC_SQL_BATCH_SIZE");
+    if (batch_size != nullptr)
+        m_batch_size = static_cast<unsigned int>(g_ascii_strtoull (batch_size,
+                                                                   nullptr, 10));
+    auto lazy_load = g_getenv ("GNC_SQL_LAZY_LOAD");
+    if (lazy_load != nullptr)
+        m_lazy_load = g_strcmp0 (lazy_load, "0") != 0;
+    auto load_threads = g_getenv ("GNC_SQL_LOAD_THREADS");
+    if (load_threads != nullptr)
+        m_load_threads = static_cast<unsigned int>(g_ascii_strtoull (load_threads,
+                                                                     nullptr, 10));
+    /* Paged loads can't read ahead, so asking for readers turns paging off
+     * unless a page size is asked for too. */
+    auto page_size = g_getenv ("GNC_SQL_PAGE_SIZE");
+    if (page_size != nullptr)
+        m_page_size = static_cast<unsigned int>(g_ascii_strtoull (page_size,
+                                                                  nullptr, 10));
+    else if (m_load_threads > 0)
+        m_page_size = 0;
+    auto write_behind = g_getenv ("GNC_SQL_WRITE_BEHIND");
+    if (write_behind != nullptr)
+        m_write_behind = static_cast<unsigned int>(g_ascii_strtoull (write_behind,
+                                                                     nullptr, 10));
     if (conn != nullptr)
         connect (conn);
 }
 
+/* The connection may already be gone, so whatever is still held can't be
+ * written here; session_end() has done that. */
+GncSqlBackend::~GncSqlBackend()
+{
+    if (m_flush_source != 0)
+        g_source_remove (m_flush_source);
+    for (auto& pending : m_pending)
+        g_object_unref (pending.inst);
+}
+
 void
 GncSqlBackend::connect(GncSqlConnection *conn) noexcept
 {
@@ -111,6 +155,20 @@ GncSqlBackend::create_statement_from_sql(const std::string& str) const noexcept
 GncSqlResultPtr
 GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
+    /* The query may need the rows that are still waiting. */
+    flush_insert_batches ();
+    if (!m_prefetched.empty())
+    {
+        auto prefetched = m_prefetched.find (stmt->to_sql());
+        if (prefetched != m_prefetched.end())
+        {
+            auto result = prefetched->second.get();
+            m_prefetched.erase (prefetched);
+            /* If the reader failed, ask again on the main connection. */
+            if (result != nullptr)
+                return result;
+        }
+    }
     auto result = m_conn->execute_select_statement(stmt);
     if (result == nullptr)
     {
@@ -123,6 +181,7 @@ GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const no
 int
 GncSqlBackend::execute_nonselect_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
+    flush_insert_batches ();
     auto result = m_conn->execute_nonselect_statement(stmt);
     if (result == -1)
     {
@@ -266,12 +325,17 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
 
     ENTER ("sql_be=%p, book=%p", this, book);
 
+    /* The rows read must include what commit() is holding. */
+    flush_pending ();
     m_loading = TRUE;
 
     if (loadType == LOAD_TYPE_INITIAL_LOAD)
     {
         assert (m_book == nullptr);
         m_book = book;
+        m_all_tx_loaded = false;
+        m_tx_loaded_accounts.clear();
+        start_prefetch();
 
         /* Load any initial stuff. Some of this needs to happen in a certain order */
         for (auto type : fixed_load_order)
@@ -301,10 +365,12 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
 
         gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
                                        nullptr);
+        finish_prefetch();
     }
     else if (loadType == LOAD_TYPE_LOAD_ALL)
     {
         // Load all transactions
+        m_all_tx_loaded = true;
         auto obe = m_backend_registry.get_object_backend (GNC_ID_TRANS);
         obe->load_all (this);
     }
@@ -326,6 +392,150 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
     LEAVE ("");
 }
 
+using PrefetchJob = std::pair<GncSqlStatementPtr,
+                              std::promise<GncSqlResultPtr>>;
+using PrefetchJobs = std::vector<PrefetchJob>;
+
+static void
+run_prefetch_jobs (GncSqlConnection* reader, PrefetchJobs& jobs)
+{
+    for (auto& job : jobs)
+        job.second.set_value (job.first == nullptr ? nullptr :
+                              reader->execute_select_statement (job.first));
+}
+
+/* Run the SELECTs that the object backends' load_all()s will, on readers of
+ * their own, so that the database and the network are busy with the next
+ * tables while this thread makes objects from the last. Each reader runs its
+ * share in turn on a thread of its own. libdbi converts numbers in the
+ * current LC_NUMERIC locale and setlocale isn't safe while other threads
+ * use it, so the "C" locale is switched to here, once, and kept until
+ * finish_prefetch. */
+void
+GncSqlBackend::start_prefetch() noexcept
+{
+    if (m_load_threads == 0)
+        return;
+
+    StrVec queries;
+    for (auto entry : m_backend_registry)
+    {
+        auto obe_queries = std::get<1>(entry)->load_all_queries (this);
+        for (auto& sql : obe_queries)
+            if (std::find (queries.begin(), queries.end(), sql) == queries.end())
+                queries.push_back (sql);
+    }
+    auto wanted = std::min<size_t> (m_load_threads, queries.size());
+    while (m_readers.size() < wanted)
+    {
+        auto reader = m_conn->open_reader();
+        if (reader == nullptr)
+            break;
+        m_readers.push_back (reader);
+    }
+    if (m_readers.empty())
+        return;
+
+    gnc_push_locale (LC_NUMERIC, "C");
+    std::vector<std::shared_ptr<PrefetchJobs>> jobs;
+    for (size_t i = 0; i < m_readers.size(); ++i)
+        jobs.push_back (std::make_shared<PrefetchJobs>());
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        PrefetchJob job;
+        job.first = m_readers[i % m_readers.size()]->
+            create_statement_from_sql (queries[i]);
+        m_prefetched.emplace (queries[i], job.second.get_future());
+        jobs[i % m_readers.size()]->push_back (std::move (job));
+    }
+
+    for (size_t i = 0; i < m_readers.size(); ++i)
+    {
+        auto reader = m_readers[i];
+        auto reader_jobs = jobs[i];
+        try
+        {
+            m_prefetch_threads.emplace_back ([reader, reader_jobs]() {
+                    run_prefetch_jobs (reader, *reader_jobs);
+                });
+        }
+        catch (const std::system_error& err)
+        {
+            PWARN ("Unable to start a thread, reading ahead on this one: %s",
+                   err.what());
+            run_prefetch_jobs (reader, *reader_jobs);
+        }
+    }
+}
+
+void
+GncSqlBackend::finish_prefetch() noexcept
+{
+    if (m_readers.empty())
+        return;
+    for (auto& thread : m_prefetch_threads)
+        thread.join();
+    m_prefetch_threads.clear();
+    /* Results that nothing asked for must go before their readers do. */
+    for (auto& prefetched : m_prefetched)
+        delete prefetched.second.get();
+    m_prefetched.clear();
+    for (auto reader : m_readers)
+        delete reader;
+    m_readers.clear();
+    gnc_pop_locale (LC_NUMERIC);
+}
+
+void
+GncSqlBackend::load_for_query (QofBook* book, QofQuery* query)
+{
+    g_return_if_fail (book != nullptr);
+    g_return_if_fail (query != nullptr);
+
+    /* Queries run while loading must not start another load. */
+    if (!transactions_deferred() || m_loading || m_in_query || book != m_book)
+        return;
+
+    ENTER ("sql_be=%p, query=%p", this, query);
+    flush_pending ();
+    m_loading = true;
+    m_in_query = true;
+    auto loaded = gnc_sql_transaction_load_for_query (this, query);
+    m_in_query = false;
+    m_loading = false;
+    /* Nothing in the query narrows down what it can match. */
+    if (!loaded)
+        GncSqlBackend::load (book, LOAD_TYPE_LOAD_ALL);
+    LEAVE ("");
+}
+
+bool
+GncSqlBackend::sum_split_amounts (const QofInstance* inst,
+                                  const std::vector<time64>& bounds,
+                                  std::vector<gnc_numeric>& sums)
+{
+    if (!GNC_IS_ACCOUNT (inst) || bounds.empty())
+        return false;
+    /* Once they are all in memory the engine's own sums are as good. */
+    auto acc = GNC_ACCOUNT (inst);
+    if (!transactions_deferred() || account_tx_loaded (acc) ||
+        !flush_pending () || has_pending ())
+        return false;
+    return gnc_sql_get_account_period_sums (this, acc, bounds, sums);
+}
+
+bool
+GncSqlBackend::account_tx_loaded (const Account* acc) const noexcept
+{
+    return m_tx_loaded_accounts.find (acc) != m_tx_loaded_accounts.end();
+}
+
+void
+GncSqlBackend::set_account_tx_loaded (const Account* acc) noexcept
+{
+    m_tx_loaded_accounts.insert (acc);
+}
+
 /* ================================================================= */
 
 bool
@@ -442,6 +652,16 @@ GncSqlBackend::sync(QofBook* book)
 {
     g_return_if_fail (book != NULL);
 
+    /* Everything is about to be written anyway. */
+    for (auto& pending : m_pending)
+        g_object_unref (pending.inst);
+    m_pending.clear();
+    m_pending_index.clear();
+    if (m_flush_source != 0)
+    {
+        g_source_remove (m_flush_source);
+        m_flush_source = 0;
+    }
     reset_version_info();
     ENTER ("book=%p, sql_be->book=%p", book, m_book);
     update_progress();
@@ -452,6 +672,7 @@ GncSqlBackend::sync(QofBook* book)
 
     /* Save all contents */
     m_book = book;
+    m_batch_inserts = m_batch_size > 1;
     auto is_ok = m_conn->begin_transaction();
 
     // FIXME: should write the set of commodities that are used
@@ -483,6 +704,13 @@ GncSqlBackend::sync(QofBook* book)
             std::get<1>(entry)->write (this);
     }
     if (is_ok)
+    {
+        is_ok = flush_insert_batches();
+    }
+    m_batch_inserts = false;
+    m_insert_batches.clear();
+    m_saved_commodities.clear();
+    if (is_ok)
     {
         is_ok = m_conn->commit_transaction();
     }
@@ -544,7 +772,6 @@ GncSqlBackend::get_object_backend(const std::string& type) const noexcept
 void
 GncSqlBackend::commit (QofInstance* inst)
 {
-    sql_backend be_data;
     gboolean is_dirty;
     gboolean is_destroying;
     gboolean is_infant;
@@ -589,30 +816,28 @@ GncSqlBackend::commit (QofInstance* inst)
         return;
     }
 
-    if (!m_conn->begin_transaction ())
+    if (m_write_behind > 0 && !is_destroying)
     {
-        PERR ("begin_transaction failed\n");
-        LEAVE ("Rolled back - database transaction begin error");
+        queue_commit (inst);
+        LEAVE ("Held for writing later");
         return;
     }
 
-    bool is_ok = true;
-
-    auto obe = m_backend_registry.get_object_backend(std::string{inst->e_type});
-    if (obe != nullptr)
-        is_ok = obe->commit(this, inst);
-    else
+    /* Whatever is being held was committed first, so write it first. */
+    if (!flush_pending ())
     {
-        PERR ("Unknown object type '%s'\n", inst->e_type);
-        (void)m_conn->rollback_transaction ();
+        LEAVE ("Not written - earlier changes couldn't be written");
+        return;
+    }
 
-        // Don't let unknown items still mark the book as being dirty
-        qof_book_mark_session_saved(m_book);
-        qof_instance_mark_clean (inst);
-        LEAVE ("Rolled back - unknown object type");
+    if (!m_conn->begin_transaction ())
+    {
+        PERR ("begin_transaction failed\n");
+        LEAVE ("Rolled back - database transaction begin error");
         return;
     }
-    if (!is_ok)
+
+    if (!commit_instance (inst))
     {
         // Error - roll it back
         (void)m_conn->rollback_transaction();
@@ -630,6 +855,154 @@ GncSqlBackend::commit (QofInstance* inst)
     LEAVE ("");
 }
 
+/* Write inst within the caller's database transaction. Objects of unknown
+ * types are only marked clean, so that they don't keep the book dirty. */
+bool
+GncSqlBackend::commit_instance (QofInstance* inst)
+{
+    auto obe = m_backend_registry.get_object_backend(std::string{inst->e_type});
+    if (obe == nullptr)
+    {
+        PERR ("Unknown object type '%s'\n", inst->e_type);
+        qof_instance_mark_clean (inst);
+        return true;
+    }
+    return obe->commit(this, inst);
+}
+
+void
+GncSqlBackend::set_write_behind (unsigned int msec) noexcept
+{
+    m_write_behind = msec;
+    if (msec == 0)
+        flush_pending ();
+}
+
+static gboolean
+flush_pending_cb (gpointer data)
+{
+    static_cast<GncSqlBackend*>(data)->flush_pending ();
+    return G_SOURCE_REMOVE;
+}
+
+void
+GncSqlBackend::queue_commit (QofInstance* inst) noexcept
+{
+    hold_commit ({QOF_INSTANCE (g_object_ref (inst)),
+                  static_cast<bool>(qof_instance_get_infant (inst))});
+    if (m_pending.size() >= MAX_PENDING_COMMITS)
+        flush_pending ();
+    else if (m_flush_source == 0)
+        m_flush_source = g_timeout_add (m_write_behind, flush_pending_cb, this);
+}
+
+/* Add commit, whose reference m_pending takes over, to the end of the queue.
+ * An object that is already there keeps its place, so it is still written
+ * before anything that was committed after it the first time. */
+void
+GncSqlBackend::hold_commit (const PendingCommit& commit) noexcept
+{
+    auto found = m_pending_index.find (commit.inst);
+    if (found != m_pending_index.end())
+    {
+        m_pending[found->second].infant |= commit.infant;
+        g_object_unref (commit.inst);
+        return;
+    }
+    m_pending_index.emplace (commit.inst, m_pending.size());
+    m_pending.push_back (commit);
+}
+
+bool
+GncSqlBackend::flush_pending () noexcept
+{
+    if (m_flush_source != 0)
+    {
+        g_source_remove (m_flush_source);
+        m_flush_source = 0;
+    }
+    if (m_pending.empty())
+        return true;
+
+    ENTER ("%zu objects", m_pending.size());
+    auto pending = std::move (m_pending);
+    m_pending.clear();
+    m_pending_index.clear();
+
+    /* Objects open for edit again are written when that edit is committed:
+     * until then what they hold may still be rolled back. */
+    std::vector<bool> editing;
+    size_t to_write = 0;
+    for (auto& commit : pending)
+    {
+        editing.push_back (qof_instance_get_editlevel (commit.inst) > 0);
+        if (!editing.back())
+            ++to_write;
+    }
+
+    bool is_ok = true;
+    if (to_write > 0)
+    {
+        is_ok = m_conn->begin_transaction ();
+        if (!is_ok)
+            PERR ("begin_transaction failed\n");
+    }
+    if (is_ok && to_write > 0)
+    {
+        for (size_t i = 0; i < pending.size() && is_ok; ++i)
+        {
+            auto& commit = pending[i];
+            if (editing[i])
+                continue;
+            /* The object backends insert infants and update the rest. */
+            if (commit.infant)
+                qof_instance_set_infant (commit.inst, TRUE);
+            is_ok = commit_instance (commit.inst);
+            if (commit.infant)
+                qof_instance_set_infant (commit.inst, FALSE);
+        }
+        if (is_ok)
+            is_ok = m_conn->commit_transaction ();
+        else
+            (void)m_conn->rollback_transaction ();
+    }
+
+    /* Anything committed while writing goes after what is still held. */
+    auto queued = std::move (m_pending);
+    m_pending.clear();
+    m_pending_index.clear();
+    for (size_t i = 0; i < pending.size(); ++i)
+    {
+        auto& commit = pending[i];
+        if (is_ok && !editing[i])
+        {
+            qof_instance_mark_clean (commit.inst);
+            g_object_unref (commit.inst);
+        }
+        else
+        {
+            /* Still dirty, as commit() would have left it, and held to be
+             * written again by the next flush. */
+            qof_instance_set_dirty_flag (commit.inst, TRUE);
+            hold_commit (commit);
+        }
+    }
+    for (auto& commit : queued)
+        hold_commit (commit);
+
+    if (!is_ok)
+    {
+        PERR ("%zu objects couldn't be written; they are held to try again",
+              m_pending.size());
+        set_error (ERR_BACKEND_SERVER_ERR);
+    }
+    else if (m_pending.empty())
+        qof_book_mark_session_saved (m_book);
+
+    LEAVE ("%s", is_ok ? "" : "Rolled back - database error");
+    return is_ok;
+}
+
 
 /**
  * Sees if the version table exists, and if it does, loads the info into
@@ -827,6 +1200,15 @@ GncSqlBackend::do_db_operation (E_DB_OPERATION op, const char* table_name,
     g_return_val_if_fail (obj_name != nullptr, false);
     g_return_val_if_fail (pObject != nullptr, false);
 
+    if (m_batch_inserts && op == OP_DB_INSERT)
+    {
+        auto values = get_object_values (obj_name, pObject, table);
+        if (!values.empty())
+            return add_to_insert_batch (table_name, values);
+    }
+    if (!flush_insert_batches ())
+        return false;
+
     switch(op)
     {
         case  OP_DB_INSERT:
@@ -844,12 +1226,101 @@ GncSqlBackend::do_db_operation (E_DB_OPERATION op, const char* table_name,
     return (execute_nonselect_statement(stmt) != -1);
 }
 
+bool
+GncSqlBackend::add_to_insert_batch (const char* table_name,
+                                    const PairVec& values) const noexcept
+{
+    auto same_columns = [&values](const InsertBatch& batch) {
+        return batch.columns.size() == values.size() &&
+            std::equal (batch.columns.begin(), batch.columns.end(),
+                        values.begin(),
+                        [](const std::string& col,
+                           const std::pair<std::string, std::string>& val)
+                        { return col == val.first; });
+    };
+    auto batch = std::find_if (m_insert_batches.begin(), m_insert_batches.end(),
+                               [&](const InsertBatch& entry) {
+                                   return entry.table_name == table_name &&
+                                       same_columns (entry);
+                               });
+    if (batch == m_insert_batches.end())
+    {
+        InsertBatch new_batch{table_name, {}, {}, 0};
+        for (auto const& col_value : values)
+            new_batch.columns.push_back (col_value.first);
+        m_insert_batches.push_back (std::move (new_batch));
+        batch = m_insert_batches.end() - 1;
+    }
+
+    batch->rows += batch->count ? ",(" : "(";
+    for (auto const& col_value : values)
+    {
+        if (&col_value != &values.front())
+            batch->rows += ",";
+        batch->rows += col_value.second;
+    }
+    batch->rows += ")";
+    if (++batch->count < m_batch_size)
+        return true;
+
+    auto full = std::move (*batch);
+    m_insert_batches.erase (batch);
+    return execute_insert_batch (full);
+}
+
+bool
+GncSqlBackend::execute_insert_batch (const InsertBatch& batch) const noexcept
+{
+    std::string sql{"INSERT INTO "};
+    sql.reserve (batch.rows.size() + 256);
+    sql += batch.table_name + "(";
+    for (auto const& col : batch.columns)
+    {
+        if (&col != &batch.columns.front())
+            sql += ",";
+        sql += col;
+    }
+    sql += ") VALUES";
+    sql += batch.rows;
+
+    auto stmt = m_conn->create_statement_from_sql (sql);
+    if (stmt != nullptr && m_conn->execute_nonselect_statement (stmt) != -1)
+        return true;
+    PERR ("SQL error inserting %u rows into %s\n", batch.count,
+          batch.table_name.c_str());
+    qof_backend_set_error ((QofBackend*)this, ERR_BACKEND_SERVER_ERR);
+    return false;
+}
+
+bool
+GncSqlBackend::flush_insert_batches () const noexcept
+{
+    if (m_insert_batches.empty())
+        return true;
+
+    std::vector<InsertBatch> batches;
+    batches.swap (m_insert_batches);
+    auto is_ok = true;
+    for (auto const& batch : batches)
+        is_ok = execute_insert_batch (batch) && is_ok;
+    return is_ok;
+}
+
 bool
 GncSqlBackend::save_commodity(gnc_commodity* comm) noexcept
 {
     if (comm == nullptr) return false;
     QofInstance* inst = QOF_INSTANCE(comm);
     auto obe = m_backend_registry.get_object_backend(std::string(inst->e_type));
+    /* sync() writes into new tables, so the commodity is there if and
+     * only if sync() has written it; don't make every transaction wait
+     * for its batch to go out just to look. */
+    if (m_batch_inserts)
+    {
+        if (!obe || !m_saved_commodities.insert (comm).second)
+            return true;
+        return obe->commit(this, inst);
+    }
     if (obe && !obe->instance_in_db(this, inst))
         return obe->commit(this, inst);
     return true;
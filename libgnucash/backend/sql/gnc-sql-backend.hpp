@@ -31,13 +31,19 @@ extern "C"
 }
 #include <memory>
 #include <exception>
+#include <future>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <qof-backend.hpp>
 
 class GncSqlColumnTableEntry;
 using GncSqlColumnTableEntryPtr = std::shared_ptr<GncSqlColumnTableEntry>;
 using EntryVec = std::vector<GncSqlColumnTableEntryPtr>;
+using PairVec = std::vector<std::pair<std::string, std::string>>;
 class GncSqlObjectBackend;
 using GncSqlObjectBackendPtr = std::shared_ptr<GncSqlObjectBackend>;
 using OBEEntry = std::tuple<std::string, GncSqlObjectBackendPtr>;
@@ -66,13 +72,27 @@ class GncSqlBackend : public QofBackend
 {
 public:
     GncSqlBackend(GncSqlConnection *conn, QofBook* book);
-    virtual ~GncSqlBackend() = default;
+    virtual ~GncSqlBackend();
     /**
      * Load the contents of an SQL database into a book.
      *
      * @param book Book to be loaded
      */
     void load(QofBook*, QofBackendLoadType) override;
+    /**
+     * Load the transactions that a query might match, if the initial load
+     * deferred them.
+     *
+     * @param book Book being queried
+     * @param query The query about to be run
+     */
+    void load_for_query(QofBook*, QofQuery*) override;
+    /**
+     * Sum an account's split amounts by date posted in the database, while
+     * the account's transactions haven't all been loaded.
+     */
+    bool sum_split_amounts(const QofInstance*, const std::vector<time64>&,
+                           std::vector<gnc_numeric>&) override;
     /**
      * Save the contents of a book to an SQL database.
      *
@@ -234,9 +254,72 @@ public:
      * @return true if the commodity needed to be saved.
      */
     bool save_commodity(gnc_commodity* comm) noexcept;
+    /**
+     * Set the number of rows sync() puts in each multi-row INSERT. 0 or 1
+     * writes every row with its own INSERT. The default is 500, or the
+     * value of the GNC_SQL_BATCH_SIZE environment variable.
+     */
+    void set_batch_size(unsigned int size) noexcept { m_batch_size = size; }
+    unsigned int batch_size() const noexcept { return m_batch_size; }
     QofBook* book() const noexcept { return m_book; }
     void set_loading(bool loading) noexcept { m_loading = loading; }
     bool pristine() const noexcept { return m_is_pristine_db; }
+    /**
+     * Whether the initial load leaves transactions in the database until a
+     * query needs them, taking the account start balances from the database
+     * instead. Set by the GNC_SQL_LAZY_LOAD environment variable.
+     */
+    void set_lazy_load(bool lazy) noexcept { m_lazy_load = lazy; }
+    bool lazy_load() const noexcept { return m_lazy_load; }
+    /** Some transactions may still be in the database only. */
+    bool transactions_deferred() const noexcept
+    {
+        return m_lazy_load && !m_all_tx_loaded;
+    }
+    /**
+     * Set how many more connections the initial load may open to read
+     * tables ahead of the objects being made from them, each on its own
+     * thread. 0, the default unless the GNC_SQL_LOAD_THREADS environment
+     * variable is set, reads every table when its turn comes. Transactions
+     * are only read ahead if page_size() is 0.
+     */
+    void set_load_threads(unsigned int threads) noexcept
+    {
+        m_load_threads = threads;
+    }
+    unsigned int load_threads() const noexcept { return m_load_threads; }
+    /**
+     * Set how many transactions a load reads at a time, with their splits and
+     * slots, so that no result set holds the rows of more. 0 reads them all
+     * at once. The default is the value of the GNC_SQL_PAGE_SIZE environment
+     * variable if it is set, else 0 if GNC_SQL_LOAD_THREADS is set, else
+     * 10000.
+     */
+    void set_page_size(unsigned int size) noexcept { m_page_size = size; }
+    unsigned int page_size() const noexcept { return m_page_size; }
+    /**
+     * Set how many milliseconds commit() may hold changed objects before
+     * writing them, all in one database transaction and in the order they
+     * were first committed. An object committed again meanwhile is written
+     * once. 0, the default unless the GNC_SQL_WRITE_BEHIND environment
+     * variable is set, writes each object as it is committed.
+     */
+    void set_write_behind(unsigned int msec) noexcept;
+    unsigned int write_behind() const noexcept { return m_write_behind; }
+    /**
+     * Write the objects that commit() is holding. Anything that reads the
+     * database or ends the session must call this first. Objects open for
+     * edit again are left held until that edit is committed, and so are
+     * all of them if they can't be written; the error is set here.
+     *
+     * @return false if they couldn't be written; they are still dirty.
+     */
+    bool flush_pending() noexcept;
+    /** Whether commit() is holding objects that aren't in the database. */
+    bool has_pending() const noexcept { return !m_pending.empty(); }
+    /** Whether all of the account's transactions have been loaded. */
+    bool account_tx_loaded(const Account* acc) const noexcept;
+    void set_account_tx_loaded(const Account* acc) noexcept;
     void update_progress() const noexcept;
     void finish_progress() const noexcept;
 
@@ -249,6 +332,31 @@ protected:
     const char* m_timespec_format; /**< Server-specific date-time string format */
     VersionVec m_versions;    /**< Version number for each table */
 private:
+    /** The rows of one table, with the same columns, waiting to be
+     * written by a single INSERT. */
+    struct InsertBatch
+    {
+        std::string table_name;
+        std::vector<std::string> columns;
+        std::string rows;
+        unsigned int count;
+    };
+    bool add_to_insert_batch (const char* table_name,
+                              const PairVec& values) const noexcept;
+    bool execute_insert_batch (const InsertBatch& batch) const noexcept;
+    bool flush_insert_batches () const noexcept;
+    /** An object that commit() is holding, and whether it must be
+     * inserted: the engine clears its infant flag once commit() returns. */
+    struct PendingCommit
+    {
+        QofInstance* inst;
+        bool infant;
+    };
+    void queue_commit(QofInstance* inst) noexcept;
+    void hold_commit(const PendingCommit& commit) noexcept;
+    bool commit_instance(QofInstance* inst);
+    void start_prefetch() noexcept;
+    void finish_prefetch() noexcept;
     bool write_account_tree(Account*);
     bool write_accounts();
     bool write_transactions();
@@ -287,6 +395,31 @@ private:
     };
     ObjectBackendRegistry m_backend_registry;
     std::vector<gnc_commodity*> m_postload_commodities;
+    /** sync() is writing into new tables, so INSERTs can be batched. */
+    bool m_batch_inserts;
+    unsigned int m_batch_size;
+    mutable std::vector<InsertBatch> m_insert_batches;
+    /** The commodities that sync() has written so far. */
+    std::unordered_set<gnc_commodity*> m_saved_commodities;
+    bool m_lazy_load;
+    bool m_all_tx_loaded;
+    /** The accounts whose transactions have all been loaded. */
+    std::unordered_set<const Account*> m_tx_loaded_accounts;
+    unsigned int m_load_threads;
+    unsigned int m_page_size;
+    /** The results of the SELECTs that the readers are running ahead of the
+     * load, by SQL, until execute_select_statement takes them. */
+    mutable std::unordered_map<std::string,
+                               std::future<GncSqlResultPtr>> m_prefetched;
+    std::vector<GncSqlConnection*> m_readers;
+    std::vector<std::thread> m_prefetch_threads;
+    unsigned int m_write_behind;
+    /** The objects commit() is holding, in the order they were first
+     * committed, and each one's place in it. */
+    std::vector<PendingCommit> m_pending;
+    std::unordered_map<QofInstance*, size_t> m_pending_index;
+    /** The timeout that will write them. */
+    guint m_flush_source;
 };
 
 #endif //__GNC_SQL_BACKEND_HPP__
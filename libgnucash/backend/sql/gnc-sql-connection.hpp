@@ -96,6 +96,13 @@ public:
     virtual void set_error(int error, unsigned int repeat,  bool retry) noexcept = 0;
     virtual bool verify() noexcept = 0;
     virtual bool retry_connection(const char* msg) noexcept = 0;
+    /** Open another connection to the same database on which another thread
+     * can run SELECTs while this one is in use. It neither takes nor releases
+     * the database lock, and its execute_select_statement returns nullptr if
+     * error. Returns nullptr if the connection can't be opened or the
+     * database doesn't support it; the caller owns the new connection.
+     */
+    virtual GncSqlConnection* open_reader () const noexcept { return nullptr; }
 
 };
 
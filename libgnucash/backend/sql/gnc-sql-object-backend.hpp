@@ -59,6 +59,17 @@ public:
      * @param sql_be The GncSqlBackend containing the database connection.
      */
     virtual void load_all (GncSqlBackend* sql_be) = 0;
+    /**
+     * The SELECTs that load_all() runs whose results don't depend on anything
+     * loaded before it, so that the backend may run them ahead of time on
+     * another connection. None by default.
+     * @param sql_be The GncSqlBackend containing the database connection.
+     * @return The SQL of each statement, exactly as load_all() builds it.
+     */
+    virtual std::vector<std::string> load_all_queries (GncSqlBackend* sql_be) const
+    {
+        return {};
+    }
     /**
      * Conditionally create or update a database table from m_col_table. The
      * condition is the version returned by querying the database's version
@@ -105,6 +116,8 @@ public:
     bool instance_in_db(const GncSqlBackend* sql_be,
                         QofInstance* inst) const noexcept;
 protected:
+    /** The SELECT for every row of m_table_name. */
+    std::string select_all_sql () const { return "SELECT * FROM " + m_table_name; }
     const std::string m_table_name;
     const int m_version;
     const std::string m_type_name; /// The front-end QofIdType
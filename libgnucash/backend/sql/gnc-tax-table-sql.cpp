@@ -288,10 +288,7 @@ GncSqlTaxTableBackend::load_all (GncSqlBackend* sql_be)
 {
     g_return_if_fail (sql_be != NULL);
 
-    /* First time, create the query */
-    std::stringstream sql;
-    sql << "SELECT * FROM " << TT_TABLE_NAME;
-    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    auto stmt = sql_be->create_statement_from_sql(select_all_sql());
     auto result = sql_be->execute_select_statement(stmt);
     TaxTblParentGuidVec tt_needing_parents;
 
@@ -332,6 +329,12 @@ GncSqlTaxTableBackend::load_all (GncSqlBackend* sql_be)
     }
 }
 
+std::vector<std::string>
+GncSqlTaxTableBackend::load_all_queries (GncSqlBackend* sql_be) const
+{
+    return {select_all_sql ()};
+}
+
 /* ================================================================= */
 void
 GncSqlTaxTableBackend::create_tables (GncSqlBackend* sql_be)
@@ -38,6 +38,7 @@ extern "C"
 
 #include "Account.h"
 #include "Transaction.h"
+#include "SX-book.h"
 #include <Scrub.h>
 #include "gnc-lot.h"
 #include "engine-helpers.h"
@@ -49,8 +50,12 @@ extern "C"
 #endif
 }
 
+#include <algorithm>
 #include <string>
 #include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 #include "escape.h"
 
@@ -64,7 +69,6 @@ extern "C"
 #include "gnc-slots-sql.h"
 
 #define SIMPLE_QUERY_COMPILATION 1
-#define LOAD_TRANSACTIONS_AS_NEEDED 0
 
 static QofLogModule log_module = G_LOG_DOMAIN;
 
@@ -249,17 +253,48 @@ load_single_split (GncSqlBackend* sql_be, GncSqlRow& row)
     return pSplit;
 }
 
+/* When every transaction is loaded, the rows that belong to them are picked
+ * out with subqueries rather than lists of their GUIDs, so that the SQL
+ * doesn't grow with the book and can be run before the load needs it. */
+static std::string
+all_tx_guids_sql ()
+{
+    return std::string{"SELECT guid FROM "} + TRANSACTION_TABLE;
+}
+
+static std::string
+all_split_guids_sql ()
+{
+    return std::string{"SELECT guid FROM "} + SPLIT_TABLE + " WHERE " +
+        tx_guid_col_table[0]->name() + " IN (" + all_tx_guids_sql () + ")";
+}
+
+static std::string
+all_splits_sql ()
+{
+    return std::string{"SELECT * FROM "} + SPLIT_TABLE + " WHERE " +
+        tx_guid_col_table[0]->name() + " IN (" + all_tx_guids_sql () + ")";
+}
+
 static void
-load_splits_for_tx_list (GncSqlBackend* sql_be, InstanceVec& transactions)
+load_splits_for_tx_list (GncSqlBackend* sql_be, InstanceVec& transactions,
+                         bool all_tx)
 {
     g_return_if_fail (sql_be != NULL);
 
     std::stringstream sql;
 
-    sql << "SELECT * FROM " << SPLIT_TABLE << " WHERE " <<
-        tx_guid_col_table[0]->name() << " IN (";
-    gnc_sql_append_guids_to_sql (sql, transactions);
-    sql << ")";
+    if (all_tx)
+    {
+        sql << all_splits_sql ();
+    }
+    else
+    {
+        sql << "SELECT * FROM " << SPLIT_TABLE << " WHERE " <<
+            tx_guid_col_table[0]->name() << " IN (";
+        gnc_sql_append_guids_to_sql (sql, transactions);
+        sql << ")";
+    }
 
     // Execute the query and load the splits
     auto stmt = sql_be->create_statement_from_sql(sql.str());
@@ -272,8 +307,14 @@ load_splits_for_tx_list (GncSqlBackend* sql_be, InstanceVec& transactions)
         if (s != nullptr)
             instances.push_back(QOF_INSTANCE(s));
     }
+    delete result;
 
-    if (!instances.empty())
+    if (instances.empty())
+        return;
+    if (all_tx)
+        gnc_sql_slots_load_for_instancevec (sql_be, instances,
+                                            all_split_guids_sql ());
+    else
         gnc_sql_slots_load_for_instancevec (sql_be, instances);
 }
 
@@ -314,140 +355,188 @@ load_single_tx (GncSqlBackend* sql_be, GncSqlRow& row)
 }
 
 /**
- * Structure to hold start/end balances for each account.  The values are
- * saved before splits are loaded, and then used to adjust the start balances
- * so that the end balances (which are calculated and correct on initial load)
- * are unchanged.
+ * In lazy mode the account start balances are the database totals, so take
+ * the splits of newly loaded transactions back out of them, leaving the end
+ * balances as they were.
+ *
+ * @param transactions The transactions just loaded
  */
-typedef struct
+static void
+adjust_start_balances (const InstanceVec& transactions)
+{
+    std::unordered_map<Account*, acct_balances_t> loaded;
+
+    for (auto inst : transactions)
+    {
+        for (auto node = xaccTransGetSplitList (GNC_TRANSACTION (inst));
+             node != nullptr; node = node->next)
+        {
+            auto split = GNC_SPLIT (node->data);
+            auto acc = xaccSplitGetAccount (split);
+            if (acc == nullptr)
+                continue;
+
+            auto amount = xaccSplitGetAmount (split);
+            auto state = xaccSplitGetReconcile (split);
+            auto& bal = loaded.emplace (acc, acct_balances_t {acc,
+                        gnc_numeric_zero (), gnc_numeric_zero (),
+                        gnc_numeric_zero ()}).first->second;
+
+            bal.balance = gnc_numeric_add (bal.balance, amount,
+                                           GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+            if (state != NREC)
+                bal.cleared_balance = gnc_numeric_add (bal.cleared_balance,
+                                                       amount, GNC_DENOM_AUTO,
+                                                       GNC_HOW_DENOM_LCD);
+            if (state == YREC || state == FREC)
+                bal.reconciled_balance =
+                    gnc_numeric_add (bal.reconciled_balance, amount,
+                                     GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+        }
+    }
+
+    for (auto& entry : loaded)
+    {
+        auto acc = entry.first;
+        auto& bal = entry.second;
+        gnc_numeric* start_bal;
+        gnc_numeric* start_c_bal;
+        gnc_numeric* start_r_bal;
+
+        g_object_get (acc,
+                      "start-balance", &start_bal,
+                      "start-cleared-balance", &start_c_bal,
+                      "start-reconciled-balance", &start_r_bal,
+                      NULL);
+        gnc_account_set_start_balance (acc,
+            gnc_numeric_sub (*start_bal, bal.balance,
+                             GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD));
+        gnc_account_set_start_cleared_balance (acc,
+            gnc_numeric_sub (*start_c_bal, bal.cleared_balance,
+                             GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD));
+        gnc_account_set_start_reconciled_balance (acc,
+            gnc_numeric_sub (*start_r_bal, bal.reconciled_balance,
+                             GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD));
+        g_free (start_bal);
+        g_free (start_c_bal);
+        g_free (start_r_bal);
+        xaccAccountRecomputeBalance (acc);
+    }
+}
+
+/* Make the transactions in the result's rows, leaving them open for edit,
+ * and note the GUID of the last row if asked to. */
+static void
+load_tx_rows (GncSqlBackend* sql_be, GncSqlResultPtr result,
+              InstanceVec& instances, std::string* last_guid = nullptr)
+{
+    for (auto row : *result)
+    {
+        if (last_guid != nullptr)
+            *last_guid = row.get_string_at_col (tx_col_table[0]->name());
+        auto tx = load_single_tx (sql_be, row);
+        if (tx != nullptr)
+        {
+            xaccTransScrubPostedDate (tx);
+            instances.push_back(QOF_INSTANCE(tx));
+        }
+    }
+}
+
+/* Load the slots and splits of transactions made by load_tx_rows and commit
+ * them. */
+static void
+finish_tx_load (GncSqlBackend* sql_be, InstanceVec& transactions, bool all_tx)
 {
-    Account* acc;
-    gnc_numeric start_bal;
-    gnc_numeric end_bal;
-    gnc_numeric start_cleared_bal;
-    gnc_numeric end_cleared_bal;
-    gnc_numeric start_reconciled_bal;
-    gnc_numeric end_reconciled_bal;
-} full_acct_balances_t;
+    if (all_tx)
+        gnc_sql_slots_load_for_instancevec (sql_be, transactions,
+                                            all_tx_guids_sql ());
+    else
+        gnc_sql_slots_load_for_instancevec (sql_be, transactions);
+    load_splits_for_tx_list (sql_be, transactions, all_tx);
+
+    for (auto instance : transactions)
+         xaccTransCommitEdit(GNC_TRANSACTION(instance));
+
+    if (sql_be->lazy_load())
+        adjust_start_balances (transactions);
+}
 
 /**
  * Executes a transaction query statement and loads the transactions and all
- * of the splits.
+ * of the splits. Unless the statement selects every transaction, the splits
+ * and slots are read for page_size() transactions at a time.
  *
  * @param sql_be SQL backend
  * @param stmt SQL statement
+ * @param all_tx The statement selects every transaction
  */
 static void
-query_transactions (GncSqlBackend* sql_be, const GncSqlStatementPtr& stmt)
+query_transactions (GncSqlBackend* sql_be, const GncSqlStatementPtr& stmt,
+                    bool all_tx = false)
 {
     g_return_if_fail (sql_be != NULL);
     g_return_if_fail (stmt != NULL);
 
     auto result = sql_be->execute_select_statement(stmt);
-    if (result->begin() == result->end())
+    InstanceVec instances;
+    load_tx_rows (sql_be, result, instances);
+    delete result;
+    if (instances.empty())
         return;
 
-    Transaction* tx;
-#if LOAD_TRANSACTIONS_AS_NEEDED
-    GSList* bal_list = NULL;
-    Account* root = gnc_book_get_root_account (sql_be->book());
-
-    qof_event_suspend ();
-    xaccAccountBeginEdit (root);
-
-    // Save the start/ending balances (balance, cleared and reconciled) for
-    // every account.
-    gnc_account_foreach_descendant (gnc_book_get_root_account (sql_be->primary_book),
-                                    save_account_balances,
-                                    &bal_list);
-#endif
-
-    // Load the transactions
-    InstanceVec instances;
-    for (auto row : *result)
+    if (all_tx)
     {
-        tx = load_single_tx (sql_be, row);
-        if (tx != nullptr)
-        {
-            xaccTransScrubPostedDate (tx);
-            instances.push_back(QOF_INSTANCE(tx));
-        }
+        finish_tx_load (sql_be, instances, true);
+        return;
     }
 
-    // Load all splits and slots for the transactions
-    if (!instances.empty())
+    auto page_size = sql_be->page_size() ? sql_be->page_size() :
+        instances.size();
+    for (size_t start = 0; start < instances.size(); start += page_size)
     {
-        gnc_sql_slots_load_for_instancevec (sql_be, instances);
-        load_splits_for_tx_list (sql_be, instances);
+        auto end = std::min<size_t> (start + page_size, instances.size());
+        InstanceVec page (instances.begin() + start, instances.begin() + end);
+        finish_tx_load (sql_be, page, false);
     }
+}
 
-    // Commit all of the transactions
-    for (auto instance : instances)
-         xaccTransCommitEdit(GNC_TRANSACTION(instance));
-
-#if LOAD_TRANSACTIONS_AS_NEEDED
-    // Update the account balances based on the loaded splits.  If the end
-    // balance has changed, update the start balance so that the end
-    // balance is the same as it was before the splits were loaded.
-    // Repeat for cleared and reconciled balances.
-    for (auto nextbal = bal_list; nextbal != NULL; nextbal = nextbal->next)
-    {
-        full_acct_balances_t* balns = (full_acct_balances_t*)nextbal->data;
-        gnc_numeric* pnew_end_bal;
-        gnc_numeric* pnew_end_c_bal;
-        gnc_numeric* pnew_end_r_bal;
-        gnc_numeric adj;
-
-        g_object_get (balns->acc,
-                      "end-balance", &pnew_end_bal,
-                      "end-cleared-balance", &pnew_end_c_bal,
-                      "end-reconciled-balance", &pnew_end_r_bal,
-                      NULL);
+/**
+ * Loads every transaction page_size() at a time, in GUID order. Each page
+ * starts after the last GUID of the one before, so the database doesn't
+ * have to skip the rows already read, and its result, splits and slots are
+ * freed before the next is read.
+ *
+ * @param sql_be SQL backend
+ */
+static void
+load_all_tx_paged (GncSqlBackend* sql_be)
+{
+    auto guid_col = tx_col_table[0]->name();
+    auto page_size = sql_be->page_size();
+    std::string last_guid;
 
-        qof_instance_increase_editlevel (balns - acc);
-        if (!gnc_numeric_eq (*pnew_end_bal, balns->end_bal))
-        {
-            adj = gnc_numeric_sub (balns->end_bal, *pnew_end_bal,
-                                   GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-            balns->start_bal = gnc_numeric_add (balns->start_bal, adj,
-                                                GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-            g_object_set (balns->acc, "start-balance", &balns->start_bal, NULL);
-            qof_instance_decrease_editlevel (balns - acc);
-        }
-        if (!gnc_numeric_eq (*pnew_end_c_bal, balns->end_cleared_bal))
-        {
-            adj = gnc_numeric_sub (balns->end_cleared_bal, *pnew_end_c_bal,
-                                   GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-            balns->start_cleared_bal = gnc_numeric_add (balns->start_cleared_bal, adj,
-                                                        GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-            g_object_set (balns->acc, "start-cleared-balance", &balns->start_cleared_bal,
-                          NULL);
-        }
-        if (!gnc_numeric_eq (*pnew_end_r_bal, balns->end_reconciled_bal))
-        {
-            adj = gnc_numeric_sub (balns->end_reconciled_bal, *pnew_end_r_bal,
-                                   GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-            balns->start_reconciled_bal = gnc_numeric_add (balns->start_reconciled_bal,
-                                                           adj,
-                                                           GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-            g_object_set (balns->acc, "start-reconciled-balance",
-                          &balns->start_reconciled_bal, NULL);
-        }
-        qof_instance_decrease_editlevel (balns - acc);
-        xaccAccountRecomputeBalance (balns->acc);
-        g_free (pnew_end_bal);
-        g_free (pnew_end_c_bal);
-        g_free (pnew_end_r_bal);
-        g_free (balns);
-    }
-    if (bal_list != NULL)
+    while (true)
     {
-        g_slist_free (bal_list);
+        std::stringstream sql;
+        sql << "SELECT * FROM " << TRANSACTION_TABLE;
+        if (!last_guid.empty())
+            sql << " WHERE " << guid_col << " > '" << last_guid << "'";
+        sql << " ORDER BY " << guid_col << " LIMIT " << page_size;
+        auto stmt = sql_be->create_statement_from_sql(sql.str());
+        if (stmt == nullptr)
+            return;
+
+        auto result = sql_be->execute_select_statement(stmt);
+        auto rows = result->size();
+        InstanceVec instances;
+        load_tx_rows (sql_be, result, instances, &last_guid);
+        delete result;
+        if (!instances.empty())
+            finish_tx_load (sql_be, instances, false);
+        if (rows < page_size)
+            break;
     }
-
-    xaccAccountCommitEdit (root);
-    qof_event_resume ();
-#endif
 }
 
 /* ================================================================= */
@@ -757,6 +846,42 @@ void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
     if (stmt != nullptr)
     {
         query_transactions (sql_be, stmt);
+        sql_be->set_account_tx_loaded (account);
+    }
+}
+
+/**
+ * Loads the transactions of the scheduled transaction templates, which
+ * nothing queries for, ahead of the rest in lazy mode.
+ *
+ * @param sql_be SQL backend
+ */
+static void
+load_template_transactions (GncSqlBackend* sql_be)
+{
+    auto root = gnc_book_get_template_root (sql_be->book());
+    if (root == nullptr)
+        return;
+
+    InstanceVec accounts;
+    auto descendants = gnc_account_get_descendants (root);
+    for (auto node = descendants; node != nullptr; node = node->next)
+        accounts.push_back (QOF_INSTANCE (node->data));
+    g_list_free (descendants);
+    if (accounts.empty())
+        return;
+
+    std::stringstream sql;
+    sql << "SELECT DISTINCT t.* FROM " << TRANSACTION_TABLE << " AS t, " <<
+        SPLIT_TABLE << " AS s WHERE s.tx_guid=t.guid AND s.account_guid IN (";
+    gnc_sql_append_guids_to_sql (sql, accounts);
+    sql << ")";
+    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    if (stmt != nullptr)
+    {
+        query_transactions (sql_be, stmt);
+        for (auto inst : accounts)
+            sql_be->set_account_tx_loaded (GNC_ACCOUNT (inst));
     }
 }
 
@@ -764,6 +889,9 @@ void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
  * Loads all transactions.  This might be used during a save-as operation to ensure that
  * all data is in memory and ready to be saved.
  *
+ * In lazy mode the initial load only brings in the template transactions;
+ * the rest wait for gnc_sql_transaction_load_for_query.
+ *
  * @param sql_be SQL backend
  */
 void
@@ -771,15 +899,40 @@ GncSqlTransBackend::load_all (GncSqlBackend* sql_be)
 {
     g_return_if_fail (sql_be != NULL);
 
-    auto query_sql = g_strdup_printf ("SELECT * FROM %s", TRANSACTION_TABLE);
-    auto stmt = sql_be->create_statement_from_sql(query_sql);
-    g_free (query_sql);
+    if (sql_be->transactions_deferred())
+    {
+        load_template_transactions (sql_be);
+        return;
+    }
+
+    if (sql_be->page_size() > 0)
+    {
+        load_all_tx_paged (sql_be);
+        return;
+    }
+
+    /* Every row belongs to a new transaction only if none are loaded yet. */
+    auto coll = qof_book_get_collection (sql_be->book(), GNC_ID_TRANS);
+    auto stmt = sql_be->create_statement_from_sql(select_all_sql());
     if (stmt != nullptr)
     {
-        query_transactions (sql_be, stmt);
+        query_transactions (sql_be, stmt, qof_collection_count (coll) == 0);
     }
 }
 
+std::vector<std::string>
+GncSqlTransBackend::load_all_queries (GncSqlBackend* sql_be) const
+{
+    /* Only the template transactions are loaded up front, or the pages'
+     * SELECTs depend on the rows before them. */
+    if (sql_be->transactions_deferred() || sql_be->page_size() > 0)
+        return {};
+    return {select_all_sql (),
+            gnc_sql_slots_subquery_sql (all_tx_guids_sql ()),
+            all_splits_sql (),
+            gnc_sql_slots_subquery_sql (all_split_guids_sql ())};
+}
+
 static void
 convert_query_comparison_to_sql (QofQueryPredData* pPredData,
                                  gboolean isInverted, std::stringstream& sql)
@@ -1132,165 +1285,315 @@ run_split_query (GncSqlBackend* sql_be, gpointer pQuery)
     }
 }
 
-G_GNUC_UNUSED static void
-free_split_query (GncSqlBackend* sql_be, gpointer pQuery)
+/* Whether a query term's parameter path ends at a split's account GUID. */
+static bool
+is_account_guid_path (GSList* path)
 {
-    g_return_if_fail (sql_be != NULL);
-    g_return_if_fail (pQuery != NULL);
-
-    g_free (pQuery);
+    auto len = g_slist_length (path);
+    if (len == 0)
+        return false;
+    auto last = static_cast<const char*>(g_slist_nth_data (path, len - 1));
+    if (g_strcmp0 (last, SPLIT_ACCOUNT_GUID) == 0)
+        return true;
+    return len >= 2 && g_strcmp0 (last, QOF_PARAM_GUID) == 0 &&
+        g_strcmp0 (static_cast<const char*>(g_slist_nth_data (path, len - 2)),
+                   SPLIT_ACCOUNT) == 0;
 }
 
-/* ----------------------------------------------------------------- */
-typedef struct
+/* Whether a query term's parameter path ends at the date posted. */
+static bool
+is_date_posted_path (GSList* path)
 {
-    const GncSqlBackend* sql_be;
-    Account* acct;
-    char reconcile_state;
-    gnc_numeric balance;
-} single_acct_balance_t;
+    auto last = g_slist_last (path);
+    return last != nullptr &&
+        g_strcmp0 (static_cast<const char*>(last->data), TRANS_DATE_POSTED) == 0;
+}
 
 static void
-set_acct_bal_account_from_guid (gpointer pObject, gpointer pValue)
+load_tx_for_date_range (GncSqlBackend* sql_be, time64 from, time64 to)
 {
-    single_acct_balance_t* bal = (single_acct_balance_t*)pObject;
-    const GncGUID* guid = (const GncGUID*)pValue;
-
-    g_return_if_fail (pObject != NULL);
-    g_return_if_fail (pValue != NULL);
-
-    bal->acct = xaccAccountLookup (guid, bal->sql_be->book());
+    std::stringstream sql;
+    sql << "SELECT * FROM " << TRANSACTION_TABLE << " AS t WHERE ";
+    if (from != G_MININT64)
+        sql << "t.post_date >= " <<
+            GncDateTime (from).format_zulu ("'%Y-%m-%d %H:%M:%S'");
+    if (from != G_MININT64 && to != G_MAXINT64)
+        sql << " AND ";
+    if (to != G_MAXINT64)
+        sql << "t.post_date <= " <<
+            GncDateTime (to).format_zulu ("'%Y-%m-%d %H:%M:%S'");
+    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    if (stmt != nullptr)
+        query_transactions (sql_be, stmt);
 }
 
-static void
-set_acct_bal_reconcile_state (gpointer pObject, gpointer pValue)
+bool
+gnc_sql_transaction_load_for_query (GncSqlBackend* sql_be, QofQuery* query)
 {
-    single_acct_balance_t* bal = (single_acct_balance_t*)pObject;
-    const gchar* s = (const gchar*)pValue;
+    g_return_val_if_fail (sql_be != NULL, false);
+    g_return_val_if_fail (query != NULL, false);
+
+    auto search_for = qof_query_get_search_for (query);
+    if (g_strcmp0 (search_for, GNC_ID_SPLIT) != 0 &&
+        g_strcmp0 (search_for, GNC_ID_TRANS) != 0)
+        return true;
+    if (!qof_query_has_terms (query))
+        return false;
+
+    /* Work out, for each OR-term, the accounts or the date window its
+     * matches must lie in.  Other terms only narrow it further, so the
+     * transactions loaded are a superset of what the query can find. */
+    std::vector<Account*> accounts;
+    std::vector<std::pair<time64, time64>> windows;
+    for (auto orterm = qof_query_get_terms (query); orterm != nullptr;
+         orterm = orterm->next)
+    {
+        bool by_account = false;
+        std::vector<Account*> term_accounts;
+        time64 from = G_MININT64, to = G_MAXINT64;
 
-    g_return_if_fail (pObject != NULL);
-    g_return_if_fail (pValue != NULL);
+        for (auto andterm = static_cast<GList*>(orterm->data);
+             andterm != nullptr; andterm = andterm->next)
+        {
+            auto term = static_cast<QofQueryTerm*>(andterm->data);
+            auto path = qof_query_term_get_param_path (term);
+            auto pred_data = qof_query_term_get_pred_data (term);
 
-    bal->reconcile_state = s[0];
-}
+            if (qof_query_term_is_inverted (term))
+                continue;
 
-static void
-set_acct_bal_balance (gpointer pObject, gnc_numeric value)
-{
-    single_acct_balance_t* bal = (single_acct_balance_t*)pObject;
+            if (is_account_guid_path (path) &&
+                g_strcmp0 (pred_data->type_name, QOF_TYPE_GUID) == 0)
+            {
+                auto guid_data = (query_guid_t)pred_data;
+                if (guid_data->options != QOF_GUID_MATCH_ANY &&
+                    guid_data->options != QOF_GUID_MATCH_ALL)
+                    continue;
+                /* Matching several account terms means matching all of
+                 * them, so any one of them bounds the OR-term. */
+                if (by_account)
+                    continue;
+                by_account = true;
+                for (auto node = guid_data->guids; node != nullptr;
+                     node = node->next)
+                {
+                    auto acc = xaccAccountLookup (
+                        static_cast<GncGUID*>(node->data), sql_be->book());
+                    if (acc != nullptr)
+                        term_accounts.push_back (acc);
+                }
+            }
+            else if (is_date_posted_path (path) &&
+                     g_strcmp0 (pred_data->type_name, QOF_TYPE_DATE) == 0)
+            {
+                auto date_data = (query_date_t)pred_data;
+                auto date = date_data->date.tv_sec;
+                switch (pred_data->how)
+                {
+                case QOF_COMPARE_LT:
+                case QOF_COMPARE_LTE:
+                    to = std::min (to, date);
+                    break;
+                case QOF_COMPARE_GT:
+                case QOF_COMPARE_GTE:
+                    from = std::max (from, date);
+                    break;
+                case QOF_COMPARE_EQUAL:
+                    from = std::max (from, date);
+                    to = std::min (to, date);
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
 
-    g_return_if_fail (pObject != NULL);
+        if (by_account)
+            accounts.insert (accounts.end(), term_accounts.begin(),
+                             term_accounts.end());
+        else if (from != G_MININT64 || to != G_MAXINT64)
+            windows.emplace_back (from, to);
+        else
+            return false;
+    }
 
-    bal->balance = value;
+    for (auto acc : accounts)
+        if (!sql_be->account_tx_loaded (acc))
+            gnc_sql_transaction_load_tx_for_account (sql_be, acc);
+    for (auto& window : windows)
+        if (window.first <= window.second)
+            load_tx_for_date_range (sql_be, window.first, window.second);
+    return true;
 }
 
-static const EntryVec acct_balances_col_table
-{
-    gnc_sql_make_table_entry<CT_GUID>("account_guid", 0, 0, nullptr,
-                                (QofSetterFunc)set_acct_bal_account_from_guid),
-    gnc_sql_make_table_entry<CT_STRING>("reconcile_state", 1, 0, nullptr,
-                                (QofSetterFunc)set_acct_bal_reconcile_state),
-    gnc_sql_make_table_entry<CT_NUMERIC>("quantity", 0, 0, nullptr,
-                                         (QofSetterFunc)set_acct_bal_balance),
-};
-
-G_GNUC_UNUSED static  single_acct_balance_t*
-load_single_acct_balances (const GncSqlBackend* sql_be, GncSqlRow& row)
+G_GNUC_UNUSED static void
+free_split_query (GncSqlBackend* sql_be, gpointer pQuery)
 {
-    single_acct_balance_t* bal = NULL;
-
-    g_return_val_if_fail (sql_be != NULL, NULL);
+    g_return_if_fail (sql_be != NULL);
+    g_return_if_fail (pQuery != NULL);
 
-    bal = static_cast<decltype (bal)> (g_malloc (sizeof (single_acct_balance_t)));
-    g_assert (bal != NULL);
+    g_free (pQuery);
+}
 
-    bal->sql_be = sql_be;
-    gnc_sql_load_object (sql_be, row, NULL, bal, acct_balances_col_table);
+/* ----------------------------------------------------------------- */
+/* SUM() of an integer column is an integer in SQLite, but MySQL and
+ * PostgreSQL widen it to a decimal type. */
+static int64_t
+get_sum_at_col (const GncSqlRow& row, const char* col)
+{
+    try
+    {
+        return row.get_int_at_col (col);
+    }
+    catch (std::invalid_argument&)
+    {
+    }
+    try
+    {
+        return static_cast<int64_t>(row.get_double_at_col (col));
+    }
+    catch (std::invalid_argument&)
+    {
+    }
+    return g_ascii_strtoll (row.get_string_at_col (col).c_str(), nullptr, 10);
+}
 
-    return bal;
+/* The quantity_num sum and quantity_denom of an aggregate row. */
+static gnc_numeric
+get_quantity_sum (const GncSqlRow& row)
+{
+    return gnc_numeric_create (get_sum_at_col (row, "quantity_num"),
+                               row.get_int_at_col ("quantity_denom"));
 }
 
 GSList*
 gnc_sql_get_account_balances_slist (GncSqlBackend* sql_be)
 {
-#if LOAD_TRANSACTIONS_AS_NEEDED
-    gchar* buf;
     GSList* bal_slist = NULL;
 
     g_return_val_if_fail (sql_be != NULL, NULL);
 
-    buf = g_strdup_printf ("SELECT account_guid, reconcile_state, sum(quantity_num) as quantity_num, quantity_denom FROM %s GROUP BY account_guid, reconcile_state, quantity_denom ORDER BY account_guid, reconcile_state",
-                           SPLIT_TABLE);
-    auto stmt = sql_be->create_statement_from_sql(buf);
-    g_assert (stmt != nullptr);
-    g_free (buf);
+    std::stringstream sql;
+    sql << "SELECT account_guid, reconcile_state, sum(quantity_num) AS quantity_num, quantity_denom FROM " <<
+        SPLIT_TABLE << " GROUP BY account_guid, reconcile_state, quantity_denom ORDER BY account_guid, reconcile_state";
+    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    if (stmt == nullptr)
+        return NULL;
     auto result = sql_be->execute_select_statement(stmt);
+    if (result == nullptr)
+        return NULL;
     acct_balances_t* bal = NULL;
 
-    for (auto row : *result)
+    try
     {
-        single_acct_balance_t* single_bal;
-
-        // Get the next reconcile state balance and merge with other balances
-        single_bal = load_single_acct_balances (sql_be, row);
-        if (single_bal != NULL)
+        for (auto row : *result)
         {
-            if (bal != NULL && bal->acct != single_bal->acct)
+            GncGUID guid;
+            if (!string_to_guid (row.get_string_at_col ("account_guid").c_str(),
+                                 &guid))
+                continue;
+            auto acct = xaccAccountLookup (&guid, sql_be->book());
+            if (acct == NULL)
+                continue;
+            auto state = row.get_string_at_col ("reconcile_state");
+            auto reconcile_state = state.empty() ? NREC : state[0];
+            auto amount = get_quantity_sum (row);
+
+            // Rows come grouped by account; start a new total for each one.
+            if (bal != NULL && bal->acct != acct)
             {
-                bal->cleared_balance = gnc_numeric_add (bal->cleared_balance,
-                                                        bal->reconciled_balance,
-                                                        GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-                bal->balance = gnc_numeric_add (bal->balance, bal->cleared_balance,
-                                                GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-                bal_slist = g_slist_append (bal_slist, bal);
+                bal_slist = g_slist_prepend (bal_slist, bal);
                 bal = NULL;
             }
             if (bal == NULL)
             {
-                bal = g_malloc ((gsize)sizeof (acct_balances_t));
-                g_assert (bal != NULL);
-
-                bal->acct = single_bal->acct;
+                bal = static_cast<decltype (bal)> (
+                          g_malloc (sizeof (acct_balances_t)));
+                bal->acct = acct;
                 bal->balance = gnc_numeric_zero ();
                 bal->cleared_balance = gnc_numeric_zero ();
                 bal->reconciled_balance = gnc_numeric_zero ();
             }
-            if (single_bal->reconcile_state == 'n')
-            {
-                bal->balance = gnc_numeric_add (bal->balance, single_bal->balance,
-                                                GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-            }
-            else if (single_bal->reconcile_state == 'c')
-            {
+            // The same rules as xaccAccountRecomputeBalance
+            bal->balance = gnc_numeric_add (bal->balance, amount,
+                                            GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+            if (reconcile_state != NREC)
                 bal->cleared_balance = gnc_numeric_add (bal->cleared_balance,
-                                                        single_bal->balance,
-                                                        GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-            }
-            else if (single_bal->reconcile_state == 'y')
-            {
-                bal->reconciled_balance = gnc_numeric_add (bal->reconciled_balance,
-                                                           single_bal->balance,
-                                                           GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-            }
-            g_free (single_bal);
+                                                        amount, GNC_DENOM_AUTO,
+                                                        GNC_HOW_DENOM_LCD);
+            if (reconcile_state == YREC || reconcile_state == FREC)
+                bal->reconciled_balance =
+                    gnc_numeric_add (bal->reconciled_balance, amount,
+                                     GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
         }
     }
+    catch (std::invalid_argument& err)
+    {
+        PERR ("Unable to read the account balances: %s", err.what());
+        qof_backend_set_error ((QofBackend*)sql_be, ERR_BACKEND_DATA_CORRUPT);
+    }
+    delete result;
 
     // Add the final balance
     if (bal != NULL)
+        bal_slist = g_slist_prepend (bal_slist, bal);
+
+    return g_slist_reverse (bal_slist);
+}
+
+bool
+gnc_sql_get_account_period_sums (GncSqlBackend* sql_be, const Account* acct,
+                                 const std::vector<time64>& bounds,
+                                 std::vector<gnc_numeric>& sums)
+{
+    g_return_val_if_fail (sql_be != NULL, false);
+    g_return_val_if_fail (acct != NULL, false);
+    g_return_val_if_fail (!bounds.empty(), false);
+
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    (void)guid_to_string_buff (qof_instance_get_guid (acct), guid_buf);
+
+    /* Number each split's period in the database so that one GROUP BY
+     * gives all of the sums. */
+    std::stringstream sql;
+    sql << "SELECT CASE";
+    for (size_t period = 0; period < bounds.size(); period++)
+        sql << " WHEN t.post_date < " <<
+            GncDateTime (bounds[period]).format_zulu ("'%Y-%m-%d %H:%M:%S'") <<
+            " THEN " << period;
+    sql << " END AS period, sum(s.quantity_num) AS quantity_num, s.quantity_denom AS quantity_denom FROM " <<
+        SPLIT_TABLE << " AS s, " << TRANSACTION_TABLE <<
+        " AS t WHERE s.tx_guid=t.guid AND s.account_guid='" << guid_buf <<
+        "' AND t.post_date < " <<
+        GncDateTime (bounds.back()).format_zulu ("'%Y-%m-%d %H:%M:%S'") <<
+        " GROUP BY period, s.quantity_denom";
+    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    if (stmt == nullptr)
+        return false;
+    auto result = sql_be->execute_select_statement(stmt);
+    if (result == nullptr)
+        return false;
+
+    sums.assign (bounds.size(), gnc_numeric_zero ());
+    auto is_ok = true;
+    try
     {
-        bal->cleared_balance = gnc_numeric_add (bal->cleared_balance,
-                                                bal->reconciled_balance,
-                                                GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-        bal->balance = gnc_numeric_add (bal->balance, bal->cleared_balance,
-                                        GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
-        bal_slist = g_slist_append (bal_slist, bal);
+        for (auto row : *result)
+        {
+            auto period = get_sum_at_col (row, "period");
+            if (period < 0 || static_cast<size_t>(period) >= sums.size())
+                continue;
+            sums[period] = gnc_numeric_add (sums[period], get_quantity_sum (row),
+                                            GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+        }
     }
-
-    return bal_slist;
-#else
-    return NULL;
-#endif
+    catch (std::invalid_argument& err)
+    {
+        PERR ("Unable to read the split sums: %s", err.what());
+        is_ok = false;
+    }
+    delete result;
+    return is_ok;
 }
 
 /* ----------------------------------------------------------------- */
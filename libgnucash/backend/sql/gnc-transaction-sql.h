@@ -35,11 +35,14 @@ extern "C"
 #include "qof.h"
 #include "Account.h"
 }
+#include <vector>
+
 class GncSqlTransBackend : public GncSqlObjectBackend
 {
 public:
     GncSqlTransBackend();
     void load_all(GncSqlBackend*) override;
+    std::vector<std::string> load_all_queries(GncSqlBackend*) const override;
     void create_tables(GncSqlBackend*) override;
     bool commit (GncSqlBackend* sql_be, QofInstance* inst) override;
 };
@@ -61,6 +64,18 @@ public:
  */
 void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
                                               Account* account);
+/**
+ * Loads the transactions that a split or transaction query might match:
+ * those of the accounts it names or, failing that, those in the date
+ * posted range it asks for.
+ *
+ * @param sql_be SQL backend
+ * @param query Query about to be run
+ * @return false if the query could match any transaction, in which case
+ * nothing has been loaded.
+ */
+bool gnc_sql_transaction_load_for_query (GncSqlBackend* sql_be,
+                                         QofQuery* query);
 typedef struct
 {
     Account* acct;
@@ -71,11 +86,27 @@ typedef struct
 
 /**
  * Returns a list of acct_balances_t structures, one for each account which
- * has splits.
+ * has splits. The caller frees the list and its elements.
  *
  * @param sql_be SQL backend
  * @return GSList of acct_balances_t structures
  */
 GSList* gnc_sql_get_account_balances_slist (GncSqlBackend* sql_be);
 
+/**
+ * Sums an account's split amounts in the database by date posted: sums[0]
+ * gets the total of the splits posted before bounds[0] and sums[i] that of
+ * the splits posted from bounds[i - 1] up to bounds[i].
+ *
+ * @param sql_be SQL backend
+ * @param acct Account
+ * @param bounds Period boundaries, in ascending order
+ * @param sums Filled with one sum for each boundary
+ * @return false if the sums couldn't be read
+ */
+bool gnc_sql_get_account_period_sums (GncSqlBackend* sql_be,
+                                      const Account* acct,
+                                      const std::vector<time64>& bounds,
+                                      std::vector<gnc_numeric>& sums);
+
 #endif /* GNC_TRANSACTION_SQL_H */
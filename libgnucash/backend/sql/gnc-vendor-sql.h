@@ -37,6 +37,7 @@ class GncSqlVendorBackend : public GncSqlObjectBackend
 public:
     GncSqlVendorBackend();
     void load_all(GncSqlBackend*) override;
+    std::vector<std::string> load_all_queries(GncSqlBackend*) const override;
     bool commit(GncSqlBackend*, QofInstance*) override;
     bool write(GncSqlBackend*) override;
 };
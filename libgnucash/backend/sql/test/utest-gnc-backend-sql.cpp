@@ -31,6 +31,8 @@ extern "C"
 #include "../gnc-sql-connection.hpp"
 #include "../gnc-sql-backend.hpp"
 #include "../gnc-sql-result.hpp"
+#include "../gnc-slots-sql.h"
+#include <kvp-frame.hpp>
 
 static const gchar* suitename = "/backend/sql/gnc-backend-sql";
 void test_suite_gnc_backend_sql (void);
@@ -125,6 +127,82 @@ private:
     GncMockSqlResult m_result;
 };
 
+class GncMockSqlTextStatement : public GncSqlStatement
+{
+public:
+    GncMockSqlTextStatement(const std::string& sql) : m_sql{sql} {}
+    const char* to_sql() const { return m_sql.c_str(); }
+    void add_where_cond (QofIdTypeConst, const PairVec&) {}
+private:
+    std::string m_sql;
+};
+
+/* A result of at most one row, every column of which reads as m_guid. */
+class GncMockSqlGuidResult : public GncSqlResult
+{
+public:
+    GncMockSqlGuidResult(const std::string& guid, bool has_row) :
+        m_guid{guid}, m_iter{this}, m_row{has_row ? &m_iter : nullptr},
+        m_end{nullptr} {}
+    uint64_t size() const noexcept { return m_row == m_end ? 0 : 1; }
+    GncSqlRow& begin() { return m_row; }
+    GncSqlRow& end() { return m_end; }
+protected:
+    class IteratorImpl : public GncSqlResult::IteratorImpl
+        {
+        public:
+            ~IteratorImpl() = default;
+            IteratorImpl(GncMockSqlGuidResult* inst) : m_inst{inst} {}
+            virtual GncSqlRow& operator++() { return m_inst->m_end; }
+            virtual GncSqlResult* operator*() { return m_inst; }
+            virtual int64_t get_int_at_col (const char* col) const
+            { return 1LL; }
+            virtual float get_float_at_col (const char* col) const
+            { return 1.0; }
+            virtual double get_double_at_col (const char* col) const
+            { return 1.0; }
+            virtual std::string get_string_at_col (const char* col)const
+            { return m_inst->m_guid; }
+            virtual time64 get_time64_at_col (const char* col) const
+            { return 1466270857LL; }
+            virtual bool is_col_null(const char* col) const noexcept
+            { return false; }
+        private:
+            GncMockSqlGuidResult* m_inst;
+        };
+private:
+    std::string m_guid;
+    IteratorImpl m_iter;
+    GncSqlRow m_row;
+    GncSqlRow m_end;
+};
+
+/* Counts the statements it's asked to run. A SELECT naming one of the
+ * slots in m_frames finds a saved frame row for it. */
+class GncCountingSqlConnection : public GncMockSqlConnection
+{
+public:
+    GncSqlResultPtr execute_select_statement (const GncSqlStatementPtr& stmt)
+        noexcept override
+    {
+        std::string sql{stmt->to_sql()};
+        bool found = false;
+        for (auto& name : m_frames)
+            if (sql.find ("name=" + name + " ") != std::string::npos)
+                found = true;
+        ++m_statements;
+        return new GncMockSqlGuidResult (m_frame_guid, found);
+    }
+    int execute_nonselect_statement (const GncSqlStatementPtr&)
+        noexcept override { ++m_statements; return 1; }
+    GncSqlStatementPtr create_statement_from_sql (const std::string& sql)
+        const noexcept override {
+        return GncSqlStatementPtr(new GncMockSqlTextStatement(sql)); }
+    std::vector<std::string> m_frames;
+    std::string m_frame_guid{"0123456789abcdef0123456789abcdef"};
+    int m_statements = 0;
+};
+
 /* gnc_sql_init
 void
 gnc_sql_init (GncSqlBackend* sql_be)// C: 1 */
@@ -336,6 +414,77 @@ test_gnc_sql_commit_edit (void)
     g_object_unref (book);
     delete sql_be;
 }
+/* gnc_sql_slots_save
+gboolean
+gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infant,
+                    QofInstance* inst)// C: 20 in 12 */
+static void
+test_gnc_sql_slots_save (void)
+{
+    const int tokens = 100;
+    GncCountingSqlConnection conn;
+    auto book = qof_book_new();
+    auto sql_be = new GncMockSqlBackend (&conn, book);
+    auto inst = static_cast<QofInstance*>(g_object_new (QOF_TYPE_INSTANCE, NULL));
+    qof_instance_init_data (inst, QOF_ID_NULL, book);
+    auto guid = qof_instance_get_guid (inst);
+    auto frame = qof_instance_get_slots (inst);
+
+    delete frame->set ({"notes"}, new KvpValue {g_strdup ("a note")});
+    for (int i = 0; i < tokens; ++i)
+    {
+        auto token = "token " + std::to_string (i);
+        delete frame->set_path ({"import-map-bayes", token, "count"},
+                                new KvpValue {INT64_C(1)});
+    }
+    conn.m_frames = {"import-map-bayes", "token 5"};
+
+    /* A new object writes every slot: the bayes frame, a frame and a
+     * count per token, and the notes. */
+    g_assert (gnc_sql_slots_save (sql_be, guid, TRUE, inst));
+    g_assert_cmpint (conn.m_statements, ==, 1 + 2 * tokens + 1);
+
+    conn.m_statements = 0;
+    g_assert (gnc_sql_slots_save (sql_be, guid, FALSE, inst));
+    g_assert_cmpint (conn.m_statements, ==, 0);
+
+    /* Replacing a slot looks for frames saved under it, deletes it and
+     * inserts it again. */
+    conn.m_statements = 0;
+    delete frame->set ({"notes"}, new KvpValue {g_strdup ("another note")});
+    g_assert (gnc_sql_slots_save (sql_be, guid, FALSE, inst));
+    g_assert_cmpint (conn.m_statements, ==, 3);
+
+    /* Changing one count finds the two saved frames above it and
+     * replaces only the count. */
+    conn.m_statements = 0;
+    delete frame->set_path ({"import-map-bayes", "token 5", "count"},
+                            new KvpValue {INT64_C(2)});
+    g_assert (gnc_sql_slots_save (sql_be, guid, FALSE, inst));
+    g_assert_cmpint (conn.m_statements, ==, 2 + 3);
+
+    /* A new token is written as a whole below the saved bayes frame. */
+    conn.m_statements = 0;
+    delete frame->set_path ({"import-map-bayes", "new token", "count"},
+                            new KvpValue {INT64_C(1)});
+    g_assert (gnc_sql_slots_save (sql_be, guid, FALSE, inst));
+    g_assert_cmpint (conn.m_statements, ==, 1 + 4);
+
+    conn.m_statements = 0;
+    delete frame->set ({"notes"}, nullptr);
+    g_assert (gnc_sql_slots_save (sql_be, guid, FALSE, inst));
+    g_assert_cmpint (conn.m_statements, ==, 2);
+
+    /* A frame that doesn't know what changed is saved from scratch. */
+    conn.m_statements = 0;
+    frame->mark_all_changed ();
+    g_assert (gnc_sql_slots_save (sql_be, guid, FALSE, inst));
+    g_assert_cmpint (conn.m_statements, >, 2 * tokens);
+
+    g_object_unref (inst);
+    g_object_unref (book);
+    delete sql_be;
+}
 /* handle_and_term
 static void
 handle_and_term (QofQueryTerm* pTerm, GString* sql)// 2
@@ -880,6 +1029,7 @@ test_suite_gnc_backend_sql (void)
 // GNC_TEST_ADD (suitename, "gnc sql rollback edit", Fixture, nullptr, test_gnc_sql_rollback_edit,  teardown);
 // GNC_TEST_ADD (suitename, "commit cb", Fixture, nullptr, test_commit_cb,  teardown);
     GNC_TEST_ADD_FUNC (suitename, "gnc sql commit edit", test_gnc_sql_commit_edit);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql slots save", test_gnc_sql_slots_save);
 // GNC_TEST_ADD (suitename, "handle and term", Fixture, nullptr, test_handle_and_term,  teardown);
 // GNC_TEST_ADD (suitename, "compile query cb", Fixture, nullptr, test_compile_query_cb,  teardown);
 // GNC_TEST_ADD (suitename, "gnc sql compile query", Fixture, nullptr, test_gnc_sql_compile_query,  teardown);
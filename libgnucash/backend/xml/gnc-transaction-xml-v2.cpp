@@ -48,6 +48,13 @@ extern "C"
 
 #include "sixtp-dom-parsers.h"
 
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+static QofLogModule log_module = GNC_MOD_IO;
+
 const gchar* transaction_version_string = "2.0.0";
 
 static void
@@ -227,7 +234,7 @@ set_spl_gnc_num (xmlNodePtr node, Split* spl,
 
     g_free (num);
 
-    return FALSE;
+    return TRUE;
 }
 
 static gboolean
@@ -301,50 +308,60 @@ spl_quantity_handler (xmlNodePtr node, gpointer data)
 
 gboolean gnc_transaction_xml_v2_testing = FALSE;
 
-static gboolean
-spl_account_handler (xmlNodePtr node, gpointer data)
+static void
+set_spl_account (Split* spl, QofBook* book, const GncGUID* id)
 {
-    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
-    GncGUID* id = dom_tree_to_guid (node);
-    Account* account;
-
-    g_return_val_if_fail (id, FALSE);
-
-    account = xaccAccountLookup (id, pdata->book);
+    Account* account = xaccAccountLookup (id, book);
     if (!account && gnc_transaction_xml_v2_testing &&
         !guid_equal (id, guid_null ()))
     {
-        account = xaccMallocAccount (pdata->book);
+        account = xaccMallocAccount (book);
         xaccAccountSetGUID (account, id);
         xaccAccountSetCommoditySCU (account,
-                                    xaccSplitGetAmount (pdata->split).denom);
+                                    xaccSplitGetAmount (spl).denom);
     }
 
-    xaccAccountInsertSplit (account, pdata->split);
-
-    g_free (id);
-
-    return TRUE;
+    xaccAccountInsertSplit (account, spl);
 }
 
 static gboolean
-spl_lot_handler (xmlNodePtr node, gpointer data)
+spl_account_handler (xmlNodePtr node, gpointer data)
 {
     struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
     GncGUID* id = dom_tree_to_guid (node);
-    GNCLot* lot;
 
     g_return_val_if_fail (id, FALSE);
 
-    lot = gnc_lot_lookup (id, pdata->book);
+    set_spl_account (pdata->split, pdata->book, id);
+
+    g_free (id);
+
+    return TRUE;
+}
+
+static void
+set_spl_lot (Split* spl, QofBook* book, const GncGUID* id)
+{
+    GNCLot* lot = gnc_lot_lookup (id, book);
     if (!lot && gnc_transaction_xml_v2_testing &&
         !guid_equal (id, guid_null ()))
     {
-        lot = gnc_lot_new (pdata->book);
+        lot = gnc_lot_new (book);
         gnc_lot_set_guid (lot, *id);
     }
 
-    gnc_lot_add_split (lot, pdata->split);
+    gnc_lot_add_split (lot, spl);
+}
+
+static gboolean
+spl_lot_handler (xmlNodePtr node, gpointer data)
+{
+    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
+    GncGUID* id = dom_tree_to_guid (node);
+
+    g_return_val_if_fail (id, FALSE);
+
+    set_spl_lot (pdata->split, pdata->book, id);
 
     g_free (id);
 
@@ -394,7 +411,7 @@ dom_tree_to_split (xmlNodePtr node, QofBook* book)
     pdata.book = book;
 
     /* this isn't going to work in a testing setup */
-    if (dom_tree_generic_parse (node, spl_dom_handlers, &pdata))
+    if (dom_tree_strict_parse (node, spl_dom_handlers, &pdata))
     {
         return ret;
     }
@@ -532,7 +549,6 @@ trn_splits_handler (xmlNodePtr node, gpointer trans_pdata)
     xmlNodePtr mark;
 
     g_return_val_if_fail (node, FALSE);
-    g_return_val_if_fail (node->xmlChildrenNode, FALSE);
 
     for (mark = node->xmlChildrenNode; mark; mark = mark->next)
     {
@@ -626,7 +642,7 @@ dom_tree_to_transaction (xmlNodePtr node, QofBook* book)
     pdata.trans = trn;
     pdata.book = book;
 
-    successful = dom_tree_generic_parse (node, trn_dom_handlers, &pdata);
+    successful = dom_tree_strict_parse (node, trn_dom_handlers, &pdata);
 
     xaccTransCommitEdit (trn);
 
@@ -647,3 +663,832 @@ gnc_transaction_sixtp_parser_create (void)
 {
     return sixtp_dom_parser_new (gnc_transaction_end_handler, NULL, NULL);
 }
+
+/***********************************************************************/
+/* Streaming parser
+ *
+ * The parser above collects each <gnc:transaction> into a DOM tree and
+ * then converts the tree.  This one reads the transaction from the SAX
+ * events into a stream_trn_record that holds each field's text.  Slots,
+ * which have no fixed shape, are kept as a DOM tree of just that field
+ * and passed to the DOM handlers above, so both parsers accept the same
+ * input.
+ *
+ * A record is then converted (stream_convert_record) and built into
+ * the engine's objects (stream_build_transaction).  Conversion doesn't
+ * touch the engine, so a gnc_trn_pipeline can do it on other threads.
+ */
+
+enum class stream_field
+{
+    TEXT,       /* the field's own text */
+    TIMESPEC,   /* <ts:date> and <ts:ns> */
+    COMMODITY,  /* <cmdty:space> and <cmdty:id> */
+    DOM,        /* collected for a DOM handler */
+};
+
+struct stream_xml_node_free
+{
+    void operator() (xmlNodePtr node)
+    {
+        xmlFreeNode (node);
+    }
+};
+
+/* One field of a transaction or split, as read from the file. */
+struct stream_field_record
+{
+    int handler;        /* in trn_dom_handlers or spl_dom_handlers */
+    stream_field kind;
+    std::string text;
+    /* Text of the two sub-elements of a TIMESPEC or COMMODITY field
+     * and how often each occurred. */
+    std::string sub_text[2];
+    int sub_seen[2];
+    std::unique_ptr<xmlNode, stream_xml_node_free> dom;
+    /* Set by stream_convert_record. */
+    GncGUID guid;
+    Timespec ts;
+    gnc_numeric num;
+};
+
+struct stream_split_record
+{
+    std::vector<stream_field_record> fields;
+};
+
+struct stream_trn_record
+{
+    /* The <trn:splits> field marks where the splits are added. */
+    std::vector<stream_field_record> fields;
+    std::vector<stream_split_record> splits;
+};
+
+struct trn_stream_pdata
+{
+    QofBook* book;
+    stream_trn_record record;
+    gboolean ok;
+    /* Bit i is set once field i of trn_dom_handlers or spl_dom_handlers
+     * has been read, so that the required ones can be checked. */
+    guint trn_seen;
+    guint spl_seen;
+    /* The split being read, or NULL. */
+    stream_split_record* split;
+    gboolean split_ok;
+
+    /* Depth of the current element below <gnc:transaction>. */
+    int depth;
+    /* Depth of an element whose contents are being ignored, or 0. */
+    int skip_depth;
+
+    /* The field being read, a child of <gnc:transaction> or of
+     * <trn:split>, or NULL between fields. */
+    stream_field_record* field;
+    int field_depth;
+    /* Which of the field's sub-elements is open, or -1. */
+    int sub_index;
+    /* The open node of a DOM field. */
+    xmlNodePtr dom_cur;
+};
+
+static gboolean trn_pipeline_push (gnc_trn_pipeline* pipeline,
+                                   gxpf_data* gdata, const gchar* tag,
+                                   stream_trn_record* record);
+
+static const char* stream_timespec_tags[] = { "ts:date", "ts:ns" };
+static const char* stream_commodity_tags[] = { "cmdty:space", "cmdty:id" };
+
+static stream_field
+stream_field_kind (const gchar* tag)
+{
+    static const char* text_tags[] =
+    {
+        "trn:id", "trn:num", "trn:description",
+        "split:id", "split:memo", "split:action", "split:reconciled-state",
+        "split:value", "split:quantity", "split:account", "split:lot",
+    };
+
+    for (auto text_tag : text_tags)
+        if (g_strcmp0 (tag, text_tag) == 0)
+            return stream_field::TEXT;
+    if (g_strcmp0 (tag, "trn:date-posted") == 0 ||
+        g_strcmp0 (tag, "trn:date-entered") == 0 ||
+        g_strcmp0 (tag, "split:reconcile-date") == 0)
+        return stream_field::TIMESPEC;
+    if (g_strcmp0 (tag, "trn:currency") == 0)
+        return stream_field::COMMODITY;
+    return stream_field::DOM;
+}
+
+static gboolean
+stream_is_guid_tag (const gchar* tag)
+{
+    return (g_strcmp0 (tag, "trn:id") == 0 ||
+            g_strcmp0 (tag, "split:id") == 0 ||
+            g_strcmp0 (tag, "split:account") == 0 ||
+            g_strcmp0 (tag, "split:lot") == 0);
+}
+
+static void
+stream_set_props (xmlNodePtr node, gchar** attrs)
+{
+    for (gchar** atptr = attrs; atptr && *atptr; atptr += 2)
+        xmlSetProp (node, BAD_CAST atptr[0], BAD_CAST atptr[1]);
+}
+
+/* The same check dom_tree_to_guid makes of an id's attributes. */
+static gboolean
+stream_guid_type_ok (gchar** attrs)
+{
+    if (!attrs || !attrs[0] || g_strcmp0 (attrs[0], "type") != 0)
+        return FALSE;
+    return (g_strcmp0 (attrs[1], "guid") == 0 ||
+            g_strcmp0 (attrs[1], "new") == 0);
+}
+
+/* Look the field up in handlers and note that it has been read.
+ * Returns its index, or -1 if the tag isn't one of them. */
+static int
+stream_field_seen (struct dom_tree_handler* handlers, const gchar* tag,
+                   guint* seen)
+{
+    for (int i = 0; handlers[i].tag; i++)
+        if (g_strcmp0 (tag, handlers[i].tag) == 0)
+        {
+            *seen |= 1u << i;
+            return i;
+        }
+    PERR ("Unhandled tag: %s", tag ? tag : "(null)");
+    return -1;
+}
+
+static gboolean
+stream_all_seen (struct dom_tree_handler* handlers, guint seen)
+{
+    gboolean ret = TRUE;
+    for (int i = 0; handlers[i].tag; i++)
+        if (handlers[i].required && ! (seen & (1u << i)))
+        {
+            PERR ("Not defined and it should be: %s", handlers[i].tag);
+            ret = FALSE;
+        }
+    return ret;
+}
+
+/* Conversion *********************************************************/
+
+static void
+stream_convert_field (stream_field_record& field, const gchar* tag)
+{
+    switch (field.kind)
+    {
+    case stream_field::TEXT:
+        if (stream_is_guid_tag (tag))
+            string_to_guid (field.text.c_str (), &field.guid);
+        else if (g_strcmp0 (tag, "split:value") == 0 ||
+                 g_strcmp0 (tag, "split:quantity") == 0)
+        {
+            if (!string_to_gnc_numeric (field.text.c_str (), &field.num))
+                field.num = gnc_numeric_zero ();
+        }
+        break;
+    case stream_field::TIMESPEC:
+        /* As dom_tree_to_timespec: a zero timespec on failure. */
+        if (field.sub_seen[0] != 1 || field.sub_seen[1] > 1 ||
+            !string_to_timespec_secs (field.sub_text[0].c_str (), &field.ts) ||
+            (field.sub_seen[1] &&
+             !string_to_timespec_nsecs (field.sub_text[1].c_str (), &field.ts)))
+        {
+            field.ts.tv_sec = 0;
+            field.ts.tv_nsec = 0;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/* Convert the text of the record's GUIDs, dates and numbers.  This
+ * doesn't use the engine and may run on any thread. */
+static void
+stream_convert_record (stream_trn_record& record)
+{
+    for (auto& field : record.fields)
+        stream_convert_field (field, trn_dom_handlers[field.handler].tag);
+    for (auto& split : record.splits)
+        for (auto& field : split.fields)
+            stream_convert_field (field, spl_dom_handlers[field.handler].tag);
+}
+
+/* Building ***********************************************************/
+
+static gboolean
+stream_field_timespec (const stream_field_record& field, const gchar* tag)
+{
+    Timespec ts = field.ts;
+    return dom_tree_valid_timespec (&ts, BAD_CAST tag);
+}
+
+static gnc_commodity*
+stream_field_commodity_ref (const stream_field_record& field, QofBook* book)
+{
+    if (field.sub_seen[0] != 1 || field.sub_seen[1] != 1)
+        return NULL;
+
+    auto space_str = g_strstrip (g_strdup (field.sub_text[0].c_str ()));
+    auto id_str = g_strstrip (g_strdup (field.sub_text[1].c_str ()));
+    auto table = gnc_commodity_table_get_table (book);
+    auto ret = gnc_commodity_table_lookup (table, space_str, id_str);
+    g_free (space_str);
+    g_free (id_str);
+    return ret;
+}
+
+/* Add the split in a converted record to trn.  Like dom_tree_to_split
+ * it fails, leaving trn alone, if a handler or a date does. */
+static gboolean
+stream_build_split (stream_split_record& record, Transaction* trn,
+                    QofBook* book)
+{
+    struct split_pdata pdata;
+    Split* spl = xaccMallocSplit (book);
+    gboolean successful = TRUE;
+
+    pdata.split = spl;
+    pdata.book = book;
+    for (auto& field : record.fields)
+    {
+        auto handler = &spl_dom_handlers[field.handler];
+        const gchar* tag = handler->tag;
+
+        if (field.kind == stream_field::DOM)
+            successful = handler->handler (field.dom.get (), &pdata);
+        else if (g_strcmp0 (tag, "split:id") == 0)
+            xaccSplitSetGUID (spl, &field.guid);
+        else if (g_strcmp0 (tag, "split:memo") == 0)
+            xaccSplitSetMemo (spl, field.text.c_str ());
+        else if (g_strcmp0 (tag, "split:action") == 0)
+            xaccSplitSetAction (spl, field.text.c_str ());
+        else if (g_strcmp0 (tag, "split:reconciled-state") == 0)
+            xaccSplitSetReconcile (spl, field.text.c_str ()[0]);
+        else if (g_strcmp0 (tag, "split:reconcile-date") == 0)
+        {
+            successful = stream_field_timespec (field, tag);
+            if (successful)
+                xaccSplitSetDateReconciledTS (spl, &field.ts);
+        }
+        else if (g_strcmp0 (tag, "split:value") == 0)
+            xaccSplitSetValue (spl, field.num);
+        else if (g_strcmp0 (tag, "split:quantity") == 0)
+            xaccSplitSetAmount (spl, field.num);
+        else if (g_strcmp0 (tag, "split:account") == 0)
+            set_spl_account (spl, book, &field.guid);
+        else if (g_strcmp0 (tag, "split:lot") == 0)
+            set_spl_lot (spl, book, &field.guid);
+
+        if (!successful)
+        {
+            PERR ("Bad data for tag: %s", tag);
+            xaccSplitDestroy (spl);
+            return FALSE;
+        }
+    }
+    xaccTransAppendSplit (trn, spl);
+    return TRUE;
+}
+
+/* Create and commit the transaction in a converted record.  If any of
+ * it is bad the transaction is destroyed again and NULL returned, as
+ * dom_tree_to_transaction does. */
+static Transaction*
+stream_build_transaction (stream_trn_record& record, QofBook* book)
+{
+    struct trans_pdata pdata;
+    Transaction* trn = xaccMallocTransaction (book);
+    gboolean successful = TRUE;
+
+    xaccTransBeginEdit (trn);
+    pdata.trans = trn;
+    pdata.book = book;
+    for (auto& field : record.fields)
+    {
+        auto handler = &trn_dom_handlers[field.handler];
+        const gchar* tag = handler->tag;
+
+        if (g_strcmp0 (tag, "trn:splits") == 0)
+        {
+            for (auto& split : record.splits)
+                if (!(successful = stream_build_split (split, trn, book)))
+                    break;
+        }
+        else if (field.kind == stream_field::DOM)
+        {
+            successful = handler->handler (field.dom.get (), &pdata);
+            if (!successful)
+                PERR ("Bad data for tag: %s", tag);
+        }
+        else if (g_strcmp0 (tag, "trn:id") == 0)
+            xaccTransSetGUID (trn, &field.guid);
+        else if (g_strcmp0 (tag, "trn:currency") == 0)
+            xaccTransSetCurrency (trn, stream_field_commodity_ref (field, book));
+        else if (g_strcmp0 (tag, "trn:num") == 0)
+            xaccTransSetNum (trn, field.text.c_str ());
+        else if (g_strcmp0 (tag, "trn:date-posted") == 0)
+        {
+            successful = stream_field_timespec (field, tag);
+            if (successful)
+                xaccTransSetDatePostedTS (trn, &field.ts);
+        }
+        else if (g_strcmp0 (tag, "trn:date-entered") == 0)
+        {
+            successful = stream_field_timespec (field, tag);
+            if (successful)
+                xaccTransSetDateEnteredTS (trn, &field.ts);
+        }
+        else if (g_strcmp0 (tag, "trn:description") == 0)
+            xaccTransSetDescription (trn, field.text.c_str ());
+
+        if (!successful)
+            break;
+    }
+    xaccTransCommitEdit (trn);
+
+    if (!successful)
+    {
+        PERR ("failed to parse transaction");
+        xaccTransBeginEdit (trn);
+        xaccTransDestroy (trn);
+        xaccTransCommitEdit (trn);
+        trn = NULL;
+    }
+
+    return trn;
+}
+
+/* Parsing ************************************************************/
+
+/* Mark the split being read, or else the transaction, as bad. */
+static void
+stream_fail (trn_stream_pdata* pdata)
+{
+    if (pdata->split)
+        pdata->split_ok = FALSE;
+    else
+        pdata->ok = FALSE;
+}
+
+static void
+stream_start_field (trn_stream_pdata* pdata,
+                    std::vector<stream_field_record>& fields,
+                    struct dom_tree_handler* handlers, guint* seen,
+                    const gchar* tag, gchar** attrs)
+{
+    int handler = stream_field_seen (handlers, tag, seen);
+
+    if (handler < 0)
+    {
+        stream_fail (pdata);
+        pdata->skip_depth = pdata->depth;
+        return;
+    }
+    if (stream_is_guid_tag (tag) && !stream_guid_type_ok (attrs))
+    {
+        PERR ("Bad type attribute for tag %s", tag);
+        stream_fail (pdata);
+    }
+
+    fields.emplace_back ();
+    auto& field = fields.back ();
+    field.handler = handler;
+    field.kind = stream_field_kind (tag);
+    field.sub_seen[0] = field.sub_seen[1] = 0;
+    if (field.kind == stream_field::DOM)
+    {
+        field.dom.reset (xmlNewNode (NULL, BAD_CAST tag));
+        stream_set_props (field.dom.get (), attrs);
+        pdata->dom_cur = field.dom.get ();
+    }
+    pdata->field = &field;
+    pdata->field_depth = pdata->depth;
+    pdata->sub_index = -1;
+}
+
+static void
+stream_start_subfield (trn_stream_pdata* pdata, const gchar* tag, gchar** attrs)
+{
+    auto field = pdata->field;
+    const char** sub_tags = NULL;
+
+    switch (field->kind)
+    {
+    case stream_field::DOM:
+        pdata->dom_cur = xmlNewChild (pdata->dom_cur, NULL, BAD_CAST tag, NULL);
+        stream_set_props (pdata->dom_cur, attrs);
+        return;
+    case stream_field::TIMESPEC:
+        sub_tags = stream_timespec_tags;
+        break;
+    case stream_field::COMMODITY:
+        sub_tags = stream_commodity_tags;
+        break;
+    case stream_field::TEXT:
+        return;
+    }
+
+    if (pdata->depth != pdata->field_depth + 1)
+        return;
+    for (int i = 0; i < 2; i++)
+        if (g_strcmp0 (tag, sub_tags[i]) == 0)
+        {
+            pdata->sub_index = i;
+            field->sub_seen[i]++;
+            field->sub_text[i].clear ();
+        }
+}
+
+static void
+stream_end_split (trn_stream_pdata* pdata)
+{
+    /* A bad split fails the transaction, as in trn_splits_handler. */
+    if (!pdata->split_ok || !stream_all_seen (spl_dom_handlers, pdata->spl_seen))
+        pdata->ok = FALSE;
+    pdata->split = NULL;
+}
+
+static gboolean
+gnc_transaction_stream_start_handler (GSList* sibling_data,
+                                      gpointer parent_data,
+                                      gpointer global_data,
+                                      gpointer* data_for_children,
+                                      gpointer* result,
+                                      const gchar* tag, gchar** attrs)
+{
+    gxpf_data* gdata = (gxpf_data*)global_data;
+    trn_stream_pdata* pdata;
+
+    *result = NULL;
+    /* Called without a tag when this is the top level parser. */
+    if (!tag)
+        return TRUE;
+
+    if (!parent_data)
+    {
+        /* This is the <gnc:transaction> itself. */
+        auto book = static_cast<QofBook*> (gdata->bookdata);
+        g_return_val_if_fail (book, FALSE);
+
+        pdata = new trn_stream_pdata {};
+        pdata->book = book;
+        pdata->ok = TRUE;
+        *data_for_children = pdata;
+        return TRUE;
+    }
+
+    pdata = static_cast<decltype (pdata)> (parent_data);
+    *data_for_children = pdata;
+    pdata->depth++;
+
+    if (pdata->skip_depth)
+        return TRUE;
+
+    if (pdata->field)
+        stream_start_subfield (pdata, tag, attrs);
+    else if (pdata->depth == 1 && g_strcmp0 (tag, "trn:splits") == 0)
+    {
+        int handler = stream_field_seen (trn_dom_handlers, tag,
+                                         &pdata->trn_seen);
+        pdata->record.fields.emplace_back ();
+        pdata->record.fields.back ().handler = handler;
+        pdata->record.fields.back ().kind = stream_field::TEXT;
+    }
+    else if (pdata->depth == 1)
+        stream_start_field (pdata, pdata->record.fields, trn_dom_handlers,
+                            &pdata->trn_seen, tag, attrs);
+    else if (pdata->depth == 2)
+    {
+        /* A child of <trn:splits>. */
+        if (g_strcmp0 (tag, "trn:split") != 0)
+        {
+            PERR ("Unhandled tag: %s", tag);
+            pdata->ok = FALSE;
+            pdata->skip_depth = pdata->depth;
+            return TRUE;
+        }
+        pdata->record.splits.emplace_back ();
+        pdata->split = &pdata->record.splits.back ();
+        pdata->split_ok = TRUE;
+        pdata->spl_seen = 0;
+    }
+    else
+        stream_start_field (pdata, pdata->split->fields, spl_dom_handlers,
+                            &pdata->spl_seen, tag, attrs);
+
+    return TRUE;
+}
+
+static gboolean
+gnc_transaction_stream_chars_handler (GSList* sibling_data,
+                                      gpointer parent_data,
+                                      gpointer global_data,
+                                      gpointer* result,
+                                      const char* text, int length)
+{
+    trn_stream_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+
+    if (!pdata || !pdata->field || pdata->skip_depth || length <= 0)
+        return TRUE;
+
+    auto field = pdata->field;
+    switch (field->kind)
+    {
+    case stream_field::DOM:
+        xmlNodeAddContentLen (pdata->dom_cur, BAD_CAST text, length);
+        break;
+    case stream_field::TEXT:
+        if (pdata->depth == pdata->field_depth)
+            field->text.append (text, length);
+        break;
+    default:
+        if (pdata->depth == pdata->field_depth + 1 && pdata->sub_index >= 0)
+            field->sub_text[pdata->sub_index].append (text, length);
+        break;
+    }
+    return TRUE;
+}
+
+static gboolean
+gnc_transaction_stream_end_handler (gpointer data_for_children,
+                                    GSList* data_from_children,
+                                    GSList* sibling_data,
+                                    gpointer parent_data,
+                                    gpointer global_data,
+                                    gpointer* result,
+                                    const gchar* tag)
+{
+    trn_stream_pdata* pdata = static_cast<decltype (pdata)> (data_for_children);
+    gxpf_data* gdata = (gxpf_data*)global_data;
+
+    if (parent_data)
+    {
+        if (pdata->skip_depth)
+        {
+            if (pdata->depth == pdata->skip_depth)
+                pdata->skip_depth = 0;
+        }
+        else if (pdata->field && pdata->depth > pdata->field_depth)
+        {
+            if (pdata->field->kind == stream_field::DOM)
+                pdata->dom_cur = pdata->dom_cur->parent;
+            else if (pdata->depth == pdata->field_depth + 1)
+                pdata->sub_index = -1;
+        }
+        else if (pdata->field)
+        {
+            pdata->field = NULL;
+            pdata->dom_cur = NULL;
+        }
+        else if (pdata->depth == 2)
+            stream_end_split (pdata);
+
+        pdata->depth--;
+        return TRUE;
+    }
+
+    /* See gnc_transaction_end_handler. */
+    if (!tag)
+        return TRUE;
+
+    g_return_val_if_fail (pdata, FALSE);
+
+    if (!pdata->ok || !stream_all_seen (trn_dom_handlers, pdata->trn_seen))
+    {
+        PERR ("failed to parse transaction");
+        delete pdata;
+        return FALSE;
+    }
+
+    gboolean successful = TRUE;
+    if (gdata->pipeline)
+    {
+        successful = trn_pipeline_push (gdata->pipeline, gdata, tag,
+                                        &pdata->record);
+    }
+    else
+    {
+        stream_convert_record (pdata->record);
+        auto trn = stream_build_transaction (pdata->record, pdata->book);
+        if (trn != NULL)
+            gdata->cb (tag, gdata->parsedata, trn);
+        successful = trn != NULL;
+    }
+    delete pdata;
+
+    return successful;
+}
+
+static void
+gnc_transaction_stream_fail_handler (gpointer data_for_children,
+                                     GSList* data_from_children,
+                                     GSList* sibling_data,
+                                     gpointer parent_data,
+                                     gpointer global_data,
+                                     gpointer* result,
+                                     const gchar* tag)
+{
+    /* Only the <gnc:transaction> frame owns the data. */
+    if (!parent_data)
+        delete static_cast<trn_stream_pdata*> (data_for_children);
+}
+
+sixtp*
+gnc_transaction_stream_sixtp_parser_create (void)
+{
+    sixtp* top_level;
+
+    if (! (top_level =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID,
+                              gnc_transaction_stream_start_handler,
+                              SIXTP_CHARACTERS_HANDLER_ID,
+                              gnc_transaction_stream_chars_handler,
+                              SIXTP_END_HANDLER_ID,
+                              gnc_transaction_stream_end_handler,
+                              SIXTP_FAIL_HANDLER_ID,
+                              gnc_transaction_stream_fail_handler,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        return NULL;
+    }
+
+    /* Every element inside the transaction comes back here. */
+    if (!sixtp_add_sub_parser (top_level, SIXTP_MAGIC_CATCHER, top_level))
+    {
+        sixtp_destroy (top_level);
+        return NULL;
+    }
+
+    return top_level;
+}
+
+/***********************************************************************/
+/* Load pipeline
+ *
+ * try_gz_open already decompresses in a thread of its own, and the
+ * parser has to stay on the thread that owns the book, as do the engine
+ * calls that build and commit each transaction.  What can move is
+ * stream_convert_record, which turns the text of the GUIDs, dates and
+ * numbers into values.  The pipeline collects records into batches,
+ * converts each batch on a thread pool while the parser carries on, and
+ * builds and commits the converted batches in file order.
+ */
+
+#define TRN_PIPELINE_BATCH_SIZE 256
+
+struct trn_pipeline_batch
+{
+    std::vector<stream_trn_record> records;
+    gboolean converted;
+};
+
+struct gnc_trn_pipeline
+{
+    GThreadPool* pool;          /* NULL to convert on the parser's thread */
+    /* Batches in flight before the parser waits for the oldest. */
+    guint max_batches;
+    GMutex mutex;
+    GCond cond;                 /* a batch has been converted */
+    /* Submitted batches in file order.  Only the parser's thread
+     * touches the queue itself. */
+    std::deque<trn_pipeline_batch*> batches;
+    trn_pipeline_batch* filling;
+    /* Where the built transactions go. */
+    gxpf_data gdata;
+    std::string tag;
+    /* A transaction failed to build.  Those after it are dropped. */
+    gboolean failed;
+};
+
+static void
+trn_pipeline_convert (gpointer data, gpointer user_data)
+{
+    auto batch = static_cast<trn_pipeline_batch*> (data);
+    auto pipeline = static_cast<gnc_trn_pipeline*> (user_data);
+
+    for (auto& record : batch->records)
+        stream_convert_record (record);
+
+    g_mutex_lock (&pipeline->mutex);
+    batch->converted = TRUE;
+    g_cond_broadcast (&pipeline->cond);
+    g_mutex_unlock (&pipeline->mutex);
+}
+
+static void
+trn_pipeline_submit (gnc_trn_pipeline* pipeline)
+{
+    auto batch = pipeline->filling;
+
+    pipeline->filling = NULL;
+    pipeline->batches.push_back (batch);
+    if (pipeline->pool)
+        g_thread_pool_push (pipeline->pool, batch, NULL);
+    else
+        trn_pipeline_convert (batch, pipeline);
+}
+
+/* Build and commit the converted batches at the front of the queue,
+ * waiting for the oldest while more than keep are in flight.  Returns
+ * FALSE once a transaction has failed. */
+static gboolean
+trn_pipeline_commit (gnc_trn_pipeline* pipeline, guint keep)
+{
+    auto book = static_cast<QofBook*> (pipeline->gdata.bookdata);
+
+    while (!pipeline->batches.empty ())
+    {
+        auto batch = pipeline->batches.front ();
+
+        g_mutex_lock (&pipeline->mutex);
+        if (!batch->converted && pipeline->batches.size () <= keep)
+        {
+            g_mutex_unlock (&pipeline->mutex);
+            break;
+        }
+        while (!batch->converted)
+            g_cond_wait (&pipeline->cond, &pipeline->mutex);
+        g_mutex_unlock (&pipeline->mutex);
+
+        pipeline->batches.pop_front ();
+        for (auto& record : batch->records)
+        {
+            if (pipeline->failed)
+                break;
+            auto trn = stream_build_transaction (record, book);
+            if (trn != NULL)
+                pipeline->gdata.cb (pipeline->tag.c_str (),
+                                    pipeline->gdata.parsedata, trn);
+            else
+                pipeline->failed = TRUE;
+        }
+        delete batch;
+    }
+    return !pipeline->failed;
+}
+
+gnc_trn_pipeline*
+gnc_trn_pipeline_new (void)
+{
+    auto pipeline = new gnc_trn_pipeline {};
+    /* The parser's own thread is busy parsing and committing. */
+    gint threads = g_get_num_processors () - 1;
+
+    g_mutex_init (&pipeline->mutex);
+    g_cond_init (&pipeline->cond);
+    if (threads > 0)
+        pipeline->pool = g_thread_pool_new (trn_pipeline_convert, pipeline,
+                                            threads, FALSE, NULL);
+    pipeline->max_batches = 4 * MAX (threads, 1);
+    return pipeline;
+}
+
+static gboolean
+trn_pipeline_push (gnc_trn_pipeline* pipeline, gxpf_data* gdata,
+                   const gchar* tag, stream_trn_record* record)
+{
+    pipeline->gdata = *gdata;
+    pipeline->tag = tag;
+    if (!pipeline->filling)
+    {
+        pipeline->filling = new trn_pipeline_batch {};
+        pipeline->filling->records.reserve (TRN_PIPELINE_BATCH_SIZE);
+    }
+    pipeline->filling->records.push_back (std::move (*record));
+    if (pipeline->filling->records.size () < TRN_PIPELINE_BATCH_SIZE)
+        return !pipeline->failed;
+
+    trn_pipeline_submit (pipeline);
+    return trn_pipeline_commit (pipeline, pipeline->max_batches);
+}
+
+gboolean
+gnc_trn_pipeline_flush (gnc_trn_pipeline* pipeline)
+{
+    if (pipeline->filling)
+        trn_pipeline_submit (pipeline);
+    return trn_pipeline_commit (pipeline, 0);
+}
+
+void
+gnc_trn_pipeline_destroy (gnc_trn_pipeline* pipeline)
+{
+    /* Let the pool finish with the batches it has been given. */
+    if (pipeline->pool)
+        g_thread_pool_free (pipeline->pool, FALSE, TRUE);
+    for (auto batch : pipeline->batches)
+        delete batch;
+    delete pipeline->filling;
+    g_cond_clear (&pipeline->cond);
+    g_mutex_clear (&pipeline->mutex);
+    delete pipeline;
+}
@@ -33,6 +33,8 @@ extern "C"
 
 #include <gnc-engine.h> //for GNC_MOD_BACKEND
 #include <gnc-uri-utils.h>
+#include <Transaction.h>
+#include <Split.h>
 #include <TransLog.h>
 #include <gnc-prefs.h>
 
@@ -129,6 +131,11 @@ GncXmlBackend::session_begin(QofSession* session, const char* book_id,
         return;
     m_dirname = g_path_get_dirname (m_fullpath.c_str());
 
+    m_journal = m_fullpath + ".journal";
+    auto journal_max = g_getenv ("GNC_XML_JOURNAL");
+    if (journal_max != nullptr)
+        m_journal_max = static_cast<unsigned int>(g_ascii_strtoull (journal_max,
+                                                                    nullptr, 10));
 
 
     /* ---------------------------------------------------- */
@@ -176,6 +183,15 @@ GncXmlBackend::session_end()
         return;
     }
 
+    /* Fold the journal into the data file, unless the book has changes that
+     * were never saved and so mustn't be written now. */
+    if (m_book && (m_journal_records > 0 || m_full_save_needed) &&
+        !qof_book_session_not_saved (m_book))
+    {
+        if (write_to_file (true))
+            remove_old_files ();
+    }
+
     if (!m_linkfile.empty())
         g_unlink (m_linkfile.c_str());
 
@@ -202,6 +218,9 @@ GncXmlBackend::session_end()
     m_fullpath.clear();
     m_lockfile.clear();
     m_linkfile.clear();
+    m_journal.clear();
+    reset_journal ();
+    m_journal_ok = false;
 }
 
 static QofBookFileType
@@ -243,6 +262,7 @@ GncXmlBackend::load(QofBook* book, QofBackendLoadType loadType)
 
     error = ERR_BACKEND_NO_ERR;
     m_book = book;
+    m_loading = true;
 
     int rc;
     switch (determine_file_type (m_fullpath))
@@ -255,6 +275,10 @@ GncXmlBackend::load(QofBook* book, QofBackendLoadType loadType)
             PWARN ("Syntax error in Xml File %s", m_fullpath.c_str());
             error = ERR_FILEIO_PARSE_ERROR;
         }
+        else
+        {
+            replay_journal ();
+        }
         break;
 
     case GNC_BOOK_XML2_FILE_NO_ENCODING:
@@ -301,6 +325,11 @@ GncXmlBackend::load(QofBook* book, QofBackendLoadType loadType)
         set_error(error);
     }
 
+    /* Nothing that the load committed needs saving. */
+    m_changed_tx.clear();
+    m_changed_tx_set.clear();
+    m_loading = false;
+
     /* We just got done loading, it can't possibly be dirty !! */
     qof_book_mark_session_saved (book);
 }
@@ -324,10 +353,115 @@ GncXmlBackend::sync(QofBook* book)
         return;
     }
 
+    if (append_to_journal ())
+        return;
     write_to_file (true);
     remove_old_files();
 }
 
+void
+GncXmlBackend::commit (QofInstance* inst)
+{
+    if (m_journal_max == 0 || m_loading || m_book == nullptr ||
+        qof_instance_get_book (inst) != m_book)
+        return;
+    if (!qof_instance_get_dirty_flag (inst) &&
+        !qof_instance_get_destroying (inst))
+        return;
+
+    /* A split is saved with its transaction. */
+    if (GNC_IS_SPLIT (inst))
+    {
+        auto trn = xaccSplitGetParent (GNC_SPLIT (inst));
+        if (trn == nullptr)
+            return;
+        inst = QOF_INSTANCE (trn);
+    }
+    if (!GNC_IS_TRANSACTION (inst))
+    {
+        m_full_save_needed = true;
+        return;
+    }
+
+    char guid_str[GUID_ENCODING_LENGTH + 1];
+    auto guid = qof_instance_get_guid (inst);
+    guid_to_string_buff (guid, guid_str);
+    if (m_changed_tx_set.insert (guid_str).second)
+        m_changed_tx.push_back (*guid);
+}
+
+/* Save only the transactions that have changed, if nothing else has and the
+ * journal has room for them. */
+bool
+GncXmlBackend::append_to_journal ()
+{
+    if (m_journal_max == 0 || !m_journal_ok || m_full_save_needed ||
+        m_changed_tx.empty() ||
+        m_journal_records + m_changed_tx.size() > m_journal_max)
+        return false;
+
+    ENTER (" book=%p journal=%s transactions=%zu", m_book, m_journal.c_str(),
+           m_changed_tx.size());
+    if (!gnc_book_append_to_xml_journal_v2 (m_book, m_journal.c_str(),
+                                            m_changed_tx))
+    {
+        /* Whatever did get written can't be relied on now. */
+        PWARN ("Unable to append to journal %s", m_journal.c_str());
+        m_full_save_needed = true;
+        LEAVE ("");
+        return false;
+    }
+    m_journal_records += m_changed_tx.size();
+    m_changed_tx.clear();
+    m_changed_tx_set.clear();
+    qof_book_mark_session_saved (m_book);
+    LEAVE ("");
+    return true;
+}
+
+void
+GncXmlBackend::replay_journal ()
+{
+    m_journal_ok = true;
+    GStatBuf journal_stat, data_stat;
+    if (g_stat (m_journal.c_str(), &journal_stat) != 0)
+        return;
+
+    /* A journal older than the data file is left over from before the file
+     * was last written in full, by a program that didn't know about it. */
+    if (g_stat (m_fullpath.c_str(), &data_stat) == 0 &&
+        journal_stat.st_mtime < data_stat.st_mtime)
+    {
+        PWARN ("Removing journal %s, which is older than its data file",
+               m_journal.c_str());
+        g_unlink (m_journal.c_str());
+        return;
+    }
+
+    auto records = gnc_book_replay_xml_journal_v2 (m_book, m_journal.c_str());
+    if (records < 0)
+    {
+        /* The records replayed are in the book, but no more may go after
+         * the last, incomplete one: the next save must write everything. */
+        m_full_save_needed = true;
+        return;
+    }
+    m_journal_records = records;
+}
+
+/* The data file has just been written in full. */
+void
+GncXmlBackend::reset_journal ()
+{
+    if (!m_journal.empty())
+        g_unlink (m_journal.c_str());
+    m_journal_records = 0;
+    m_journal_ok = true;
+    m_full_save_needed = false;
+    m_changed_tx.clear();
+    m_changed_tx_set.clear();
+}
+
 bool
 GncXmlBackend::save_may_clobber_data()
 {
@@ -475,6 +609,7 @@ GncXmlBackend::write_to_file (bool make_backup)
         /* Since we successfully saved the book,
          * we should mark it clean. */
         qof_book_mark_session_saved (m_book);
+        reset_journal ();
         LEAVE (" successful save of book=%p to file=%s", m_book,
                m_fullpath.c_str());
         return TRUE;
@@ -24,6 +24,8 @@ extern "C"
 }
 
 #include <string>
+#include <unordered_set>
+#include <vector>
 #include <qof-backend.hpp>
 
 class GncXmlBackend : public QofBackend
@@ -39,7 +41,9 @@ public:
                        bool ignore_lock, bool create, bool force) override;
     void session_end() override;
     void load(QofBook* book, QofBackendLoadType loadType) override;
-    /* The XML backend isn't able to do anything with individual instances. */
+    /* The XML backend only notes which transactions have changed, for the
+     * journal. */
+    void commit(QofInstance* instance) override;
     void export_coa(QofBook*) override;
     void sync(QofBook* book) override;
     void safe_sync(QofBook* book) override { sync(book); } // XML sync is inherently safe.
@@ -52,6 +56,9 @@ private:
     bool link_or_make_backup(const std::string& orig, const std::string& bkup);
     bool backup_file();
     bool write_to_file(bool make_backup);
+    bool append_to_journal();
+    void replay_journal();
+    void reset_journal();
     void remove_old_files();
     void write_accounts(QofBook* book);
     bool check_path(const char* fullpath, bool create);
@@ -61,6 +68,22 @@ private:
     std::string m_linkfile;
     int m_lockfd;
 
+    /* With GNC_XML_JOURNAL set to a number of records, saves append the
+     * transactions changed since the last one to a journal beside the data
+     * file, which is written in full again once the journal would hold more
+     * than that, or something other than transactions has changed, or the
+     * session ends. */
+    std::string m_journal;
+    unsigned int m_journal_max = 0;
+    unsigned int m_journal_records = 0;
+    /** The data file on disk is the one loaded or last written. */
+    bool m_journal_ok = false;
+    bool m_full_save_needed = false;
+    bool m_loading = false;
+    /** The transactions committed since the last save, in order. */
+    std::vector<GncGUID> m_changed_tx;
+    std::unordered_set<std::string> m_changed_tx_set;
+
     QofBook* m_book;  /* The primary, main open book */
 };
 #endif // __GNC_XML_BACKEND_HPP__
@@ -64,6 +64,18 @@ sixtp* gnc_budget_sixtp_parser_create (void);
 
 xmlNodePtr gnc_transaction_dom_tree_create (Transaction* txn);
 sixtp* gnc_transaction_sixtp_parser_create (void);
+/* Reads the same input as gnc_transaction_sixtp_parser_create without
+ * building a DOM tree for each transaction. */
+sixtp* gnc_transaction_stream_sixtp_parser_create (void);
+/* With a pipeline in its gxpf_data the streaming parser converts the
+ * transactions' text on other threads.  They are built and passed to
+ * the callback in file order, but only once a batch is ready, so flush
+ * the pipeline before anything that may look one of them up.  Flushing
+ * returns FALSE if a transaction was bad. */
+typedef struct gnc_trn_pipeline gnc_trn_pipeline;
+gnc_trn_pipeline* gnc_trn_pipeline_new (void);
+gboolean gnc_trn_pipeline_flush (gnc_trn_pipeline* pipeline);
+void gnc_trn_pipeline_destroy (gnc_trn_pipeline* pipeline);
 
 sixtp* gnc_template_transaction_sixtp_parser_create (void);
 
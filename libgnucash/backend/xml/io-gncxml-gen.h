@@ -34,11 +34,16 @@ extern "C"
 typedef gboolean (*gxpf_callback) (const char* tag, gpointer parsedata,
                                    gpointer data);
 
+typedef struct gnc_trn_pipeline gnc_trn_pipeline;
+
 struct gxpf_data_struct
 {
     gxpf_callback cb;
     gpointer parsedata;
     gpointer bookdata;
+    /* If set, the streaming transaction parser hands its transactions
+     * to this instead of building them at once. */
+    gnc_trn_pipeline* pipeline;
 };
 
 typedef struct gxpf_data_struct gxpf_data;
@@ -72,6 +72,7 @@ extern "C"
 #include "gnc-xml.h"
 #include "io-utils.h"
 #include "sixtp-dom-parsers.h"
+#include "sixtp-dom-generators.h"
 #include "io-gncxml-v2.h"
 #include "io-gncxml-gen.h"
 
@@ -117,6 +118,7 @@ gnc_xml_register_backend(GncXmlDataType_t& xmlbe)
 }
 
 #define GNC_V2_STRING "gnc-v2"
+#define GNC_JOURNAL_STRING "gnc-journal"
 /* non-static because they are used in sixtp.c */
 const gchar* gnc_v2_xml_version_string = GNC_V2_STRING;
 extern const gchar*
@@ -474,6 +476,16 @@ gnc_counter_sixtp_parser_create (void)
     return sixtp_dom_parser_new (gnc_counter_end_handler, NULL, NULL);
 }
 
+/* Transactions are read straight from the parser events unless
+ * GNC_XML_DOM_LOAD is set, which selects the older DOM parser. */
+static sixtp*
+gnc_load_transaction_sixtp_parser_create (void)
+{
+    if (g_getenv ("GNC_XML_DOM_LOAD") != NULL)
+        return gnc_transaction_sixtp_parser_create ();
+    return gnc_transaction_stream_sixtp_parser_create ();
+}
+
 static void
 debug_print_counter_data (load_counter* data)
 {
@@ -563,6 +575,26 @@ add_item (const GncXmlDataType_t& data, struct file_backend* be_data)
     }
 }
 
+/* Transactions come out of the load pipeline in batches.  Invoices,
+ * lots and the like refer to them, so anything else in the book waits
+ * until those read so far are in. */
+static gboolean
+gnc_load_before_child_handler (gpointer data_for_children,
+                               GSList* data_from_children,
+                               GSList* sibling_data,
+                               gpointer parent_data,
+                               gpointer global_data,
+                               gpointer* result,
+                               const gchar* tag,
+                               const gchar* child_tag)
+{
+    gxpf_data* gdata = (gxpf_data*)global_data;
+
+    if (gdata->pipeline && g_strcmp0 (child_tag, TRANSACTION_TAG) != 0)
+        return gnc_trn_pipeline_flush (gdata->pipeline);
+    return TRUE;
+}
+
 static gboolean
 book_callback (const char* tag, gpointer globaldata, gpointer data)
 {
@@ -703,6 +735,8 @@ qof_session_load_from_xml_file_v2_full (
     sixtp* main_parser;
     sixtp* book_parser;
     struct file_backend be_data;
+    gxpf_data gpdata;
+    gpointer parse_result = NULL;
     gboolean retval;
     char* v2type = NULL;
 
@@ -738,7 +772,7 @@ qof_session_load_from_xml_file_v2_full (
             PRICEDB_TAG, gnc_pricedb_sixtp_parser_create (),
             COMMODITY_TAG, gnc_commodity_sixtp_parser_create (),
             ACCOUNT_TAG, gnc_account_sixtp_parser_create (),
-            TRANSACTION_TAG, gnc_transaction_sixtp_parser_create (),
+            TRANSACTION_TAG, gnc_load_transaction_sixtp_parser_create (),
             SCHEDXACTION_TAG, gnc_schedXaction_sixtp_parser_create (),
             TEMPLATE_TRANSACTION_TAG, gnc_template_transaction_sixtp_parser_create (),
             NULL, NULL))
@@ -755,7 +789,7 @@ qof_session_load_from_xml_file_v2_full (
             COMMODITY_TAG, gnc_commodity_sixtp_parser_create (),
             ACCOUNT_TAG, gnc_account_sixtp_parser_create (),
             BUDGET_TAG, gnc_budget_sixtp_parser_create (),
-            TRANSACTION_TAG, gnc_transaction_sixtp_parser_create (),
+            TRANSACTION_TAG, gnc_load_transaction_sixtp_parser_create (),
             SCHEDXACTION_TAG, gnc_schedXaction_sixtp_parser_create (),
             TEMPLATE_TRANSACTION_TAG, gnc_template_transaction_sixtp_parser_create (),
             NULL, NULL))
@@ -763,6 +797,9 @@ qof_session_load_from_xml_file_v2_full (
         goto bail;
     }
 
+    sixtp_set_before_child (main_parser, gnc_load_before_child_handler);
+    sixtp_set_before_child (book_parser, gnc_load_before_child_handler);
+
     be_data.ok = TRUE;
     be_data.parser = book_parser;
     for (auto data : backend_registry)
@@ -774,15 +811,15 @@ qof_session_load_from_xml_file_v2_full (
     xaccLogDisable ();
     xaccDisableDataScrubbing ();
 
+    gpdata.cb = generic_callback;
+    gpdata.parsedata = gd;
+    gpdata.bookdata = book;
+    gpdata.pipeline = NULL;
+    if (g_getenv ("GNC_XML_DOM_LOAD") == NULL)
+        gpdata.pipeline = gnc_trn_pipeline_new ();
+
     if (push_handler)
     {
-        gpointer parse_result = NULL;
-        gxpf_data gpdata;
-
-        gpdata.cb = generic_callback;
-        gpdata.parsedata = gd;
-        gpdata.bookdata = book;
-
         retval = sixtp_parse_push (top_parser, push_handler, push_user_data,
                                    NULL, &gpdata, &parse_result);
     }
@@ -805,14 +842,22 @@ qof_session_load_from_xml_file_v2_full (
         }
         else
         {
-            retval = gnc_xml_parse_fd (top_parser, file,
-                                       generic_callback, gd, book);
+            retval = sixtp_parse_fd (top_parser, file,
+                                     NULL, &gpdata, &parse_result);
             fclose (file);
             if (is_compressed)
                 wait_for_gzip (file);
         }
     }
 
+    if (gpdata.pipeline)
+    {
+        /* A failed load drops the batches still queued. */
+        if (retval)
+            retval = gnc_trn_pipeline_flush (gpdata.pipeline);
+        gnc_trn_pipeline_destroy (gpdata.pipeline);
+    }
+
     if (!retval)
     {
         sixtp_destroy (top_parser);
@@ -1642,6 +1687,183 @@ gnc_book_write_to_xml_file_v2 (
     return success;
 }
 
+/***********************************************************************/
+/* The journal holds the transactions saved since the data file was last
+ * written, each in full, or the GUID of each one that was deleted, in the
+ * order they were saved. Saves only ever append to it, so it never gets
+ * its closing tag; gnc_book_replay_xml_journal_v2() adds that. */
+
+static const char* JOURNAL_DELETED_TAG = "journal:deleted";
+
+static gboolean
+write_journal_header (FILE* out)
+{
+    return fprintf (out, "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n") >= 0
+           && fprintf (out, "<" GNC_JOURNAL_STRING) >= 0
+           && gnc_xml2_write_namespace_decl (out, "gnc")
+           && gnc_xml2_write_namespace_decl (out, "cmdty")
+           && gnc_xml2_write_namespace_decl (out, "slot")
+           && gnc_xml2_write_namespace_decl (out, "split")
+           && gnc_xml2_write_namespace_decl (out, "trn")
+           && gnc_xml2_write_namespace_decl (out, "ts")
+           && gnc_xml2_write_namespace_decl (out, "journal")
+           && fprintf (out, ">\n") >= 0;
+}
+
+gboolean
+gnc_book_append_to_xml_journal_v2 (QofBook* book, const char* filename,
+                                   const std::vector<GncGUID>& guids)
+{
+    GStatBuf statbuf;
+    auto is_new = g_stat (filename, &statbuf) != 0;
+    auto out = g_fopen (filename, "a");
+    if (out == NULL)
+        return FALSE;
+
+    auto success = !is_new || write_journal_header (out);
+    for (auto& guid : guids)
+    {
+        if (!success)
+            break;
+        auto trn = xaccTransLookup (&guid, book);
+        xmlNodePtr node;
+        if (trn != NULL && !qof_instance_get_destroying (trn))
+            node = gnc_transaction_dom_tree_create (trn);
+        else
+            node = guid_to_dom_tree (JOURNAL_DELETED_TAG, &guid);
+        xmlElemDump (out, NULL, node);
+        xmlFreeNode (node);
+        success = !ferror (out) && fprintf (out, "\n") >= 0;
+    }
+
+    if (fclose (out))
+        success = FALSE;
+    return success;
+}
+
+static void
+journal_remove_transaction (QofBook* book, const GncGUID* guid)
+{
+    auto trn = xaccTransLookup (guid, book);
+    if (trn == NULL)
+        return;
+    xaccTransBeginEdit (trn);
+    xaccTransDestroy (trn);
+    xaccTransCommitEdit (trn);
+}
+
+static GncGUID*
+journal_transaction_guid (xmlNodePtr tree)
+{
+    for (auto node = tree->xmlChildrenNode; node; node = node->next)
+        if (g_strcmp0 ((char*)node->name, "trn:id") == 0)
+            return dom_tree_to_guid (node);
+    return NULL;
+}
+
+struct journal_replay
+{
+    sixtp_gdv2* gd;
+    gint records;
+};
+
+static gboolean
+journal_record_end_handler (gpointer data_for_children,
+                            GSList* data_from_children, GSList* sibling_data,
+                            gpointer parent_data, gpointer global_data,
+                            gpointer* result, const gchar* tag)
+{
+    xmlNodePtr tree = (xmlNodePtr)data_for_children;
+    gxpf_data* gdata = (gxpf_data*)global_data;
+    auto replay = static_cast<journal_replay*>(gdata->parsedata);
+    sixtp_gdv2* gd = replay->gd;
+
+    if (parent_data || !tag)
+        return TRUE;
+
+    g_return_val_if_fail (tree, FALSE);
+
+    /* A saved transaction replaces the one loaded from the data file, which
+     * must go first as the new one takes its GUID. */
+    auto is_deleted = g_strcmp0 (tag, JOURNAL_DELETED_TAG) == 0;
+    auto guid = is_deleted ? dom_tree_to_guid (tree) :
+                journal_transaction_guid (tree);
+    auto successful = guid != NULL;
+    if (successful)
+    {
+        journal_remove_transaction (gd->book, guid);
+        guid_free (guid);
+    }
+    if (successful && !is_deleted)
+    {
+        auto trn = dom_tree_to_transaction (tree, gd->book);
+        successful = trn != NULL;
+        if (successful)
+            add_transaction_local (gd, trn);
+    }
+    if (successful)
+        replay->records++;
+
+    xmlFreeNode (tree);
+    return successful;
+}
+
+gint
+gnc_book_replay_xml_journal_v2 (QofBook* book, const char* filename)
+{
+    gchar* contents;
+    gsize length;
+    if (!g_file_get_contents (filename, &contents, &length, NULL))
+        return -1;
+
+    auto top_parser = sixtp_new ();
+    auto journal_parser = sixtp_new ();
+    if (!sixtp_add_some_sub_parsers (
+            top_parser, TRUE,
+            GNC_JOURNAL_STRING, journal_parser,
+            NULL, NULL)
+        || !sixtp_add_some_sub_parsers (
+            journal_parser, TRUE,
+            TRANSACTION_TAG, sixtp_dom_parser_new (journal_record_end_handler,
+                                                   NULL, NULL),
+            JOURNAL_DELETED_TAG, sixtp_dom_parser_new (journal_record_end_handler,
+                                                       NULL, NULL),
+            NULL, NULL))
+    {
+        g_free (contents);
+        return -1;
+    }
+
+    /* A save that was cut short leaves the last record incomplete; the ones
+     * before it are replayed all the same. */
+    std::string journal {contents, length};
+    g_free (contents);
+    journal += "</" GNC_JOURNAL_STRING ">\n";
+
+    journal_replay replay {gnc_sixtp_gdv2_new (book, FALSE, NULL, NULL), 0};
+    gxpf_data gpdata;
+    gpdata.cb = NULL;
+    gpdata.parsedata = &replay;
+    gpdata.bookdata = book;
+    gpdata.pipeline = NULL;
+    gpointer parse_result = NULL;
+
+    xaccLogDisable ();
+    auto retval = sixtp_parse_buffer (top_parser, &journal[0], journal.size(),
+                                      NULL, &gpdata, &parse_result);
+    xaccLogEnable ();
+
+    sixtp_destroy (top_parser);
+    g_free (replay.gd);
+    if (!retval)
+    {
+        PWARN ("Journal %s is incomplete after %d records", filename,
+               replay.records);
+        return -1;
+    }
+    return replay.records;
+}
+
 /*
  * Have to pass in the backend as this routine needs the temporary
  * backend for file export, not the real backend which could be
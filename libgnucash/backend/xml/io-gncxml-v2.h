@@ -93,6 +93,16 @@ gboolean gnc_book_write_to_xml_filehandle_v2 (QofBook* book, FILE* fh);
 gboolean gnc_book_write_to_xml_file_v2 (QofBook* book, const char* filename,
                                         gboolean compress);
 
+/** Append the transactions with these GUIDs to the journal of a data file,
+ * starting it if need be; those no longer in the book are recorded as
+ * deleted. */
+gboolean gnc_book_append_to_xml_journal_v2 (QofBook* book, const char* filename,
+                                            const std::vector<GncGUID>& guids);
+/** Apply a journal to the book just loaded from its data file.
+ * @return The number of records replayed, or -1 if the journal couldn't be
+ * read to its end. */
+gint gnc_book_replay_xml_journal_v2 (QofBook* book, const char* filename);
+
 /** write just the commodities and accounts to a file */
 gboolean gnc_book_write_accounts_to_xml_filehandle_v2 (QofBackend* be,
                                                        QofBook* book, FILE* fh);
@@ -406,6 +406,7 @@ static gboolean
 dom_tree_to_kvp_frame_given (xmlNodePtr node, KvpFrame* frame)
 {
     xmlNodePtr mark;
+    gboolean successful = TRUE;
 
     g_return_val_if_fail (node, FALSE);
     g_return_val_if_fail (frame, FALSE);
@@ -444,14 +445,17 @@ dom_tree_to_kvp_frame_given (xmlNodePtr node, KvpFrame* frame)
                 }
                 else
                 {
-                    /* FIXME: should put some error here */
+                    /* Keep the slots that did parse, but let the caller
+                     * know that the frame isn't complete. */
+                    PERR ("Bad value for slot %s", key);
+                    successful = FALSE;
                 }
                 g_free (key);
             }
         }
     }
 
-    return TRUE;
+    return successful;
 }
 
 
@@ -841,14 +845,19 @@ dom_tree_handlers_all_gotten_p (struct dom_tree_handler* handlers)
 
 static inline gboolean
 gnc_xml_set_data (const gchar* tag, xmlNodePtr node, gpointer item,
-                  struct dom_tree_handler* handlers)
+                  struct dom_tree_handler* handlers, gboolean strict)
 {
     for (; handlers->tag != NULL; handlers++)
     {
         if (g_strcmp0 (tag, handlers->tag) == 0)
         {
-            (handlers->handler) (node, item);
+            gboolean handled = (handlers->handler) (node, item);
             handlers->gotten = TRUE;
+            if (strict && !handled)
+            {
+                PERR ("Bad data for tag: %s", tag);
+                return FALSE;
+            }
             break;
         }
     }
@@ -863,9 +872,9 @@ gnc_xml_set_data (const gchar* tag, xmlNodePtr node, gpointer item,
     return TRUE;
 }
 
-gboolean
-dom_tree_generic_parse (xmlNodePtr node, struct dom_tree_handler* handlers,
-                        gpointer data)
+static gboolean
+dom_tree_parse (xmlNodePtr node, struct dom_tree_handler* handlers,
+                gpointer data, gboolean strict)
 {
     xmlNodePtr achild;
     gboolean successful = TRUE;
@@ -878,7 +887,8 @@ dom_tree_generic_parse (xmlNodePtr node, struct dom_tree_handler* handlers,
         if (g_strcmp0 ((char*)achild->name, "text") == 0)
             continue;
 
-        if (!gnc_xml_set_data ((char*)achild->name, achild, data, handlers))
+        if (!gnc_xml_set_data ((char*)achild->name, achild, data, handlers,
+                               strict))
         {
             PERR ("gnc_xml_set_data failed");
             successful = FALSE;
@@ -895,6 +905,20 @@ dom_tree_generic_parse (xmlNodePtr node, struct dom_tree_handler* handlers,
     return successful;
 }
 
+gboolean
+dom_tree_generic_parse (xmlNodePtr node, struct dom_tree_handler* handlers,
+                        gpointer data)
+{
+    return dom_tree_parse (node, handlers, data, FALSE);
+}
+
+gboolean
+dom_tree_strict_parse (xmlNodePtr node, struct dom_tree_handler* handlers,
+                       gpointer data)
+{
+    return dom_tree_parse (node, handlers, data, TRUE);
+}
+
 gboolean
 dom_tree_valid_timespec (Timespec* ts, const xmlChar* name)
 {
@@ -75,5 +75,10 @@ struct dom_tree_handler
 gboolean dom_tree_generic_parse (xmlNodePtr node,
                                  struct dom_tree_handler* handlers,
                                  gpointer data);
+/* Like dom_tree_generic_parse, but a handler that returns FALSE also
+ * fails the parse. */
+gboolean dom_tree_strict_parse (xmlNodePtr node,
+                                struct dom_tree_handler* handlers,
+                                gpointer data);
 
 #endif /* _SIXTP_DOM_PARSERS_H_ */
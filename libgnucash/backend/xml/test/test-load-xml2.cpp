@@ -39,11 +39,16 @@ extern "C"
 #include <glib.h>
 #include <glib-object.h>
 #include <glib/gstdio.h>
+#ifndef G_OS_WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
 
 #include <cashobjects.h>
 #include <TransLog.h>
 #include <gnc-engine.h>
 #include <gnc-prefs.h>
+#include <Transaction.h>
 
 #include <unittest-support.h>
 #include <test-engine-stuff.h>
@@ -118,6 +123,153 @@ test_load_file (const char* filename)
     qof_session_end (session);
 }
 
+/* Save a generated book, change and delete a transaction and save again:
+ * the second save must only go to the journal, which another session must
+ * replay, and ending the session must fold it into the data file. */
+static void
+test_journal (void)
+{
+    gchar* filename = g_strdup_printf ("%s/test-load-xml2-journal-%d.gnucash",
+                                       g_get_tmp_dir (), (int) getpid ());
+    gchar* journal = g_strdup_printf ("%s.journal", filename);
+    g_setenv ("GNC_XML_JOURNAL", "100", TRUE);
+
+    QofSession* session = qof_session_new ();
+    qof_session_begin (session, filename, FALSE, TRUE, TRUE);
+    QofBook* book = qof_session_get_book (session);
+    get_random_account_tree (book);
+    add_random_transactions_to_book (book, 20);
+    qof_session_save (session, NULL);
+    do_test (qof_session_get_error (session) == ERR_BACKEND_NO_ERR,
+             "journal full save");
+    do_test (!g_file_test (journal, G_FILE_TEST_EXISTS),
+             "no journal after a full save");
+
+    GList* transactions = NULL;
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_TRANS),
+                            [](QofInstance* inst, gpointer data)
+                            {
+                                auto list = static_cast<GList**>(data);
+                                *list = g_list_prepend (*list, inst);
+                            }, &transactions);
+    do_test (g_list_length (transactions) >= 2, "journal transactions");
+    auto changed = GNC_TRANSACTION (transactions->data);
+    auto deleted = GNC_TRANSACTION (transactions->next->data);
+    GncGUID changed_guid = *qof_instance_get_guid (changed);
+    GncGUID deleted_guid = *qof_instance_get_guid (deleted);
+    g_list_free (transactions);
+
+    xaccTransBeginEdit (changed);
+    xaccTransSetDescription (changed, "Journaled");
+    xaccTransCommitEdit (changed);
+    xaccTransBeginEdit (deleted);
+    xaccTransDestroy (deleted);
+    xaccTransCommitEdit (deleted);
+    qof_session_save (session, NULL);
+    do_test (qof_session_get_error (session) == ERR_BACKEND_NO_ERR,
+             "journal save");
+    do_test (g_file_test (journal, G_FILE_TEST_EXISTS),
+             "journal written by the second save");
+
+    QofSession* session_2 = qof_session_new ();
+    qof_session_begin (session_2, filename, TRUE, FALSE, FALSE);
+    qof_session_load (session_2, NULL);
+    do_test (qof_session_get_error (session_2) == ERR_BACKEND_NO_ERR,
+             "journal load");
+    QofBook* book_2 = qof_session_get_book (session_2);
+    auto replayed = xaccTransLookup (&changed_guid, book_2);
+    do_test (replayed != NULL &&
+             g_strcmp0 (xaccTransGetDescription (replayed), "Journaled") == 0,
+             "changed transaction replayed");
+    do_test (xaccTransLookup (&deleted_guid, book_2) == NULL,
+             "deleted transaction replayed");
+    do_test (qof_collection_count (qof_book_get_collection (book_2, GNC_ID_TRANS)) ==
+             qof_collection_count (qof_book_get_collection (book, GNC_ID_TRANS)),
+             "journal transaction count");
+    qof_session_destroy (session_2);
+
+    qof_session_end (session);
+    qof_session_destroy (session);
+    do_test (!g_file_test (journal, G_FILE_TEST_EXISTS),
+             "journal folded into the data file at the end of the session");
+
+    g_unsetenv ("GNC_XML_JOURNAL");
+    remove_locks (filename);
+    g_unlink (filename);
+    g_free (journal);
+    g_free (filename);
+}
+
+#ifndef G_OS_WIN32
+/* Load filename in a child process, with the DOM transaction parser if
+ * dom is set, and report the time and the child's peak resident size. */
+static void
+benchmark_load_file (const char* filename, gboolean dom)
+{
+    GTimer* timer = g_timer_new ();
+    struct rusage usage;
+    int status = 0;
+    pid_t pid;
+
+    pid = fork ();
+    if (pid == 0)
+    {
+        QofSession* session = qof_session_new ();
+
+        if (dom)
+            g_setenv ("GNC_XML_DOM_LOAD", "1", TRUE);
+        qof_session_begin (session, filename, TRUE, FALSE, FALSE);
+        qof_session_load (session, NULL);
+        _exit (qof_session_get_error (session) == ERR_BACKEND_NO_ERR ? 0 : 1);
+    }
+    if (pid < 0 || wait4 (pid, &status, 0, &usage) != pid)
+    {
+        failure ("benchmark load process failed");
+        g_timer_destroy (timer);
+        return;
+    }
+
+    do_test_args (WIFEXITED (status) && WEXITSTATUS (status) == 0,
+                  "benchmark load", __FILE__, __LINE__,
+                  "%s parser failed to load [%s]", dom ? "DOM" : "streaming",
+                  filename);
+    g_print ("%-9s transaction parser: %.3f s, peak RSS %ld kB\n",
+             dom ? "DOM" : "streaming", g_timer_elapsed (timer, NULL),
+             usage.ru_maxrss);
+    g_timer_destroy (timer);
+}
+
+/* Save a generated book with num_transactions transactions and time
+ * loading it with each of the transaction parsers. */
+static void
+benchmark_generated_book (int num_transactions)
+{
+    gchar* filename = g_strdup_printf ("%s/test-load-xml2-%d.gnucash",
+                                       g_get_tmp_dir (), (int) getpid ());
+    QofSession* session = qof_session_new ();
+    QofBook* book;
+
+    qof_session_begin (session, filename, FALSE, TRUE, TRUE);
+    book = qof_session_get_book (session);
+    get_random_account_tree (book);
+    get_random_pricedb (book);
+    add_random_transactions_to_book (book, num_transactions);
+    qof_session_save (session, NULL);
+    do_test (qof_session_get_error (session) == ERR_BACKEND_NO_ERR,
+             "benchmark book save");
+    qof_session_end (session);
+    qof_session_destroy (session);
+
+    g_print ("Loading a generated book of %d transactions\n", num_transactions);
+    benchmark_load_file (filename, FALSE);
+    benchmark_load_file (filename, TRUE);
+
+    remove_locks (filename);
+    g_unlink (filename);
+    g_free (filename);
+}
+#endif
+
 int
 main (int argc, char** argv)
 {
@@ -168,6 +320,15 @@ main (int argc, char** argv)
         failure ("handled 0 files in test-load-xml2");
     }
 
+    test_journal ();
+
+#ifndef G_OS_WIN32
+    /* Set GNC_XML_BENCHMARK to a number of transactions to compare the
+     * streaming and DOM transaction parsers on a book that size. */
+    if (const char* benchmark = g_getenv ("GNC_XML_BENCHMARK"))
+        benchmark_generated_book (atoi (benchmark));
+#endif
+
     print_test_results ();
     qof_close ();
     exit (get_rv ());
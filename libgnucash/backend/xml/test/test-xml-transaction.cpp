@@ -481,16 +481,52 @@ test_transaction (void)
             data.trn = ran_trn;
             data.com = com;
             data.value = i;
-            parser = gnc_transaction_sixtp_parser_create ();
 
-            if (!gnc_xml_parse_file (parser, filename1, test_add_transaction,
-                                     (gpointer)&data, book))
+            /* The DOM parser, the streaming parser and the streaming
+             * parser with a load pipeline must all read the same. */
+            for (int streaming = 0; streaming < 3; streaming++)
             {
-                failure_args ("gnc_xml_parse_file returned FALSE",
-                              __FILE__, __LINE__, "%d", i);
+                gboolean parsed;
+
+                if (streaming)
+                    parser = gnc_transaction_stream_sixtp_parser_create ();
+                else
+                    parser = gnc_transaction_sixtp_parser_create ();
+
+                data.new_trn = NULL;
+                if (streaming == 2)
+                {
+                    gxpf_data gpdata;
+                    gpointer parse_result = NULL;
+                    gnc_trn_pipeline* pipeline = gnc_trn_pipeline_new ();
+
+                    gpdata.cb = test_add_transaction;
+                    gpdata.parsedata = &data;
+                    gpdata.bookdata = book;
+                    gpdata.pipeline = pipeline;
+                    parsed = sixtp_parse_file (parser, filename1, NULL,
+                                               &gpdata, &parse_result);
+                    /* Nothing is built until the batch is flushed. */
+                    do_test (data.new_trn == NULL, "pipeline holds transaction");
+                    gnc_trn_pipeline_flush (pipeline);
+                    gnc_trn_pipeline_destroy (pipeline);
+                    parsed = parsed && data.new_trn != NULL;
+                }
+                else
+                    parsed = gnc_xml_parse_file (parser, filename1,
+                                                 test_add_transaction,
+                                                 (gpointer)&data, book);
+
+                if (!parsed)
+                {
+                    failure_args ("gnc_xml_parse_file returned FALSE",
+                                  __FILE__, __LINE__, "%d%s", i,
+                                  streaming == 2 ? " (pipeline)" :
+                                  streaming ? " (streaming)" : "");
+                }
+                else
+                    really_get_rid_of_transaction (data.new_trn);
             }
-            else
-                really_get_rid_of_transaction (data.new_trn);
         }
         /* no handling of circular data structures.  We'll do that later */
         /* sixtp_destroy(parser); */
@@ -503,6 +539,149 @@ test_transaction (void)
     }
 }
 
+#define BAD_TRN_ID "0a1b2c3d4e5f60718293a4b5c6d7e8f9"
+#define BAD_TRN_ACCOUNT_ID "1b2c3d4e5f60718293a4b5c6d7e8f90a"
+#define BAD_TRN_ACCOUNT \
+    "      <split:account type=\"guid\">" BAD_TRN_ACCOUNT_ID "</split:account>\n"
+#define BAD_TRN_DATE "2016-01-01 10:59:00 +0000"
+
+/* The id's type, the posted date, the slot's type and the split's
+ * account. */
+static const char* bad_trn_format =
+    "<gnc:transaction version=\"2.0.0\">\n"
+    "  <trn:id type=\"%s\">" BAD_TRN_ID "</trn:id>\n"
+    "  <trn:currency>\n"
+    "    <cmdty:space>ISO4217</cmdty:space>\n"
+    "    <cmdty:id>USD</cmdty:id>\n"
+    "  </trn:currency>\n"
+    "  <trn:date-posted><ts:date>%s</ts:date></trn:date-posted>\n"
+    "  <trn:date-entered><ts:date>" BAD_TRN_DATE "</ts:date></trn:date-entered>\n"
+    "  <trn:description>bad</trn:description>\n"
+    "  <trn:slots>\n"
+    "    <slot>\n"
+    "      <slot:key>notes</slot:key>\n"
+    "      <slot:value type=\"%s\">note</slot:value>\n"
+    "    </slot>\n"
+    "  </trn:slots>\n"
+    "  <trn:splits>\n"
+    "    <trn:split>\n"
+    "      <split:id type=\"guid\">2c3d4e5f60718293a4b5c6d7e8f90a1b</split:id>\n"
+    "      <split:reconciled-state>n</split:reconciled-state>\n"
+    "      <split:value>10/1</split:value>\n"
+    "      <split:quantity>10/1</split:quantity>\n"
+    "%s"
+    "    </trn:split>\n"
+    "  </trn:splits>\n"
+    "</gnc:transaction>\n";
+
+struct bad_trn_case
+{
+    const char* name;
+    gboolean good;
+    const char* id_type;
+    const char* date;
+    const char* slot_type;
+    const char* account;
+};
+
+static gboolean
+test_add_bad_transaction (const char* tag, gpointer globaldata, gpointer data)
+{
+    *static_cast<Transaction**> (globaldata) = static_cast<Transaction*> (data);
+    return TRUE;
+}
+
+static void
+test_bad_transaction (void)
+{
+    static const bad_trn_case cases[] =
+    {
+        { "good", TRUE, "guid", BAD_TRN_DATE, "string", BAD_TRN_ACCOUNT },
+        /* <split:account> is required. */
+        { "bad split", FALSE, "guid", BAD_TRN_DATE, "string", "" },
+        { "bad guid type", FALSE, "foo", BAD_TRN_DATE, "string",
+          BAD_TRN_ACCOUNT },
+        { "bad date", FALSE, "guid", "1970-01-01 00:00:00 +0000", "string",
+          BAD_TRN_ACCOUNT },
+        { "bad slot", FALSE, "guid", BAD_TRN_DATE, "nonsense",
+          BAD_TRN_ACCOUNT },
+    };
+    auto table = gnc_commodity_table_get_table (book);
+    auto usd = gnc_commodity_table_insert (table,
+                                           gnc_commodity_new (book, "US Dollar",
+                                                   "ISO4217", "USD", "USD",
+                                                   100));
+    GncGUID trn_guid, acc_guid;
+    Account* acc = xaccMallocAccount (book);
+
+    string_to_guid (BAD_TRN_ID, &trn_guid);
+    string_to_guid (BAD_TRN_ACCOUNT_ID, &acc_guid);
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetGUID (acc, &acc_guid);
+    xaccAccountSetCommodity (acc, usd);
+    xaccAccountCommitEdit (acc);
+
+    for (auto& c : cases)
+    {
+        gchar* filename = g_strdup ("test_file_XXXXXX");
+        int fd = g_mkstemp (filename);
+        gchar* xml = g_strdup_printf (bad_trn_format, c.id_type, c.date,
+                                      c.slot_type, c.account);
+
+        close (fd);
+        g_file_set_contents (filename, xml, -1, NULL);
+        g_free (xml);
+
+        /* Both parsers, and the pipeline, must take or reject it alike. */
+        for (int streaming = 0; streaming < 3; streaming++)
+        {
+            Transaction* trn = NULL;
+            gboolean parsed;
+            sixtp* parser = streaming ?
+                            gnc_transaction_stream_sixtp_parser_create () :
+                            gnc_transaction_sixtp_parser_create ();
+
+            if (streaming == 2)
+            {
+                gxpf_data gpdata;
+                gpointer parse_result = NULL;
+                gnc_trn_pipeline* pipeline = gnc_trn_pipeline_new ();
+
+                gpdata.cb = test_add_bad_transaction;
+                gpdata.parsedata = &trn;
+                gpdata.bookdata = book;
+                gpdata.pipeline = pipeline;
+                parsed = sixtp_parse_file (parser, filename, NULL,
+                                           &gpdata, &parse_result);
+                parsed = gnc_trn_pipeline_flush (pipeline) && parsed;
+                gnc_trn_pipeline_destroy (pipeline);
+            }
+            else
+                parsed = gnc_xml_parse_file (parser, filename,
+                                             test_add_bad_transaction,
+                                             &trn, book);
+
+            if (c.good)
+                do_test_args (parsed && trn != NULL, "bad_transaction_xml",
+                              __FILE__, __LINE__, "%s%s", c.name,
+                              streaming == 2 ? " (pipeline)" :
+                              streaming ? " (streaming)" : "");
+            else
+                do_test_args (!parsed && trn == NULL &&
+                              xaccTransLookup (&trn_guid, book) == NULL,
+                              "bad_transaction_xml", __FILE__, __LINE__,
+                              "%s%s", c.name,
+                              streaming == 2 ? " (pipeline)" :
+                              streaming ? " (streaming)" : "");
+            if (trn)
+                really_get_rid_of_transaction (trn);
+        }
+
+        g_unlink (filename);
+        g_free (filename);
+    }
+}
+
 static gboolean
 test_real_transaction (const char* tag, gpointer global_data, gpointer data)
 {
@@ -532,10 +711,14 @@ main (int argc, char** argv)
         test_files_in_dir (argc, argv, test_real_transaction,
                            gnc_transaction_sixtp_parser_create (),
                            "gnc:transaction", book);
+        test_files_in_dir (argc, argv, test_real_transaction,
+                           gnc_transaction_stream_sixtp_parser_create (),
+                           "gnc:transaction", book);
     }
     else
     {
         test_transaction ();
+        test_bad_transaction ();
     }
 
     print_test_results ();
@@ -42,8 +42,12 @@
 #include "qofinstance-p.h"
 #include "gnc-features.h"
 #include "guid.hpp"
+#include "qof-backend.hpp"
 
+#include <algorithm>
 #include <numeric>
+#include <unordered_map>
+#include <vector>
 
 static QofLogModule log_module = GNC_MOD_ACCOUNT;
 
@@ -62,6 +66,36 @@ using FinalProbabilityVec=std::vector<std::pair<std::string, int32_t>>;
 using ProbabilityVec=std::vector<std::pair<std::string, struct AccountProbability>>;
 using FlatKvpEntry=std::pair<std::string, KvpValue*>;
 
+/* The account's splits and, in parallel, their nodes in priv->splits.
+ * The vector is the real container; the GList is only maintained in
+ * step with it so that xaccAccountGetSplitList callers keep working. */
+struct AccountSplitVector
+{
+    std::vector<Split*> splits;
+    std::vector<GList*> nodes;
+    /* While balance_dirty is set, the first position whose running
+     * balance may be stale; 0 otherwise, so that a bare balance_dirty
+     * means recompute everything. */
+    size_t dirty_from = 0;
+    /* While sort_dirty is set, the splits that may be out of place.
+     * All the others are still in order unless full_sort is set. */
+    std::vector<Split*> moved;
+    bool full_sort = false;
+    /* The book's num-source option the splits were ordered under. */
+    bool action_for_num = false;
+};
+
+/* The posted dates of the splits in AccountSplitVector order as of the
+ * last xaccAccountRecomputeBalance. The running balances themselves
+ * are kept in the splits. */
+struct AccountBalanceIndex
+{
+    std::vector<time64> dates;
+    /* Position of the first date earlier than its predecessor, or
+     * SIZE_MAX if the dates are in order. */
+    size_t first_unsorted;
+};
+
 enum
 {
     LAST_SIGNAL
@@ -126,6 +160,8 @@ enum
 \********************************************************************/
 
 static void xaccAccountBringUpToDate (Account *acc);
+static void account_bayes_index_discard (AccountPrivate *priv);
+static void account_bayes_index_commit (AccountPrivate *priv);
 
 
 /********************************************************************\
@@ -280,7 +316,10 @@ gnc_account_init(Account* acc)
     priv->starting_cleared_balance = gnc_numeric_zero();
     priv->starting_reconciled_balance = gnc_numeric_zero();
     priv->balance_dirty = FALSE;
+    priv->balance_index = NULL;
+    priv->bayes_index = NULL;
 
+    priv->split_vector = new AccountSplitVector;
     priv->splits = NULL;
     priv->sort_dirty = FALSE;
 }
@@ -294,6 +333,12 @@ gnc_account_dispose (GObject *acctp)
 static void
 gnc_account_finalize(GObject* acctp)
 {
+    AccountPrivate *priv = GET_PRIVATE(acctp);
+    delete priv->balance_index;
+    priv->balance_index = nullptr;
+    account_bayes_index_discard (priv);
+    delete priv->split_vector;
+    priv->split_vector = nullptr;
     G_OBJECT_CLASS(gnc_account_parent_class)->finalize(acctp);
 }
 
@@ -1272,6 +1317,9 @@ xaccFreeAccount (Account *acc)
 
     priv->balance_dirty = FALSE;
     priv->sort_dirty = FALSE;
+    delete priv->balance_index;
+    priv->balance_index = nullptr;
+    account_bayes_index_discard (priv);
 
     /* qof_instance_release (&acc->inst); */
     g_object_unref(acc);
@@ -1334,6 +1382,7 @@ xaccAccountCommitEdit (Account *acc)
     /* If marked for deletion, get rid of subaccounts first,
      * and then the splits ... */
     priv = GET_PRIVATE(acc);
+    account_bayes_index_commit (priv);
     if (qof_instance_get_destroying(acc))
     {
         GList *lp, *slist;
@@ -1365,6 +1414,9 @@ xaccAccountCommitEdit (Account *acc)
         {
             g_list_free(priv->splits);
             priv->splits = NULL;
+            priv->split_vector->splits.clear();
+            priv->split_vector->nodes.clear();
+            priv->split_vector->moved.clear();
         }
 
         /* It turns out there's a case where this assertion does not hold:
@@ -1702,6 +1754,20 @@ gnc_account_set_sort_dirty (Account *acc)
 
     priv = GET_PRIVATE(acc);
     priv->sort_dirty = TRUE;
+    priv->split_vector->full_sort = true;
+}
+
+/* Mark the running balances from pos onward as needing recomputation. */
+static void
+account_balance_dirty_from (AccountPrivate *priv, size_t pos)
+{
+    auto vec = priv->split_vector;
+
+    if (!priv->balance_dirty)
+        vec->dirty_from = pos;
+    else
+        vec->dirty_from = std::min (vec->dirty_from, pos);
+    priv->balance_dirty = TRUE;
 }
 
 void
@@ -1715,43 +1781,164 @@ gnc_account_set_balance_dirty (Account *acc)
         return;
 
     priv = GET_PRIVATE(acc);
-    priv->balance_dirty = TRUE;
+    account_balance_dirty_from (priv, 0);
 }
 
 /********************************************************************\
 \********************************************************************/
 
+static bool
+split_order_less (const Split *a, const Split *b)
+{
+    return xaccSplitOrder (a, b) < 0;
+}
+
+/* Find s in the split vector. While the vector is sorted a binary
+ * search is authoritative; otherwise scan from the tail, where most
+ * edits happen. Returns the vector's size if s isn't there. */
+static size_t
+account_splits_find (const AccountPrivate *priv, const Split *s)
+{
+    auto& splits = priv->split_vector->splits;
+
+    if (!priv->sort_dirty)
+    {
+        auto iter = std::lower_bound (splits.begin(), splits.end(), s,
+                                      split_order_less);
+        if (iter != splits.end() && *iter == s)
+            return iter - splits.begin();
+        return splits.size();
+    }
+    auto riter = std::find (splits.rbegin(), splits.rend(), s);
+    return riter == splits.rend() ? splits.size() : splits.rend() - riter - 1;
+}
+
+/* Put node, whose data is a split, at pos in both the split vector and
+ * the GList. */
+static void
+account_splits_link_at (AccountPrivate *priv, size_t pos, GList *node)
+{
+    auto vec = priv->split_vector;
+
+    if (pos < vec->nodes.size())
+    {
+        GList *next = vec->nodes[pos];
+        node->next = next;
+        node->prev = next->prev;
+        if (next->prev)
+            next->prev->next = node;
+        else
+            priv->splits = node;
+        next->prev = node;
+    }
+    else if (!vec->nodes.empty())
+    {
+        node->prev = vec->nodes.back();
+        node->next = nullptr;
+        node->prev->next = node;
+    }
+    else
+    {
+        node->prev = node->next = nullptr;
+        priv->splits = node;
+    }
+
+    vec->splits.insert (vec->splits.begin() + pos, static_cast<Split*>(node->data));
+    vec->nodes.insert (vec->nodes.begin() + pos, node);
+}
+
+/* Take the split at pos out of both the split vector and the GList,
+ * returning its now unlinked node. */
+static GList*
+account_splits_unlink_at (AccountPrivate *priv, size_t pos)
+{
+    auto vec = priv->split_vector;
+    GList *node = vec->nodes[pos];
+
+    priv->splits = g_list_remove_link (priv->splits, node);
+    vec->splits.erase (vec->splits.begin() + pos);
+    vec->nodes.erase (vec->nodes.begin() + pos);
+    return node;
+}
+
+/* Record that s may be out of place while a re-sort is pending. Once
+ * a sizeable share of the splits has moved, a full sort is cheaper than
+ * finding each of them again, so stop keeping track. */
+static void
+account_splits_note_moved (AccountPrivate *priv, Split *s)
+{
+    auto vec = priv->split_vector;
+
+    if (vec->full_sort)
+        return;
+    if (vec->moved.size() >= vec->splits.size() / 16)
+    {
+        vec->moved.clear();
+        vec->full_sort = true;
+        return;
+    }
+    if (std::find (vec->moved.begin(), vec->moved.end(), s) == vec->moved.end())
+        vec->moved.push_back (s);
+}
+
+/* xaccSplitOrder sorts on the split action instead of the transaction
+ * num when the book says so, so flipping that option reorders splits
+ * without any of them changing. Notice it before relying on the order. */
+static void
+account_splits_check_num_source (Account *acc, AccountPrivate *priv)
+{
+    auto vec = priv->split_vector;
+    bool action_for_num =
+        qof_book_use_split_action_for_num_field (gnc_account_get_book (acc));
+
+    if (action_for_num == vec->action_for_num)
+        return;
+    vec->action_for_num = action_for_num;
+    if (vec->splits.empty())
+        return;
+    vec->moved.clear();
+    vec->full_sort = true;
+    priv->sort_dirty = TRUE;
+}
+
 gboolean
 gnc_account_insert_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
-    GList *node;
+    size_t pos;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
-    priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
-    if (node)
+    if (s->member_acc == acc)
         return FALSE;
 
-    if (qof_instance_get_editlevel(acc) == 0)
+    priv = GET_PRIVATE(acc);
+    account_splits_check_num_source (acc, priv);
+    auto& splits = priv->split_vector->splits;
+
+    /* If a re-sort is already pending there's no order to search; the
+     * sort will take care of the new split too. */
+    if (priv->sort_dirty)
     {
-        priv->splits = g_list_insert_sorted(priv->splits, s,
-                                            (GCompareFunc)xaccSplitOrder);
+        pos = splits.size();
+        account_splits_note_moved (priv, s);
     }
     else
-    {
-        priv->splits = g_list_prepend(priv->splits, s);
-        priv->sort_dirty = TRUE;
-    }
+        pos = std::upper_bound (splits.begin(), splits.end(), s,
+                                split_order_less) - splits.begin();
+
+    GList *node = g_list_alloc ();
+    node->data = s;
+    account_splits_link_at (priv, pos, node);
+    s->member_acc = acc;
 
     //FIXME: find better event
     qof_event_gen (&acc->inst, QOF_EVENT_MODIFY, NULL);
     /* Also send an event based on the account */
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_ADDED, s);
 
-    priv->balance_dirty = TRUE;
+    account_balance_dirty_from (priv, pos);
 //  DRH: Should the below be added? It is present in the delete path.
 //  xaccAccountRecomputeBalance(acc);
     return TRUE;
@@ -1761,27 +1948,174 @@ gboolean
 gnc_account_remove_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
-    GList *node;
+    size_t pos;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
-    if (NULL == node)
+    account_splits_check_num_source (acc, priv);
+    auto& splits = priv->split_vector->splits;
+    pos = account_splits_find (priv, s);
+    /* The split's sort key may have changed behind our back, e.g. when
+     * a field was assigned without its setter, so look harder before
+     * giving up. */
+    if (pos == splits.size())
+        pos = std::find (splits.begin(), splits.end(), s) - splits.begin();
+    if (pos == splits.size())
         return FALSE;
 
-    priv->splits = g_list_delete_link(priv->splits, node);
+    g_list_free_1 (account_splits_unlink_at (priv, pos));
+    if (s->member_acc == acc)
+        s->member_acc = NULL;
+    auto& moved = priv->split_vector->moved;
+    moved.erase (std::remove (moved.begin(), moved.end(), s), moved.end());
     //FIXME: find better event type
     qof_event_gen(&acc->inst, QOF_EVENT_MODIFY, NULL);
     // And send the account-based event, too
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_REMOVED, s);
 
-    priv->balance_dirty = TRUE;
+    account_balance_dirty_from (priv, pos);
     xaccAccountRecomputeBalance(acc);
     return TRUE;
 }
 
+void
+gnc_account_split_changed (Account *acc, Split *s)
+{
+    AccountPrivate *priv;
+    size_t pos;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    g_return_if_fail(GNC_IS_SPLIT(s));
+
+    if (qof_instance_get_destroying(acc))
+        return;
+    /* Not ours yet, e.g. a split whose account was set in an edit that
+     * hasn't been committed; inserting it will mark its place. */
+    if (s->member_acc != acc)
+        return;
+
+    priv = GET_PRIVATE(acc);
+    account_splits_check_num_source (acc, priv);
+    auto vec = priv->split_vector;
+    auto& splits = vec->splits;
+    pos = account_splits_find (priv, s);
+    /* A binary search misses a split whose sort key has just changed. */
+    if (pos == splits.size() && !priv->sort_dirty)
+    {
+        auto riter = std::find (splits.rbegin(), splits.rend(), s);
+        if (riter != splits.rend())
+            pos = splits.rend() - riter - 1;
+    }
+    if (pos == splits.size())
+        return;
+
+    if (priv->sort_dirty ||
+        (pos > 0 && !split_order_less (splits[pos - 1], s)) ||
+        (pos + 1 < splits.size() && !split_order_less (s, splits[pos + 1])))
+    {
+        account_splits_note_moved (priv, s);
+        priv->sort_dirty = TRUE;
+    }
+    account_balance_dirty_from (priv, pos);
+}
+
+static bool
+split_node_order_less (const GList *a, const GList *b)
+{
+    return split_order_less (static_cast<Split*>(a->data),
+                             static_cast<Split*>(b->data));
+}
+
+/* Restore the order of the split vector when there's no record of
+ * which splits moved. Usually only a handful are out of place, so pull
+ * those out and binary-insert them back instead of sorting everything.
+ * Returns the first position that changed, or the vector's size if
+ * nothing had to move. */
+static size_t
+account_splits_resort (AccountPrivate *priv)
+{
+    auto vec = priv->split_vector;
+    auto count = vec->nodes.size();
+    std::vector<GList*> kept, misplaced;
+
+    kept.reserve (count);
+    for (size_t i = 0; i < count; i++)
+    {
+        auto split = vec->splits[i];
+        if ((kept.empty() ||
+             !split_order_less (split, static_cast<Split*>(kept.back()->data))) &&
+            (i + 1 == count || !split_order_less (vec->splits[i + 1], split)))
+            kept.push_back (vec->nodes[i]);
+        else
+            misplaced.push_back (vec->nodes[i]);
+    }
+    if (misplaced.empty())
+        return count;
+
+    if (misplaced.size() > count / 16)
+    {
+        kept = vec->nodes;
+        std::stable_sort (kept.begin(), kept.end(), split_node_order_less);
+    }
+    else
+    {
+        for (auto node : misplaced)
+            kept.insert (std::upper_bound (kept.begin(), kept.end(), node,
+                                           split_node_order_less), node);
+    }
+
+    size_t first_changed = count;
+    GList *prev = nullptr;
+    for (size_t i = 0; i < count; i++)
+    {
+        GList *node = kept[i];
+        node->prev = prev;
+        node->next = nullptr;
+        if (prev)
+            prev->next = node;
+        prev = node;
+        if (first_changed == count && vec->nodes[i] != node)
+            first_changed = i;
+        vec->splits[i] = static_cast<Split*>(node->data);
+    }
+    vec->nodes = std::move (kept);
+    priv->splits = count ? vec->nodes.front() : nullptr;
+    return first_changed;
+}
+
+/* Put the splits recorded in moved back in their places. Everything
+ * else is still in order, so each is a binary-search insert. Returns
+ * the first position that changed, or the vector's size if none. */
+static size_t
+account_splits_resort_moved (AccountPrivate *priv)
+{
+    auto vec = priv->split_vector;
+    auto& splits = vec->splits;
+    size_t first_changed = splits.size();
+    std::vector<GList*> nodes;
+
+    for (auto s : vec->moved)
+    {
+        auto riter = std::find (splits.rbegin(), splits.rend(), s);
+        if (riter == splits.rend())
+            continue;
+        size_t pos = splits.rend() - riter - 1;
+        first_changed = std::min (first_changed, pos);
+        nodes.push_back (account_splits_unlink_at (priv, pos));
+    }
+    for (auto node : nodes)
+    {
+        size_t pos = std::upper_bound (splits.begin(), splits.end(),
+                                       static_cast<Split*>(node->data),
+                                       split_order_less) - splits.begin();
+        first_changed = std::min (first_changed, pos);
+        account_splits_link_at (priv, pos, node);
+    }
+    return std::min (first_changed, splits.size());
+}
+
 void
 xaccAccountSortSplits (Account *acc, gboolean force)
 {
@@ -1790,11 +2124,20 @@ xaccAccountSortSplits (Account *acc, gboolean force)
     g_return_if_fail(GNC_IS_ACCOUNT(acc));
 
     priv = GET_PRIVATE(acc);
+    account_splits_check_num_source (acc, priv);
     if (!priv->sort_dirty || (!force && qof_instance_get_editlevel(acc) > 0))
         return;
-    priv->splits = g_list_sort(priv->splits, (GCompareFunc)xaccSplitOrder);
+
+    /* Without a record of what moved (sort_dirty set directly), look at
+     * everything. */
+    auto vec = priv->split_vector;
+    size_t first_changed = vec->full_sort || vec->moved.empty() ?
+        account_splits_resort (priv) : account_splits_resort_moved (priv);
+    if (first_changed < vec->splits.size())
+        account_balance_dirty_from (priv, first_changed);
+    vec->moved.clear();
+    vec->full_sort = false;
     priv->sort_dirty = FALSE;
-    priv->balance_dirty = TRUE;
 }
 
 static void
@@ -2066,7 +2409,6 @@ xaccAccountRecomputeBalance (Account * acc)
     gnc_numeric  balance;
     gnc_numeric  cleared_balance;
     gnc_numeric  reconciled_balance;
-    GList *lp;
 
     if (NULL == acc) return;
 
@@ -2076,16 +2418,49 @@ xaccAccountRecomputeBalance (Account * acc)
     if (qof_instance_get_destroying(acc)) return;
     if (qof_book_shutting_down(qof_instance_get_book(acc))) return;
 
-    balance            = priv->starting_balance;
-    cleared_balance    = priv->starting_cleared_balance;
-    reconciled_balance = priv->starting_reconciled_balance;
+    if (!priv->balance_index)
+    {
+        priv->balance_index = new AccountBalanceIndex;
+        priv->balance_index->first_unsorted = SIZE_MAX;
+    }
+    auto& index = *priv->balance_index;
+    auto& splits = priv->split_vector->splits;
+
+    /* Everything before dirty_from is unchanged since the last pass,
+     * so pick up the running balances from there. */
+    size_t start = std::min (priv->split_vector->dirty_from, splits.size());
+    if (start > index.dates.size())
+        start = 0;
+    if (start > 0)
+    {
+        Split *prev = splits[start - 1];
+        balance            = prev->balance;
+        cleared_balance    = prev->cleared_balance;
+        reconciled_balance = prev->reconciled_balance;
+    }
+    else
+    {
+        balance            = priv->starting_balance;
+        cleared_balance    = priv->starting_cleared_balance;
+        reconciled_balance = priv->starting_reconciled_balance;
+    }
 
-    PINFO ("acct=%s starting baln=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT,
-           priv->accountName, balance.num, balance.denom);
-    for (lp = priv->splits; lp; lp = lp->next)
+    PINFO ("acct=%s from split %" G_GSIZE_FORMAT " of %" G_GSIZE_FORMAT
+           " baln=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT,
+           priv->accountName, start, splits.size(), balance.num, balance.denom);
+    index.dates.resize (start);
+    if (index.first_unsorted >= start)
+        index.first_unsorted = SIZE_MAX;
+    for (auto iter = splits.begin() + start; iter != splits.end(); ++iter)
     {
-        Split *split = (Split *) lp->data;
+        Split *split = *iter;
         gnc_numeric amt = xaccSplitGetAmount (split);
+        time64 date = xaccTransGetDate (split->parent);
+
+        if (!index.dates.empty() && date < index.dates.back() &&
+            index.first_unsorted == SIZE_MAX)
+            index.first_unsorted = index.dates.size();
+        index.dates.push_back (date);
 
         balance = gnc_numeric_add_fixed(balance, amt);
 
@@ -2111,6 +2486,7 @@ xaccAccountRecomputeBalance (Account * acc)
     priv->cleared_balance = cleared_balance;
     priv->reconciled_balance = reconciled_balance;
     priv->balance_dirty = FALSE;
+    priv->split_vector->dirty_from = 0;
 }
 
 /********************************************************************\
@@ -2225,7 +2601,8 @@ xaccAccountSetType (Account *acc, GNCAccountType tip)
 
     xaccAccountBeginEdit(acc);
     priv->type = tip;
-    priv->balance_dirty = TRUE; /* new type may affect balance computation */
+    /* new type may affect balance computation */
+    account_balance_dirty_from (priv, 0);
     mark_account(acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2407,7 +2784,8 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     }
 
     priv->sort_dirty = TRUE;  /* Not needed. */
-    priv->balance_dirty = TRUE;
+    priv->split_vector->full_sort = true;
+    account_balance_dirty_from (priv, 0);
     mark_account (acc);
 
     xaccAccountCommitEdit(acc);
@@ -3193,7 +3571,7 @@ gnc_account_set_start_balance (Account *acc, const gnc_numeric start_baln)
 
     priv = GET_PRIVATE(acc);
     priv->starting_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    account_balance_dirty_from (priv, 0);
 }
 
 void
@@ -3206,7 +3584,7 @@ gnc_account_set_start_cleared_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_cleared_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    account_balance_dirty_from (priv, 0);
 }
 
 void
@@ -3219,7 +3597,7 @@ gnc_account_set_start_reconciled_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_reconciled_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    account_balance_dirty_from (priv, 0);
 }
 
 gnc_numeric
@@ -3281,6 +3659,38 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
 /********************************************************************\
 \********************************************************************/
 
+/* Find the position in the balance index of the first split posted
+ * on or after date (or, if after_date is TRUE, strictly after date).
+ * Returns FALSE if the index is missing or stale, in which case the
+ * caller has to walk the split list instead. */
+static gboolean
+account_balance_index_find (const AccountPrivate *priv, time64 date,
+                            gboolean after_date, size_t *pos)
+{
+    if (!priv->balance_index || priv->balance_dirty ||
+        priv->balance_index->first_unsorted != SIZE_MAX)
+        return FALSE;
+
+    auto& dates = priv->balance_index->dates;
+    auto iter = after_date ?
+        std::upper_bound (dates.begin(), dates.end(), date) :
+        std::lower_bound (dates.begin(), dates.end(), date);
+    *pos = iter - dates.begin();
+    return TRUE;
+}
+
+/* Ask the book's backend to add up the account's splits between the
+ * bounds; see QofBackend::sum_split_amounts. */
+static gboolean
+account_sum_in_backend (const Account *acc, const std::vector<time64>& bounds,
+                        std::vector<gnc_numeric>& sums)
+{
+    auto be = qof_book_get_backend (gnc_account_get_book (acc));
+    return be != nullptr &&
+        be->sum_split_amounts (QOF_INSTANCE (acc), bounds, sums) &&
+        sums.size () == bounds.size ();
+}
+
 gnc_numeric
 xaccAccountGetBalanceAsOfDate (Account *acc, time64 date)
 {
@@ -3298,12 +3708,28 @@ xaccAccountGetBalanceAsOfDate (Account *acc, time64 date)
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
+    std::vector<gnc_numeric> sums;
+    if (account_sum_in_backend (acc, {date}, sums))
+        return sums[0];
+
     xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
     xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
 
     priv = GET_PRIVATE(acc);
     balance = priv->balance;
 
+    size_t pos;
+    if (account_balance_index_find (priv, date, FALSE, &pos))
+    {
+        auto& splits = priv->split_vector->splits;
+        if (pos == splits.size())
+            return balance;
+        /* AsOf date before any entries returns zero, as below. */
+        if (pos == 0)
+            return gnc_numeric_zero();
+        return xaccSplitGetBalance (splits[pos - 1]);
+    }
+
     /* Since transaction post times are stored as a Timespec,
      * convert date into a Timespec as well rather than converting
      * each transaction's Timespec into a time64.
@@ -3372,6 +3798,12 @@ xaccAccountGetPresentBalance (const Account *acc)
 
     priv = GET_PRIVATE(acc);
     today = gnc_time64_get_today_end();
+
+    size_t pos;
+    if (account_balance_index_find (priv, today, TRUE, &pos))
+        return pos ? xaccSplitGetBalance (priv->split_vector->splits[pos - 1])
+            : gnc_numeric_zero ();
+
     for (node = g_list_last(priv->splits); node; node = node->prev)
     {
         Split *split = static_cast<Split*>(node->data);
@@ -3690,11 +4122,48 @@ xaccAccountGetBalanceChangeForPeriod (Account *acc, time64 t1, time64 t2,
 {
     gnc_numeric b1, b2;
 
+    /* A backend that adds up the splits itself then answers with one
+     * query instead of two. */
+    if (!recurse && t1 <= t2 && xaccAccountGetCommodity (acc))
+    {
+        time64 dates[] = {t1, t2};
+        xaccAccountGetBalanceChangesForPeriods (acc, dates, 2, &b1);
+        return b1;
+    }
     b1 = xaccAccountGetBalanceAsOfDateInCurrency(acc, t1, NULL, recurse);
     b2 = xaccAccountGetBalanceAsOfDateInCurrency(acc, t2, NULL, recurse);
     return gnc_numeric_sub(b2, b1, GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
 }
 
+void
+xaccAccountGetBalanceChangesForPeriods (Account *acc, const time64 *dates,
+                                        int n_dates, gnc_numeric *changes)
+{
+    g_return_if_fail (GNC_IS_ACCOUNT(acc));
+    if (n_dates < 2)
+        return;
+    g_return_if_fail (dates != NULL && changes != NULL);
+
+    std::vector<time64> bounds (dates, dates + n_dates);
+    g_return_if_fail (std::is_sorted (bounds.begin (), bounds.end ()));
+
+    std::vector<gnc_numeric> sums;
+    if (account_sum_in_backend (acc, bounds, sums))
+    {
+        std::copy (sums.begin () + 1, sums.end (), changes);
+        return;
+    }
+
+    auto prev = xaccAccountGetBalanceAsOfDate (acc, dates[0]);
+    for (int ind = 1; ind < n_dates; ind++)
+    {
+        auto balance = xaccAccountGetBalanceAsOfDate (acc, dates[ind]);
+        changes[ind - 1] = gnc_numeric_sub (balance, prev, GNC_DENOM_AUTO,
+                                            GNC_HOW_DENOM_FIXED);
+        prev = balance;
+    }
+}
+
 
 /********************************************************************\
 \********************************************************************/
@@ -5187,16 +5656,88 @@ struct AccountInfo
     int32_t probability;
 };
 
+/* The account's import-map-bayes entries keyed by token, so that
+ * matching an imported transaction costs a hash lookup per token
+ * instead of a scan of the account's slots.  It is read from KVP the
+ * first time the account is matched against and kept in step by
+ * gnc_account_imap_add_account_bayes, which writes through to KVP.  Any
+ * other commit of the account may have changed the slots, so it drops
+ * the index and the next match reads it again. */
+struct AccountBayesIndex
+{
+    /* Within each token the accounts are in GUID string order, as they
+     * are in KVP, so that ties are broken as before. */
+    std::unordered_map<std::string, TokenAccountsInfo> tokens;
+    /* Set while gnc_account_imap_add_account_bayes commits the entries
+     * it has already applied here. */
+    bool updating = false;
+};
+
+static void
+account_bayes_index_discard (AccountPrivate *priv)
+{
+    delete priv->bayes_index;
+    priv->bayes_index = nullptr;
+}
+
 static void
-build_token_info(char const * key, KvpValue * value, TokenAccountsInfo & tokenInfo)
+account_bayes_index_commit (AccountPrivate *priv)
+{
+    if (priv->bayes_index && !priv->bayes_index->updating)
+        account_bayes_index_discard (priv);
+}
+
+static AccountBayesIndex &
+account_bayes_index (Account *acc)
 {
-    tokenInfo.total_count += value->get<int64_t>();
-    AccountTokenCount this_account;
-    std::string account_guid {key};
-    /*By convention, the key ends with the account GUID.*/
-    this_account.account_guid = account_guid.substr(account_guid.size() - GUID_ENCODING_LENGTH);
-    this_account.token_count = value->get<int64_t>();
-    tokenInfo.accounts.push_back(this_account);
+    auto priv = GET_PRIVATE (acc);
+    if (priv->bayes_index)
+        return *priv->bayes_index;
+
+    priv->bayes_index = new AccountBayesIndex;
+    auto& tokens = priv->bayes_index->tokens;
+    auto prefix_length = strlen (IMAP_FRAME_BAYES "/");
+    /* The slots come back in key order, so each token's accounts are
+     * appended in GUID order. */
+    for (auto const & slot : qof_instance_get_slots_prefix (QOF_INSTANCE (acc),
+                                                            IMAP_FRAME_BAYES "/"))
+    {
+        auto const & key = slot.first;
+        /* By convention, the key is <frame>/<token>/<account guid>. */
+        if (key.size () < prefix_length + 2 + GUID_ENCODING_LENGTH ||
+            slot.second->get_type () != KvpValue::Type::INT64)
+            continue;
+        auto token = key.substr (prefix_length,
+                                 key.size () - prefix_length - 1 - GUID_ENCODING_LENGTH);
+        auto count = slot.second->get<int64_t> ();
+        auto& info = tokens[token];
+        info.total_count += count;
+        info.accounts.push_back ({key.substr (key.size () - GUID_ENCODING_LENGTH), count});
+    }
+    return *priv->bayes_index;
+}
+
+/* Record that token now occurs count times for account_guid. */
+static void
+account_bayes_index_set (AccountBayesIndex & index, std::string const & token,
+                         std::string const & account_guid, int64_t count)
+{
+    auto& info = index.tokens[token];
+    auto item = std::lower_bound (info.accounts.begin (), info.accounts.end (),
+                                  account_guid, [] (AccountTokenCount const & a,
+                                                    std::string const & guid) {
+                                      return a.account_guid < guid;
+                                  });
+    if (item != info.accounts.end () && item->account_guid == account_guid)
+    {
+        info.total_count += count - item->token_count;
+        item->token_count = count;
+    }
+    else
+    {
+        info.total_count += count;
+        info.accounts.insert (item, {account_guid, count});
+    }
 }
 
 /** We scale the probability values by probability_factor.
@@ -5236,25 +5777,28 @@ static ProbabilityVec
 get_first_pass_probabilities(GncImportMatchMap * imap, GList * tokens)
 {
     ProbabilityVec ret;
+    std::unordered_map<std::string, size_t> positions;
+    auto const & index = account_bayes_index (imap->acc);
     /* find the probability for each account that contains any of the tokens
      * in the input tokens list. */
     for (auto current_token = tokens; current_token; current_token = current_token->next)
     {
-        TokenAccountsInfo tokenInfo{};
-        auto path = std::string{IMAP_FRAME_BAYES "/"} + static_cast <char const *> (current_token->data);
-        qof_instance_foreach_slot_prefix (QOF_INSTANCE (imap->acc), path, &build_token_info, tokenInfo);
+        if (!current_token->data)
+            continue;
+        auto found = index.tokens.find (static_cast <char const *> (current_token->data));
+        if (found == index.tokens.end ())
+            continue;
+        auto const & tokenInfo = found->second;
         for (auto const & current_account_token : tokenInfo.accounts)
         {
-            auto item = std::find_if(ret.begin(), ret.end(), [&current_account_token]
-                (std::pair<std::string, AccountProbability> const & a) {
-                    return current_account_token.account_guid == a.first;
-                });
-            if (item != ret.end())
+            auto item = positions.find (current_account_token.account_guid);
+            if (item != positions.end ())
             {/* This account is already in the map */
-                item->second.product = ((double)current_account_token.token_count /
-                                      (double)tokenInfo.total_count) * item->second.product;
-                item->second.product_difference = ((double)1 - ((double)current_account_token.token_count /
-                                              (double)tokenInfo.total_count)) * item->second.product_difference;
+                auto& probability = ret[item->second].second;
+                probability.product = ((double)current_account_token.token_count /
+                                      (double)tokenInfo.total_count) * probability.product;
+                probability.product_difference = ((double)1 - ((double)current_account_token.token_count /
+                                              (double)tokenInfo.total_count)) * probability.product_difference;
             }
             else
             {
@@ -5263,6 +5807,7 @@ get_first_pass_probabilities(GncImportMatchMap * imap, GList * tokens)
                 new_probability.product = ((double)current_account_token.token_count /
                                       (double)tokenInfo.total_count);
                 new_probability.product_difference = 1 - (new_probability.product);
+                positions.emplace (current_account_token.account_guid, ret.size ());
                 ret.push_back({current_account_token.account_guid, std::move(new_probability)});
             }
         } /* for all accounts in tokenInfo */
@@ -5367,6 +5912,7 @@ convert_imap_account_bayes_to_flat (Account *acc)
     if (!frame->get_keys().size())
         return false;
     auto new_imap = get_new_flat_imap(acc);
+    account_bayes_index_discard (GET_PRIVATE (acc));
     xaccAccountBeginEdit(acc);
     frame->set({IMAP_FRAME_BAYES}, nullptr);
     if (!new_imap.size ())
@@ -5454,7 +6000,7 @@ gnc_account_imap_find_account_bayes (GncImportMatchMap *imap, GList *tokens)
     return account;
 }
 
-static void
+static int64_t
 change_imap_entry (GncImportMatchMap *imap, std::string const & path, int64_t token_count)
 {
     GValue value = G_VALUE_INIT;
@@ -5486,6 +6032,7 @@ change_imap_entry (GncImportMatchMap *imap, std::string const & path, int64_t to
     // Add or Update the entry based on guid
     qof_instance_set_path_kvp (QOF_INSTANCE (imap->acc), &value, {path});
     gnc_features_set_used (imap->book, GNC_FEATURE_GUID_FLAT_BAYESIAN);
+    return token_count;
 }
 
 /** Updates the imap for a given account using a list of tokens */
@@ -5510,6 +6057,8 @@ gnc_account_imap_add_account_bayes (GncImportMatchMap *imap,
     g_return_if_fail (acc != NULL);
     account_fullname = gnc_account_get_full_name(acc);
     xaccAccountBeginEdit (imap->acc);
+    /* Only an index that has already been read needs to follow along. */
+    auto index = GET_PRIVATE (imap->acc)->bayes_index;
 
     PINFO("account name: '%s'", account_fullname);
 
@@ -5530,11 +6079,18 @@ gnc_account_imap_add_account_bayes (GncImportMatchMap *imap,
         PINFO("adding token '%s'", (char*)current_token->data);
         auto path = std::string {IMAP_FRAME_BAYES} + '/' + static_cast<char*>(current_token->data) + '/' + guid_string;
         /* change the imap entry for the account */
-        change_imap_entry (imap, path, token_count);
+        token_count = change_imap_entry (imap, path, token_count);
+        if (index)
+            account_bayes_index_set (*index, static_cast<char*>(current_token->data),
+                                     guid_string, token_count);
     }
     /* free up the account fullname and guid string */
     qof_instance_set_dirty (QOF_INSTANCE (imap->acc));
+    if (index)
+        index->updating = true;
     xaccAccountCommitEdit (imap->acc);
+    if (index)
+        index->updating = false;
     g_free (account_fullname);
     g_free (guid_string);
     LEAVE(" ");
@@ -5677,6 +6233,7 @@ gnc_account_delete_map_entry (Account *acc, char *full_category, gboolean empty)
     gchar *kvp_path = g_strdup (full_category);
     if ((acc != NULL) && qof_instance_has_slot (QOF_INSTANCE(acc), kvp_path))
     {
+        account_bayes_index_discard (GET_PRIVATE (acc));
         xaccAccountBeginEdit (acc);
         if (empty)
             qof_instance_slot_path_delete_if_empty (QOF_INSTANCE(acc), {kvp_path});
@@ -604,6 +604,15 @@ gnc_numeric xaccAccountGetBalanceAsOfDateInCurrency(
 gnc_numeric xaccAccountGetBalanceChangeForPeriod (
     Account *acc, time64 date1, time64 date2, gboolean recurse);
 
+/** Fill changes[i] with the change in the account's balance, not counting
+ * its children, from dates[i] up to dates[i + 1], for each of the
+ * n_dates - 1 periods; dates must be in ascending order. If the book's
+ * backend can sum the splits itself, as a SQL book that hasn't loaded the
+ * account's transactions does, this costs it a single query. */
+void xaccAccountGetBalanceChangesForPeriods (Account *acc,
+                                             const time64 *dates, int n_dates,
+                                             gnc_numeric *changes);
+
 /** @} */
 
 /** @name Account Children and Parents.
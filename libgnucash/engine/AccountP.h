@@ -47,6 +47,11 @@ extern "C" {
 
 #define GNC_ID_ROOT_ACCOUNT        "RootAccount"
 
+/* Opaque to C; defined in Account.cpp. */
+struct AccountBalanceIndex;
+struct AccountBayesIndex;
+struct AccountSplitVector;
+
 /** STRUCTS *********************************************************/
 
 /** This is the data that describes an account.
@@ -114,9 +119,24 @@ typedef struct AccountPrivate
 
     gboolean balance_dirty;     /* balances in splits incorrect */
 
-    GList *splits;              /* list of split pointers */
+    /* Date-posted index over the splits, rebuilt along with the
+     * running balances by xaccAccountRecomputeBalance so that as-of
+     * lookups can binary search instead of walking the split list.
+     * It is only consulted while balance_dirty is FALSE. */
+    struct AccountBalanceIndex *balance_index;
+
+    /* The splits, held contiguously in xaccSplitOrder order.  Inserts
+     * go straight to their place by binary search; only edits that
+     * change a split's sort key set sort_dirty. */
+    struct AccountSplitVector *split_vector;
+    GList *splits;              /* list of split pointers, same order */
     gboolean sort_dirty;        /* sort order of splits is bad */
 
+    /* The import-map-bayes counts by token, read from KVP on the first
+     * Bayesian match and dropped when the account is committed by
+     * anything but gnc_account_imap_add_account_bayes. */
+    struct AccountBayesIndex *bayes_index;
+
     LotList   *lots;		/* list of lot pointers */
     GNCPolicy *policy;		/* Cached pointer to policy method */
 
@@ -139,6 +159,13 @@ void xaccAccountSetGUID (Account *account, const GncGUID *guid);
 /* Register Accounts with the engine */
 gboolean xaccAccountRegister (void);
 
+/* Tell the account that split s has changed in a way that may move it
+ * in the sort order or change the running balances.  Only s (and the
+ * balances from its position onward) are invalidated, so the next
+ * xaccAccountSortSplits/xaccAccountRecomputeBalance does no more work
+ * than the change requires. */
+void gnc_account_split_changed (Account *acc, Split *s);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
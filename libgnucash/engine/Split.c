@@ -55,6 +55,7 @@
 #include "gnc-engine.h"
 #include "gnc-lot.h"
 #include "gnc-event.h"
+#include "gnc-query-index.h"
 #include "qofinstance-p.h"
 
 const char *void_former_amt_str = "void-former-amount";
@@ -502,6 +503,8 @@ xaccSplitReinit(Split * split)
 
     CACHE_REPLACE(split->action, "");
     CACHE_REPLACE(split->memo, "");
+    gnc_sort_key_clear (&split->action_key);
+    gnc_sort_key_clear (&split->memo_key);
     split->reconciled  = NREC;
     split->amount      = gnc_numeric_zero();
     split->value       = gnc_numeric_zero();
@@ -530,6 +533,7 @@ xaccMallocSplit(QofBook *book)
 
     split = g_object_new (GNC_TYPE_SPLIT, NULL);
     xaccInitSplit (split, book);
+    gnc_query_index_changed (QOF_INSTANCE (split));
 
     return split;
 }
@@ -602,6 +606,7 @@ xaccSplitCloneNoKvp (const Split *s)
 
     qof_instance_init_data(&split->inst, GNC_ID_SPLIT,
                            qof_instance_get_book(s));
+    gnc_query_index_changed (QOF_INSTANCE (split));
     xaccAccountInsertSplit(s->acc, split);
     if (s->lot)
     {
@@ -693,8 +698,11 @@ xaccFreeSplit (Split *split)
         PERR ("double-free %p", split);
         return;
     }
+    gnc_query_index_removed (QOF_INSTANCE (split));
     CACHE_REMOVE(split->memo);
     CACHE_REMOVE(split->action);
+    gnc_sort_key_clear (&split->memo_key);
+    gnc_sort_key_clear (&split->action_key);
 
     /* Just in case someone looks up freed memory ... */
     split->memo        = (char *) 1;
@@ -718,9 +726,10 @@ xaccFreeSplit (Split *split)
 
 void mark_split (Split *s)
 {
+    gnc_query_index_changed (QOF_INSTANCE (s));
     if (s->acc)
     {
-        g_object_set(s->acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        gnc_account_split_changed (s->acc, s);
     }
 
     /* set dirty flag on lot too. */
@@ -925,6 +934,7 @@ xaccSplitSetAccount (Split *s, Account *acc)
 
     s->acc = acc;
     qof_instance_set_dirty(QOF_INSTANCE(s));
+    gnc_query_index_changed (QOF_INSTANCE (s));
 
     if (trans)
         xaccTransCommitEdit(trans);
@@ -1001,13 +1011,14 @@ xaccSplitCommitEdit(Split *s)
        original and new transactions, for the _next_ begin/commit cycle. */
     s->orig_acc = s->acc;
     s->orig_parent = s->parent;
+    gnc_query_index_changed (QOF_INSTANCE (s));
     if (!qof_commit_edit_part2(QOF_INSTANCE(s), commit_err, NULL,
                                (void (*) (QofInstance *)) xaccFreeSplit))
         return;
 
     if (acc)
     {
-        g_object_set(acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        gnc_account_split_changed (acc, s);
         xaccAccountRecomputeBalance(acc);
     }
 }
@@ -1021,7 +1032,10 @@ xaccSplitRollbackEdit(Split *s)
        only because we don't emit events for changing accounts until
        the final commit. */
     if (s->acc != s->orig_acc)
+    {
         s->acc = s->orig_acc;
+        gnc_query_index_changed (QOF_INSTANCE (s));
+    }
 
     /* Undestroy if needed */
     if (qof_instance_get_destroying(s) && s->parent)
@@ -1461,12 +1475,55 @@ xaccSplitDestroy (Split *split)
 /********************************************************************\
 \********************************************************************/
 
+static void
+sort_key_check (GncSortKey *key, const char *str)
+{
+    if (key->src == str)
+        return;
+    g_free (key->collate);
+    key->collate = NULL;
+    key->have_num = FALSE;
+    key->src = str;
+}
+
+const char *
+gnc_sort_key_collate (GncSortKey *key, const char *str)
+{
+    sort_key_check (key, str);
+    if (!key->collate)
+        key->collate = g_utf8_collate_key (str ? str : "", -1);
+    return key->collate;
+}
+
+int
+gnc_sort_key_num (GncSortKey *key, const char *str)
+{
+    sort_key_check (key, str);
+    if (!key->have_num)
+    {
+        key->num = str ? atoi (str) : 0;
+        key->have_num = TRUE;
+    }
+    return key->num;
+}
+
+void
+gnc_sort_key_clear (GncSortKey *key)
+{
+    g_free (key->collate);
+    key->collate = NULL;
+    key->have_num = FALSE;
+    key->src = NULL;
+}
+
+/* Sorting only caches keys, so it may do so on const splits. */
+#define SPLIT_KEY(split, field) (&((Split*)(split))->field##_key)
+
 gint
 xaccSplitOrder (const Split *sa, const Split *sb)
 {
     int retval;
     int comp;
-    char *da, *db;
     gboolean action_for_num;
 
     if (sa == sb) return 0;
@@ -1478,24 +1535,23 @@ xaccSplitOrder (const Split *sa, const Split *sb)
      * according to book option */
     action_for_num = qof_book_use_split_action_for_num_field
         (xaccSplitGetBook (sa));
-    if (action_for_num)
-        retval = xaccTransOrder_num_action (sa->parent, sa->action,
-                                            sb->parent, sb->action);
+    if (action_for_num && sa->action && sb->action)
+        retval = xaccTransOrderNums
+            (sa->parent, gnc_sort_key_num (SPLIT_KEY (sa, action), sa->action),
+             sb->parent, gnc_sort_key_num (SPLIT_KEY (sb, action), sb->action));
     else
         retval = xaccTransOrder (sa->parent, sb->parent);
     if (retval) return retval;
 
     /* otherwise, sort on memo strings */
-    da = sa->memo ? sa->memo : "";
-    db = sb->memo ? sb->memo : "";
-    retval = g_utf8_collate (da, db);
+    retval = strcmp (gnc_sort_key_collate (SPLIT_KEY (sa, memo), sa->memo),
+                     gnc_sort_key_collate (SPLIT_KEY (sb, memo), sb->memo));
     if (retval)
         return retval;
 
     /* otherwise, sort on action strings */
-    da = sa->action ? sa->action : "";
-    db = sb->action ? sb->action : "";
-    retval = g_utf8_collate (da, db);
+    retval = strcmp (gnc_sort_key_collate (SPLIT_KEY (sa, action), sa->action),
+                     gnc_sort_key_collate (SPLIT_KEY (sb, action), sb->action));
     if (retval != 0)
         return retval;
 
@@ -1687,6 +1743,7 @@ qofSplitSetMemo (Split *split, const char* memo)
 {
     g_return_if_fail(split);
     CACHE_REPLACE(split->memo, memo);
+    gnc_sort_key_clear (&split->memo_key);
 }
 
 void
@@ -1696,6 +1753,7 @@ xaccSplitSetMemo (Split *split, const char *memo)
     xaccTransBeginEdit (split->parent);
 
     CACHE_REPLACE(split->memo, memo);
+    gnc_sort_key_clear (&split->memo_key);
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
 
@@ -1706,6 +1764,7 @@ qofSplitSetAction (Split *split, const char *actn)
 {
     g_return_if_fail(split);
     CACHE_REPLACE(split->action, actn);
+    gnc_sort_key_clear (&split->action_key);
 }
 
 void
@@ -1715,6 +1774,7 @@ xaccSplitSetAction (Split *split, const char *actn)
     xaccTransBeginEdit (split->parent);
 
     CACHE_REPLACE(split->action, actn);
+    gnc_sort_key_clear (&split->action_key);
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
 
@@ -51,6 +51,19 @@
 #include "gnc-engine.h"   /* for typedefs */
 #include "qof.h"
 
+/* The sort keys of one of a split's or transaction's strings, made when
+ * a sort first needs them: its collation key and the number it starts
+ * with. They remember which string they were made from, so they go
+ * stale when the field is pointed at another one; the setters clear them
+ * as well, as the new string may reuse the old one's memory. */
+typedef struct
+{
+    const char *src;
+    char *collate;
+    int num;
+    gboolean have_num;
+} GncSortKey;
+
 
 /** STRUCTS *********************************************************/
 /* A "split" is more commonly referred to as an "entry" in a "transaction".
@@ -74,6 +87,7 @@ struct split_s
 
     Account *acc;              /* back-pointer to debited/credited account  */
     Account *orig_acc;
+    Account *member_acc;       /* account whose split list holds this one */
     GNCLot *lot;               /* back-pointer to debited/credited lot */
 
     Transaction *parent;       /* parent of split                           */
@@ -93,6 +107,9 @@ struct split_s
      */
     char  * action;            /* Buy, Sell, Div, etc.                      */
 
+    GncSortKey memo_key;
+    GncSortKey action_key;
+
     Timespec date_reconciled;  /* date split was reconciled                 */
     char    reconciled;        /* The reconciled field                      */
 
@@ -173,6 +190,11 @@ gboolean xaccSplitRegister (void);
  */
 void xaccSplitDetermineGainStatus (Split *split);
 
+/* The sort keys of str, which key holds the keys for. */
+const char * gnc_sort_key_collate (GncSortKey *key, const char *str);
+int gnc_sort_key_num (GncSortKey *key, const char *str);
+void gnc_sort_key_clear (GncSortKey *key);
+
 /* ---------------------------------------------------------------- */
 /* Deprecated routines */
 void         DxaccSplitSetSharePriceAndAmount (Split *split,
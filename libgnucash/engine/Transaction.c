@@ -62,6 +62,7 @@ struct timeval
 #include "gnc-engine.h"
 #include "gnc-lot.h"
 #include "gnc-event.h"
+#include "gnc-query-index.h"
 #include <gnc-date.h>
 #include "SchedXaction.h"
 #include "gncBusiness.h"
@@ -517,6 +518,7 @@ xaccMallocTransaction (QofBook *book)
 
     trans = g_object_new(GNC_TYPE_TRANSACTION, NULL);
     xaccInitTransaction (trans, book);
+    gnc_query_index_changed (QOF_INSTANCE (trans));
     qof_event_gen (&trans->inst, QOF_EVENT_CREATE, NULL);
 
     return trans;
@@ -659,6 +661,7 @@ xaccTransCloneNoKvp (const Transaction *from)
 
     qof_instance_init_data (&to->inst, GNC_ID_TRANS,
 			    qof_instance_get_book(from));
+    gnc_query_index_changed (QOF_INSTANCE (to));
 
     xaccTransBeginEdit(to);
     for (node = from->splits; node; node = node->next)
@@ -799,6 +802,7 @@ xaccFreeTransaction (Transaction *trans)
         LEAVE (" ");
         return;
     }
+    gnc_query_index_removed (QOF_INSTANCE (trans));
 
     /* free up the destination splits */
     for (node = trans->splits; node; node = node->next)
@@ -809,6 +813,8 @@ xaccFreeTransaction (Transaction *trans)
     /* free up transaction strings */
     CACHE_REMOVE(trans->num);
     CACHE_REMOVE(trans->description);
+    gnc_sort_key_clear (&trans->num_key);
+    gnc_sort_key_clear (&trans->description_key);
 
     /* Just in case someone looks up freed memory ... */
     trans->num         = (char *) 1;
@@ -1034,18 +1040,34 @@ xaccTransLookup (const GncGUID *guid, QofBook *book)
 /********************************************************************\
 \********************************************************************/
 
+/* Most transactions have few enough splits to sum their values from the
+ * stack. */
+#define IMBALANCE_SMALL_VALUES 16
+
 gnc_numeric
 xaccTransGetImbalanceValue (const Transaction * trans)
 {
     gnc_numeric imbal = gnc_numeric_zero();
+    gnc_numeric small_values[IMBALANCE_SMALL_VALUES];
+    gnc_numeric *values = small_values;
+    guint n_values, count = 0;
     if (!trans) return imbal;
 
     ENTER("(trans=%p)", trans);
+    /* Start from zero, as adding the values one at a time did. */
+    n_values = g_list_length (trans->splits) + 1;
+    if (n_values > IMBALANCE_SMALL_VALUES)
+        values = g_new (gnc_numeric, n_values);
+    values[count++] = imbal;
+
     /* Could use xaccSplitsComputeValue, except that we want to use
        GNC_HOW_DENOM_EXACT */
-    FOR_EACH_SPLIT(trans, imbal =
-                       gnc_numeric_add(imbal, xaccSplitGetValue(s),
-                                       GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT));
+    FOR_EACH_SPLIT(trans, values[count++] = xaccSplitGetValue(s));
+    imbal = gnc_numeric_sum (values, count, GNC_DENOM_AUTO,
+                             GNC_HOW_DENOM_EXACT);
+
+    if (values != small_values)
+        g_free (values);
     LEAVE("(trans=%p) imbal=%s", trans, gnc_num_dbg_to_string(imbal));
     return imbal;
 }
@@ -1738,8 +1760,11 @@ xaccTransRollbackEdit (Transaction *trans)
     orig = trans->orig;
     SWAP(trans->num, orig->num);
     SWAP(trans->description, orig->description);
+    gnc_sort_key_clear (&trans->num_key);
+    gnc_sort_key_clear (&trans->description_key);
     trans->date_entered = orig->date_entered;
     trans->date_posted = orig->date_posted;
+    gnc_query_index_changed (QOF_INSTANCE (trans));
     SWAP(trans->common_currency, orig->common_currency);
     qof_instance_swap_kvp (QOF_INSTANCE (trans), QOF_INSTANCE (orig));
 
@@ -1766,10 +1791,13 @@ xaccTransRollbackEdit (Transaction *trans)
             xaccSplitRollbackEdit(s);
             SWAP(s->action, so->action);
             SWAP(s->memo, so->memo);
+            gnc_sort_key_clear (&s->action_key);
+            gnc_sort_key_clear (&s->memo_key);
 	    qof_instance_copy_kvp (QOF_INSTANCE (s), QOF_INSTANCE (so));
             s->reconciled = so->reconciled;
             s->amount = so->amount;
             s->value = so->value;
+            gnc_query_index_changed (QOF_INSTANCE (s));
             s->lot = so->lot;
             s->gains_split = so->gains_split;
             //SET_GAINS_A_VDIRTY(s);
@@ -1805,6 +1833,10 @@ xaccTransRollbackEdit (Transaction *trans)
     g_list_free(orig->splits);
     orig->splits = NULL;
 
+    /* The restored num, description and dates may put the splits back
+     * somewhere else in their accounts. */
+    mark_trans(trans);
+
     /* Now that the engine copy is back to its original version,
      * get the backend to fix it in the database */
     be = qof_book_get_backend(qof_instance_get_book(trans));
@@ -1879,12 +1911,40 @@ xaccTransOrder (const Transaction *ta, const Transaction *tb)
     return xaccTransOrder_num_action (ta, NULL, tb, NULL);
 }
 
+/* Sorting only caches keys, so it may do so on const transactions. */
+#define TRANS_KEY(trans, field) (&((Transaction*)(trans))->field##_key)
+
+/* The rest of the ordering, once the dates posted are known to be equal
+ * and na and nb are the numbers to sort on. */
+static int
+trans_order_from_num (const Transaction *ta, int na,
+                      const Transaction *tb, int nb)
+{
+    int retval;
+
+    if (na < nb) return -1;
+    if (na > nb) return +1;
+
+    /* if dates differ, return */
+    DATE_CMP(ta, tb, date_entered);
+
+    /* otherwise, sort on description string */
+    retval = strcmp (gnc_sort_key_collate (TRANS_KEY (ta, description),
+                                           ta->description),
+                     gnc_sort_key_collate (TRANS_KEY (tb, description),
+                                           tb->description));
+    if (retval)
+        return retval;
+
+    /* else, sort on guid - keeps sort stable. */
+    return qof_instance_guid_compare(ta, tb);
+}
+
 int
 xaccTransOrder_num_action (const Transaction *ta, const char *actna,
                             const Transaction *tb, const char *actnb)
 {
-    char *da, *db;
-    int na, nb, retval;
+    int na, nb;
 
     if ( ta && !tb ) return -1;
     if ( !ta && tb ) return +1;
@@ -1901,24 +1961,24 @@ xaccTransOrder_num_action (const Transaction *ta, const char *actna,
     }
     else                /* else transaction num string */
     {
-        na = atoi(ta->num);
-        nb = atoi(tb->num);
+        na = gnc_sort_key_num (TRANS_KEY (ta, num), ta->num);
+        nb = gnc_sort_key_num (TRANS_KEY (tb, num), tb->num);
     }
-    if (na < nb) return -1;
-    if (na > nb) return +1;
+    return trans_order_from_num (ta, na, tb, nb);
+}
 
-    /* if dates differ, return */
-    DATE_CMP(ta, tb, date_entered);
+int
+xaccTransOrderNums (const Transaction *ta, int na,
+                    const Transaction *tb, int nb)
+{
+    if ( ta && !tb ) return -1;
+    if ( !ta && tb ) return +1;
+    if ( !ta && !tb ) return 0;
 
-    /* otherwise, sort on description string */
-    da = ta->description ? ta->description : "";
-    db = tb->description ? tb->description : "";
-    retval = g_utf8_collate (da, db);
-    if (retval)
-        return retval;
+    /* if dates differ, return */
+    DATE_CMP(ta, tb, date_posted);
 
-    /* else, sort on guid - keeps sort stable. */
-    return qof_instance_guid_compare(ta, tb);
+    return trans_order_from_num (ta, na, tb, nb);
 }
 
 /********************************************************************\
@@ -1941,6 +2001,7 @@ xaccTransSetDateInternal(Transaction *trans, Timespec *dadate, Timespec val)
 #endif
     *dadate = val;
     qof_instance_set_dirty(QOF_INSTANCE(trans));
+    gnc_query_index_changed (QOF_INSTANCE (trans));
     mark_trans(trans);
     xaccTransCommitEdit(trans);
 
@@ -2128,6 +2189,7 @@ xaccTransSetNum (Transaction *trans, const char *xnum)
     xaccTransBeginEdit(trans);
 
     CACHE_REPLACE(trans->num, xnum);
+    gnc_sort_key_clear (&trans->num_key);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     mark_trans(trans);  /* Dirty balance of every account in trans */
     xaccTransCommitEdit(trans);
@@ -2148,7 +2210,9 @@ xaccTransSetDescription (Transaction *trans, const char *desc)
     xaccTransBeginEdit(trans);
 
     CACHE_REPLACE(trans->description, desc);
+    gnc_sort_key_clear (&trans->description_key);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
+    mark_trans(trans);  /* The description orders splits, too */
     xaccTransCommitEdit(trans);
 }
 
@@ -2940,14 +3004,32 @@ xaccTransFindSplitByAccount(const Transaction *trans, const Account *acc)
 /* QofObject function implementation */
 
 static void
-destroy_tx_on_book_close(QofInstance *ent, gpointer data)
+forget_gains_on_book_close(QofInstance *ent, gpointer data)
+{
+    Transaction* tx = GNC_TRANSACTION(ent);
+    GList *node;
+
+    for (node = tx->splits; node; node = node->next)
+        ((Split*)node->data)->gains_split = NULL;
+    if (tx->orig)
+        for (node = tx->orig->splits; node; node = node->next)
+            ((Split*)node->data)->gains_split = NULL;
+}
+
+static void
+free_tx_on_book_close(QofInstance *ent, gpointer data)
 {
     Transaction* tx = GNC_TRANSACTION(ent);
 
-    xaccTransDestroy(tx);
+    xaccFreeTransaction(tx);
 }
 
 /** Handles book end - frees all transactions from the book
+ *
+ * The accounts have already gone and the lots go with the rest of the
+ * book, so rather than destroying each transaction through an edit
+ * cycle that would unlink its splits from them, just free it. Gains
+ * splits point across transactions, so forget those first.
  *
  * @param book Book being closed
  */
@@ -2957,7 +3039,8 @@ gnc_transaction_book_end(QofBook* book)
     QofCollection *col;
 
     col = qof_book_get_collection(book, GNC_ID_TRANS);
-    qof_collection_foreach(col, destroy_tx_on_book_close, NULL);
+    qof_collection_foreach(col, forget_gains_on_book_close, NULL);
+    qof_collection_foreach(col, free_tx_on_book_close, NULL);
 }
 
 #ifdef _MSC_VER
@@ -89,6 +89,9 @@ struct transaction_s
      */
     char * description;
 
+    GncSortKey num_key;
+    GncSortKey description_key;
+
     /* The common_currency field is the balancing common currency for
      * all the splits in the transaction.  Alternate, better(?) name:
      * "valuation currency": it is the currency in which all of the
@@ -165,6 +168,10 @@ void xaccEnableDataScrubbing(void);
 void xaccDisableDataScrubbing(void);
 
 void xaccTransRemoveSplit (Transaction *trans, const Split *split);
+
+/* xaccTransOrder_num_action() with the actions' numbers already parsed. */
+int xaccTransOrderNums (const Transaction *ta, int na,
+                        const Transaction *tb, int nb);
 void check_open (const Transaction *trans);
 
 /* Structure for accessing static functions for testing */
@@ -36,6 +36,7 @@
 #include "gnc-pricedb-p.h"
 #include "gnc-lot-p.h"
 #include "gnc-budget.h"
+#include "gnc-query-index.h"
 
 #include "gncAddressP.h"
 #include "gncBillTermP.h"
@@ -73,6 +74,7 @@ cashobjects_register(void)
     g_return_val_if_fail(xaccAccountRegister(), FALSE);
     g_return_val_if_fail ( xaccTransRegister(), FALSE);
     g_return_val_if_fail ( xaccSplitRegister(), FALSE);
+    g_return_val_if_fail (gnc_query_index_register (), FALSE);
     g_return_val_if_fail ( SXRegister (),       FALSE);
     g_return_val_if_fail ( gnc_sxtt_register(), FALSE);
     g_return_val_if_fail(gnc_pricedb_register(), FALSE);
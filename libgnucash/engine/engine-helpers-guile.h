@@ -29,6 +29,7 @@
 #include <libguile.h>
 
 #include "gnc-engine.h"
+#include "gnc-pricedb.h"
 
 /* Helpers for various conversions to and from guile */
 
@@ -56,4 +57,11 @@ gnc_commodity * gnc_scm_to_commodity(SCM scm);
 SCM gnc_commodity_to_scm (const gnc_commodity *commodity);
 SCM gnc_book_to_scm (const QofBook *book);
 
+/* gnc_pricedb_convert_balances_nearest_price() for a list of
+ * (commodity amount timepair) lists. Returns the converted amounts in
+ * the same order. */
+SCM gnc_pricedb_convert_balances_nearest_price_scm (GNCPriceDB *pdb,
+                                                    SCM conversions,
+                                                    const gnc_commodity *new_currency);
+
 #endif
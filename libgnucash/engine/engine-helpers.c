@@ -2065,3 +2065,33 @@ gnc_book_to_scm (const QofBook *book)
 {
     return gnc_generic_to_scm(book, "_p_QofBook");
 }
+
+SCM
+gnc_pricedb_convert_balances_nearest_price_scm (GNCPriceDB *pdb,
+                                                SCM conversions,
+                                                const gnc_commodity *new_currency)
+{
+    GNCPriceConversion *convs;
+    SCM result = SCM_EOL;
+    guint n, i;
+
+    if (!scm_is_true (scm_list_p (conversions)))
+        return SCM_BOOL_F;
+
+    n = scm_to_uint (scm_length (conversions));
+    convs = g_new0 (GNCPriceConversion, n);
+    for (i = 0; i < n; i++, conversions = SCM_CDR (conversions))
+    {
+        SCM item = SCM_CAR (conversions);
+        convs[i].commodity = gnc_scm_to_commodity (SCM_CAR (item));
+        convs[i].balance = gnc_scm_to_numeric (SCM_CADR (item));
+        convs[i].time = gnc_timepair2timespec (SCM_CADDR (item));
+    }
+
+    gnc_pricedb_convert_balances_nearest_price (pdb, convs, n, new_currency);
+
+    for (i = n; i > 0; i--)
+        result = scm_cons (gnc_numeric_to_scm (convs[i - 1].result), result);
+    g_free (convs);
+    return result;
+}
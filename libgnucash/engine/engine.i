@@ -154,6 +154,10 @@ functions. */
   }
 }
 
+/* Scheme gets the batch conversion with lists instead of an array. */
+%rename(gnc_pricedb_convert_balances_nearest_price) gnc_pricedb_convert_balances_nearest_price_scm;
+%ignore gnc_pricedb_convert_balances_nearest_price;
+
 %include <engine-helpers.h>
 %include <engine-helpers-guile.h>
 %typemap(in) Transaction *trans;
@@ -284,16 +284,21 @@ gnc_lot_free(GNCLot* lot)
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_DESTROY, NULL);
 
     priv = GET_PRIVATE(lot);
-    for (node = priv->splits; node; node = node->next)
+    /* When the book is closing its splits and accounts may already be
+     * gone, and nobody needs to hear about it. */
+    if (!qof_book_shutting_down (qof_instance_get_book (lot)))
     {
-        Split *s = node->data;
-        s->lot = NULL;
+        for (node = priv->splits; node; node = node->next)
+        {
+            Split *s = node->data;
+            s->lot = NULL;
+        }
+
+        if (priv->account && !qof_instance_get_destroying(priv->account))
+            xaccAccountRemoveLot (priv->account, lot);
     }
     g_list_free (priv->splits);
 
-    if (priv->account && !qof_instance_get_destroying(priv->account))
-        xaccAccountRemoveLot (priv->account, lot);
-
     priv->account = NULL;
     priv->is_closed = TRUE;
     /* qof_instance_release (&lot->inst); */
@@ -39,6 +39,7 @@ extern "C"
 #include <boost/regex.hpp>
 #include <sstream>
 #include <cstdlib>
+#include <algorithm>
 
 #include "gnc-numeric.hpp"
 #include "gnc-rational.hpp"
@@ -735,6 +736,35 @@ denom_lcd(gnc_numeric a, gnc_numeric b, int64_t denom, int how)
     return denom;
 }
 
+/* Whether values with the denominator value_denom add up to the sum of
+ * their numerators over value_denom, needing no conversion. */
+static bool
+same_denom_sum_ok(int64_t value_denom, int64_t denom, int how)
+{
+    if (value_denom <= 0)
+        return false;
+    switch (how & GNC_NUMERIC_DENOM_MASK)
+    {
+    case GNC_HOW_DENOM_FIXED:
+    case GNC_HOW_DENOM_LCD:
+        return denom == GNC_DENOM_AUTO || denom == value_denom;
+    case GNC_HOW_DENOM_EXACT:
+        return denom == GNC_DENOM_AUTO &&
+            (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER;
+    default:
+        return false;
+    }
+}
+
+static gnc_numeric
+same_denom_sum(int64_t num, int64_t value_denom, int how)
+{
+    /* An exact sum is rounded to a gnc_numeric, which makes 0 0/1. */
+    if (num == 0 && (how & GNC_NUMERIC_DENOM_MASK) == GNC_HOW_DENOM_EXACT)
+        return gnc_numeric_zero();
+    return gnc_numeric_create(num, value_denom);
+}
+
 /* *******************************************************************
  *  gnc_numeric_add
  ********************************************************************/
@@ -747,6 +777,11 @@ gnc_numeric_add(gnc_numeric a, gnc_numeric b,
     {
         return gnc_numeric_error(GNC_ERROR_ARG);
     }
+    /* Amounts in one commodity share their denominator, so their sum needs
+     * no conversion as long as it fits. */
+    if (a.denom == b.denom && same_denom_sum_ok(a.denom, denom, how) &&
+        (b.num >= 0 ? a.num <= INT64_MAX - b.num : a.num >= INT64_MIN - b.num))
+        return same_denom_sum(a.num + b.num, a.denom, how);
     denom = denom_lcd(a, b, denom, how);
     try
     {
@@ -788,6 +823,70 @@ gnc_numeric_add(gnc_numeric a, gnc_numeric b,
     }
 }
 
+/* *******************************************************************
+ *  gnc_numeric_sum
+ ********************************************************************/
+
+/* The exact sum of the numerators of count values. Each is split into its
+ * high and low 32 bits so that the halves accumulate in plain 64-bit
+ * integers, which can't overflow and which the compiler is free to
+ * vectorize. */
+static GncInt128
+sum_numerators(const gnc_numeric* values, size_t count)
+{
+    /* Few enough that neither half can overflow. */
+    constexpr size_t max_chunk = size_t{1} << 30;
+    GncInt128 total;
+    while (count > 0)
+    {
+        auto chunk = std::min(count, max_chunk);
+        int64_t high = 0, low = 0;
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            high += values[i].num >> 32;
+            low += values[i].num & INT64_C(0xffffffff);
+        }
+        total += GncInt128(high) * GncInt128(INT64_C(1) << 32) + GncInt128(low);
+        values += chunk;
+        count -= chunk;
+    }
+    return total;
+}
+
+gnc_numeric
+gnc_numeric_sum(const gnc_numeric* values, gsize count,
+                gint64 denom, gint how)
+{
+    if (count == 0)
+        return gnc_numeric_zero();
+
+    gnc_numeric sum = gnc_numeric_zero();
+    size_t start = 0;
+    while (start < count)
+    {
+        auto run_denom = values[start].denom;
+        auto end = start + 1;
+        if (same_denom_sum_ok(run_denom, denom, how))
+            while (end < count && values[end].denom == run_denom)
+                ++end;
+
+        auto value = values[start];
+        if (end - start > 1)
+        {
+            auto total = sum_numerators(values + start, end - start);
+            if (!total.isBig())
+                value = same_denom_sum(static_cast<int64_t>(total), run_denom,
+                                       how);
+            else
+                for (auto index = start + 1; index < end; ++index)
+                    value = gnc_numeric_add(value, values[index], denom, how);
+        }
+        sum = start == 0 ? value : gnc_numeric_add(sum, value, denom, how);
+        start = end;
+    }
+    return sum;
+}
+
 /* *******************************************************************
  *  gnc_numeric_sub
  ********************************************************************/
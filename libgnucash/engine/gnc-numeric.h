@@ -397,6 +397,19 @@ gnc_numeric gnc_numeric_add(gnc_numeric a, gnc_numeric b,
 gnc_numeric gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
                             gint64 denom, gint how);
 
+/** Return the sum of the count values, or 0 if there are none.
+ *
+ *  The values are added in order with gnc_numeric_add(sum, value, denom,
+ *  how), except that each run of values with the same denominator, which
+ *  is what the amounts in one commodity have, is first totalled exactly
+ *  and then added as one. The result is the same as adding each value in
+ *  turn unless one of those intermediate sums would overflow: that returns
+ *  GNC_ERROR_OVERFLOW, while gnc_numeric_sum() returns the sum if the
+ *  run's total and the final result fit.
+ */
+gnc_numeric gnc_numeric_sum(const gnc_numeric *values, gsize count,
+                            gint64 denom, gint how);
+
 /** Multiply a times b, returning the product.  An overflow
  *  may occur if the result of the multiplication can't
  *  be represented as a ratio of 64-bit int's after removing
@@ -56,6 +56,10 @@ struct gnc_price_db_s
 {
     QofInstance inst;              /* globally unique object identifier */
     GHashTable *commodity_hash;
+    /* commodity -> currency -> GPtrArray of the same prices as the
+     * commodity_hash list, in the same order, for binary searching by
+     * time. */
+    GHashTable *price_index;
     gboolean bulk_update;		 /* TRUE while reading XML file, etc. */
 };
 
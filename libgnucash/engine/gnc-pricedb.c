@@ -879,6 +879,9 @@ gnc_pricedb_create(QofBook * book)
 
     result->commodity_hash = g_hash_table_new(NULL, NULL);
     g_return_val_if_fail (result->commodity_hash, NULL);
+    result->price_index =
+        g_hash_table_new_full (NULL, NULL, NULL,
+                               (GDestroyNotify)g_hash_table_destroy);
     return result;
 }
 
@@ -926,6 +929,9 @@ gnc_pricedb_destroy(GNCPriceDB *db)
     }
     g_hash_table_destroy (db->commodity_hash);
     db->commodity_hash = NULL;
+    if (db->price_index)
+        g_hash_table_destroy (db->price_index);
+    db->price_index = NULL;
     /* qof_instance_release (&db->inst); */
     g_object_unref(db);
 }
@@ -1058,6 +1064,178 @@ gnc_pricedb_equal (GNCPriceDB *db1, GNCPriceDB *db2)
     return equal_data.equal;
 }
 
+/* ==================================================================== */
+/* The price index holds, for each commodity/currency pair, an array of
+ * the pair's prices in the same newest-first order as its price list, so
+ * that the lookups by time can binary search instead of walking the
+ * list.  add_price() and remove_price() keep it in step with the lists.
+ * The arrays don't hold references; the lists do. */
+
+static GPtrArray *
+price_index_get (GNCPriceDB *db, const gnc_commodity *commodity,
+                 const gnc_commodity *currency, gboolean create)
+{
+    GHashTable *currency_index;
+    GPtrArray *prices;
+
+    if (!db->price_index) return NULL;
+    currency_index = g_hash_table_lookup (db->price_index, commodity);
+    if (!currency_index)
+    {
+        if (!create) return NULL;
+        currency_index =
+            g_hash_table_new_full (NULL, NULL, NULL,
+                                   (GDestroyNotify)g_ptr_array_unref);
+        g_hash_table_insert (db->price_index, (gpointer)commodity,
+                             currency_index);
+    }
+    prices = g_hash_table_lookup (currency_index, currency);
+    if (!prices && create)
+    {
+        prices = g_ptr_array_new ();
+        g_hash_table_insert (currency_index, (gpointer)currency, prices);
+    }
+    return prices;
+}
+
+/* The position of the first price in prices that doesn't sort before p. */
+static guint
+price_index_position (GPtrArray *prices, const GNCPrice *p)
+{
+    guint lo = 0, hi = prices->len;
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (compare_prices_by_date (g_ptr_array_index (prices, mid), p) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* The position of the newest price in prices that isn't later than t, or
+ * prices->len if they all are. */
+static guint
+price_index_first_not_after (GPtrArray *prices, Timespec t)
+{
+    guint lo = 0, hi = prices->len;
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        Timespec price_t = gnc_price_get_time (g_ptr_array_index (prices, mid));
+        if (timespec_cmp (&price_t, &t) > 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* The same test as price_list_is_duplicate, but only looking at the
+ * prices on p's day. */
+static gboolean
+price_index_has_duplicate (GPtrArray *prices, GNCPrice *p)
+{
+    PriceListIsDuplStruct dupl = { p, FALSE };
+    Timespec day = timespecCanonicalDayTime (gnc_price_get_time (p));
+    guint pos = price_index_position (prices, p), ind;
+
+    for (ind = pos; ind < prices->len && !dupl.isDupl; ind++)
+    {
+        GNCPrice *other = g_ptr_array_index (prices, ind);
+        Timespec other_day = timespecCanonicalDayTime (gnc_price_get_time (other));
+        if (!timespec_equal (&other_day, &day)) break;
+        price_list_is_duplicate (other, &dupl);
+    }
+    for (ind = pos; ind > 0 && !dupl.isDupl; ind--)
+    {
+        GNCPrice *other = g_ptr_array_index (prices, ind - 1);
+        Timespec other_day = timespecCanonicalDayTime (gnc_price_get_time (other));
+        if (!timespec_equal (&other_day, &day)) break;
+        price_list_is_duplicate (other, &dupl);
+    }
+    return dupl.isDupl;
+}
+
+static void
+price_index_insert (GPtrArray *prices, GNCPrice *p)
+{
+    g_ptr_array_insert (prices, price_index_position (prices, p), p);
+}
+
+static void
+price_index_remove (GNCPriceDB *db, GNCPrice *p)
+{
+    GHashTable *currency_index;
+    GPtrArray *prices = price_index_get (db, p->commodity, p->currency, FALSE);
+    guint pos;
+
+    if (!prices) return;
+    pos = price_index_position (prices, p);
+    if (pos < prices->len && g_ptr_array_index (prices, pos) == p)
+        g_ptr_array_remove_index (prices, pos);
+    else
+        g_ptr_array_remove (prices, p);
+    if (prices->len) return;
+
+    currency_index = g_hash_table_lookup (db->price_index, p->commodity);
+    g_hash_table_remove (currency_index, p->currency);
+    if (!g_hash_table_size (currency_index))
+        g_hash_table_remove (db->price_index, p->commodity);
+}
+
+/* Combine the two directions of a pair: given, for each series, the
+ * position of its first price not later than some time, set *after to
+ * the last price later than it and *before to the first one that isn't,
+ * in the series' merged newest-first order. */
+static void
+price_series_bracket (GPtrArray *series[2], const guint pos[2],
+                      GNCPrice **after, GNCPrice **before)
+{
+    int ind;
+
+    *after = *before = NULL;
+    for (ind = 0; ind < 2; ind++)
+    {
+        GPtrArray *prices = series[ind];
+
+        if (!prices) continue;
+        if (pos[ind] > 0)
+        {
+            GNCPrice *p = g_ptr_array_index (prices, pos[ind] - 1);
+            if (!*after || compare_prices_by_date (p, *after) > 0)
+                *after = p;
+        }
+        if (pos[ind] < prices->len)
+        {
+            GNCPrice *p = g_ptr_array_index (prices, pos[ind]);
+            if (!*before || compare_prices_by_date (p, *before) < 0)
+                *before = p;
+        }
+    }
+}
+
+/* Find the prices either side of t among the prices from c to currency
+ * and from currency to c, taken together in newest-first order: *after
+ * is the last one later than t and *before the first one that isn't. */
+static void
+price_index_bracket (GNCPriceDB *db, const gnc_commodity *c,
+                     const gnc_commodity *currency, Timespec t,
+                     GNCPrice **after, GNCPrice **before)
+{
+    GPtrArray *series[2];
+    guint pos[2] = {0, 0};
+    int ind;
+
+    series[0] = price_index_get (db, c, currency, FALSE);
+    series[1] = price_index_get (db, currency, c, FALSE);
+    for (ind = 0; ind < 2; ind++)
+        if (series[ind])
+            pos[ind] = price_index_first_not_after (series[ind], t);
+    price_series_bracket (series, pos, after, before);
+}
+
 /* ==================================================================== */
 /* The add_price() function is a utility that only manages the
  * dual hash table instertion */
@@ -1071,6 +1249,7 @@ add_price(GNCPriceDB *db, GNCPrice *p)
     gnc_commodity *commodity;
     gnc_commodity *currency;
     GHashTable *currency_hash;
+    GPtrArray *prices;
     GNCPrice *old_price;
 
     if (!db || !p) return FALSE;
@@ -1129,10 +1308,22 @@ add_price(GNCPriceDB *db, GNCPrice *p)
     }
 
     price_list = g_hash_table_lookup(currency_hash, currency);
-    if (!gnc_price_list_insert(&price_list, p, !db->bulk_update))
+    prices = price_index_get (db, commodity, currency, TRUE);
+    /* Check for duplicates against the index rather than letting
+     * gnc_price_list_insert walk the whole list, but keep its behavior
+     * of taking a reference and reporting success. */
+    if (!db->bulk_update && price_index_has_duplicate (prices, p))
     {
-        LEAVE ("gnc_price_list_insert failed");
-        return FALSE;
+        gnc_price_ref(p);
+    }
+    else
+    {
+        if (!gnc_price_list_insert(&price_list, p, FALSE))
+        {
+            LEAVE ("gnc_price_list_insert failed");
+            return FALSE;
+        }
+        price_index_insert (prices, p);
     }
 
     if (!price_list)
@@ -1236,6 +1427,7 @@ remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
         LEAVE (" cannot remove price list");
         return FALSE;
     }
+    price_index_remove (db, p);
 
     /* if the price list is empty, then remove this currency from the
        commodity hash */
@@ -2257,26 +2449,21 @@ gnc_pricedb_lookup_at_time(GNCPriceDB *db,
                            const gnc_commodity *currency,
                            Timespec t)
 {
-    GList *price_list;
-    GList *item = NULL;
+    GNCPrice *after, *before;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    item = price_list;
-    while (item)
+    price_index_bracket (db, c, currency, t, &after, &before);
+    if (before)
     {
-        GNCPrice *p = item->data;
-        Timespec price_time = gnc_price_get_time(p);
+        Timespec price_time = gnc_price_get_time(before);
         if (timespec_equal(&price_time, &t))
         {
-            gnc_price_ref(p);
-            g_list_free (price_list);
-            return p;
+            gnc_price_ref(before);
+            LEAVE (" ");
+            return before;
         }
-        item = item->next;
     }
-    g_list_free (price_list);
     LEAVE (" ");
     return NULL;
 }
@@ -2288,35 +2475,24 @@ lookup_nearest_in_time(GNCPriceDB *db,
                        Timespec t,
                        gboolean sameday)
 {
-    GList *price_list;
     GNCPrice *current_price = NULL;
     GNCPrice *next_price = NULL;
     GNCPrice *result = NULL;
-    GList *item = NULL;
+    GNCPrice *after;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return NULL;
-    item = price_list;
 
-    /* default answer */
-    current_price = item->data;
-
-    /* find the first candidate past the one we want.  Remember that
-       prices are in most-recent-first order. */
-    while (!next_price && item)
+    /* next_price is the first candidate not later than the one we want
+       and current_price the one just before it in most-recent-first
+       order, or next_price itself if there's none. */
+    price_index_bracket (db, c, currency, t, &after, &next_price);
+    if (!after && !next_price)
     {
-        GNCPrice *p = item->data;
-        Timespec price_time = gnc_price_get_time(p);
-        if (timespec_cmp(&price_time, &t) <= 0)
-        {
-            next_price = item->data;
-            break;
-        }
-        current_price = item->data;
-        item = item->next;
+        LEAVE (" no prices");
+        return NULL;
     }
+    current_price = after ? after : next_price;
 
     if (current_price)      /* How can this be null??? */
     {
@@ -2388,7 +2564,6 @@ lookup_nearest_in_time(GNCPriceDB *db,
     }
 
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE (" ");
     return result;
 }
@@ -2408,32 +2583,30 @@ gnc_pricedb_lookup_latest_before (GNCPriceDB *db,
                                   gnc_commodity *currency,
                                   Timespec t)
 {
-    GList *price_list;
     GNCPrice *current_price = NULL;
-    /*  GNCPrice *next_price = NULL;
-        GNCPrice *result = NULL;*/
-    GList *item = NULL;
-    Timespec price_time;
+    GNCPrice *after;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return NULL;
-    item = price_list;
-    do
-    {
-        price_time = gnc_price_get_time (item->data);
-        if (timespec_cmp(&price_time, &t) <= 0)
-            current_price = item->data;
-        item = item->next;
-    }
-    while (timespec_cmp(&price_time, &t) > 0 && item);
+    price_index_bracket (db, c, currency, t, &after, &current_price);
     gnc_price_ref(current_price);
-    g_list_free (price_list);
     LEAVE (" ");
     return current_price;
 }
 
+static gnc_numeric
+convert_balance_by_price (gnc_numeric bal, const gnc_commodity *from,
+                          const gnc_commodity *to, GNCPrice *price)
+{
+    if (gnc_price_get_commodity(price) == from)
+        return gnc_numeric_mul (bal, gnc_price_get_value (price),
+                                gnc_commodity_get_fraction (to),
+                                GNC_HOW_RND_ROUND);
+    return gnc_numeric_div (bal, gnc_price_get_value (price),
+                            gnc_commodity_get_fraction (to),
+                            GNC_HOW_RND_ROUND);
+}
+
 static gnc_numeric
 direct_balance_conversion (GNCPriceDB *db, gnc_numeric bal,
                            const gnc_commodity *from, const gnc_commodity *to,
@@ -2451,14 +2624,7 @@ direct_balance_conversion (GNCPriceDB *db, gnc_numeric bal,
         price = gnc_pricedb_lookup_latest(db, from, to);
     if (price == NULL)
         return retval;
-    if (gnc_price_get_commodity(price) == from)
-        retval = gnc_numeric_mul (bal, gnc_price_get_value (price),
-                                  gnc_commodity_get_fraction (to),
-                                  GNC_HOW_RND_ROUND);
-    else
-        retval = gnc_numeric_div (bal, gnc_price_get_value (price),
-                                  gnc_commodity_get_fraction (to),
-                                  GNC_HOW_RND_ROUND);
+    retval = convert_balance_by_price (bal, from, to, price);
     gnc_price_unref (price);
     return retval;
 
@@ -2634,6 +2800,111 @@ gnc_pricedb_convert_balance_nearest_price(GNCPriceDB *pdb,
                                        new_currency, &t);
 }
 
+/* Order conversions by commodity and then newest first, the order in
+ * which the price series are swept. */
+static gint
+compare_conversions (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const GNCPriceConversion *conv = user_data;
+    const GNCPriceConversion *ca = &conv[*(const guint*)a];
+    const GNCPriceConversion *cb = &conv[*(const guint*)b];
+
+    if (ca->commodity != cb->commodity)
+        return (guintptr)ca->commodity < (guintptr)cb->commodity ? -1 : 1;
+    return -timespec_cmp (&ca->time, &cb->time);
+}
+
+/* The choice gnc_pricedb_lookup_nearest_in_time makes between the prices
+ * either side of t. */
+static GNCPrice *
+nearest_of_bracket (GNCPrice *after, GNCPrice *before, Timespec t)
+{
+    Timespec after_t, before_t, diff_after, diff_before, abs_after, abs_before;
+
+    if (!after || !before)
+        return after ? after : before;
+    after_t = gnc_price_get_time (after);
+    before_t = gnc_price_get_time (before);
+    diff_after = timespec_diff (&after_t, &t);
+    diff_before = timespec_diff (&before_t, &t);
+    abs_after = timespec_abs (&diff_after);
+    abs_before = timespec_abs (&diff_before);
+    return timespec_cmp (&abs_after, &abs_before) < 0 ? after : before;
+}
+
+void
+gnc_pricedb_convert_balances_nearest_price(GNCPriceDB *pdb,
+                                           GNCPriceConversion *conversions,
+                                           guint n_conversions,
+                                           const gnc_commodity *new_currency)
+{
+    guint *order, ind;
+    GPtrArray *series[2] = {NULL, NULL};
+    guint pos[2] = {0, 0};
+    const gnc_commodity *series_commodity = NULL;
+
+    if (!pdb || !conversions || !new_currency) return;
+    ENTER ("db=%p n_conversions=%u", pdb, n_conversions);
+
+    order = g_new (guint, n_conversions);
+    for (ind = 0; ind < n_conversions; ind++)
+        order[ind] = ind;
+    g_qsort_with_data (order, n_conversions, sizeof (guint),
+                       compare_conversions, conversions);
+
+    /* Within each commodity the times only go back, so the position in
+     * each newest-first price series only moves forward. */
+    for (ind = 0; ind < n_conversions; ind++)
+    {
+        GNCPriceConversion *conv = &conversions[order[ind]];
+        GNCPrice *after, *before, *price;
+        int dir;
+
+        if (gnc_numeric_zero_p (conv->balance) ||
+            gnc_commodity_equiv (conv->commodity, new_currency))
+        {
+            conv->result = conv->balance;
+            continue;
+        }
+        if (conv->commodity != series_commodity)
+        {
+            series_commodity = conv->commodity;
+            series[0] = price_index_get (pdb, series_commodity,
+                                         new_currency, FALSE);
+            series[1] = price_index_get (pdb, new_currency,
+                                         series_commodity, FALSE);
+            pos[0] = pos[1] = 0;
+        }
+        for (dir = 0; dir < 2; dir++)
+        {
+            GPtrArray *prices = series[dir];
+            while (prices && pos[dir] < prices->len)
+            {
+                Timespec price_t =
+                    gnc_price_get_time (g_ptr_array_index (prices, pos[dir]));
+                if (timespec_cmp (&price_t, &conv->time) <= 0)
+                    break;
+                pos[dir]++;
+            }
+        }
+        price_series_bracket (series, pos, &after, &before);
+        price = nearest_of_bracket (after, before, conv->time);
+        conv->result = gnc_numeric_zero ();
+        if (price)
+            conv->result = convert_balance_by_price (conv->balance,
+                                                     conv->commodity,
+                                                     new_currency, price);
+        /* No direct price: convert in two stages, one at a time. */
+        if (gnc_numeric_zero_p (conv->result))
+            conv->result = indirect_balance_conversion (pdb, conv->balance,
+                                                        conv->commodity,
+                                                        new_currency,
+                                                        &conv->time);
+    }
+    g_free (order);
+    LEAVE (" ");
+}
+
 
 /* ==================================================================== */
 /* gnc_pricedb_foreach_price infrastructure
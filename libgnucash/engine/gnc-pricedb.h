@@ -592,6 +592,36 @@ gnc_pricedb_convert_balance_nearest_price(GNCPriceDB *pdb,
                                           const gnc_commodity *new_currency,
                                           Timespec t);
 
+/** @brief One balance for gnc_pricedb_convert_balances_nearest_price. */
+typedef struct
+{
+    const gnc_commodity *commodity; /**< The commodity the balance is in */
+    gnc_numeric balance;            /**< The balance to be converted */
+    Timespec time;                  /**< The time nearest to which price
+                                     *   should be used */
+    gnc_numeric result;             /**< Set to the converted balance */
+} GNCPriceConversion;
+
+/** @brief Convert many balances to one currency, each using the price
+ * nearest to its own time.
+ *
+ * Each result is what gnc_pricedb_convert_balance_nearest_price would
+ * return for that balance, but the conversions are grouped by commodity
+ * and ordered by time so that each commodity's prices are swept once
+ * instead of being searched again for every balance.
+ * @param pdb The pricedb
+ * @param conversions The balances to convert; the result member of each
+ * is set on return.
+ * @param n_conversions The number of elements in conversions
+ * @param new_currency The commodity to which the balances should be
+ * converted
+ */
+void
+gnc_pricedb_convert_balances_nearest_price(GNCPriceDB *pdb,
+                                           GNCPriceConversion *conversions,
+                                           guint n_conversions,
+                                           const gnc_commodity *new_currency);
+
 typedef gboolean (*GncPriceForeachFunc)(GNCPrice *p, gpointer user_data);
 
 /** @brief Call a GncPriceForeachFunction once for each price in db, until the
@@ -0,0 +1,560 @@
+/********************************************************************
+ * gnc-query-index.cpp -- secondary indexes for split and           *
+ *                        transaction queries                       *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ *******************************************************************/
+
+#include <config.h>
+
+#include <glib.h>
+
+#include "Account.h"
+#include "Split.h"
+#include "SplitP.h"
+#include "Transaction.h"
+#include "gnc-engine.h"
+#include "gnc-query-index.h"
+#include "qofquery-p.h"
+#include "qofquerycore-p.h"
+
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+static QofLogModule log_module = GNC_MOD_ENGINE;
+
+#define QUERY_INDEX_KEY "gnc-query-index"
+
+/* Date terms are looked up a day wide on either side so that
+ * QOF_DATE_MATCH_DAY and sub-second times need no special casing;
+ * the term itself is always checked against the candidates. */
+#define DATE_SLOP (24 * 60 * 60)
+
+namespace
+{
+
+struct NumericKeyLess
+{
+    bool operator() (const std::pair<gnc_numeric, Split*>& a,
+                     const std::pair<gnc_numeric, Split*>& b) const
+    {
+        int cmp = gnc_numeric_compare (a.first, b.first);
+        if (cmp)
+            return cmp < 0;
+        return std::less<Split*>() (a.second, b.second);
+    }
+};
+
+using DateIndex = std::set<std::pair<time64, Transaction*>>;
+using NumericIndex = std::set<std::pair<gnc_numeric, Split*>, NumericKeyLess>;
+
+struct SplitKeys
+{
+    gnc_numeric amount;
+    gnc_numeric value;
+};
+
+struct QueryIndex
+{
+    DateIndex trans_by_date;
+    std::unordered_map<Transaction*, time64> trans_dates;
+    /* Absolute amounts and values, which is what numeric terms test. */
+    NumericIndex splits_by_amount;
+    NumericIndex splits_by_value;
+    std::unordered_map<Split*, SplitKeys> split_keys;
+    /* Splits whose amount or value can't be ordered; every numeric
+     * lookup returns them. */
+    std::unordered_set<Split*> unkeyed;
+    /* Splits whose account has been set by an edit that hasn't been
+     * committed, so the account's split list doesn't have them yet. */
+    std::unordered_set<Split*> moving;
+    /* Created or changed since the last query. */
+    std::unordered_set<QofInstance*> pending;
+};
+
+/* A range of keys; an unset end is unbounded. */
+template <typename T>
+struct KeyRange
+{
+    bool has_lo = false, has_hi = false;
+    T lo, hi;
+};
+
+} // namespace
+
+static void
+index_forget_trans (QueryIndex *idx, Transaction *trans)
+{
+    auto it = idx->trans_dates.find (trans);
+    if (it == idx->trans_dates.end ())
+        return;
+    idx->trans_by_date.erase (std::make_pair (it->second, trans));
+    idx->trans_dates.erase (it);
+}
+
+static void
+index_add_trans (QueryIndex *idx, Transaction *trans)
+{
+    time64 date = xaccTransGetDate (trans);
+    idx->trans_dates.emplace (trans, date);
+    idx->trans_by_date.emplace (date, trans);
+}
+
+static void
+index_forget_split (QueryIndex *idx, Split *split)
+{
+    idx->moving.erase (split);
+    auto it = idx->split_keys.find (split);
+    if (it == idx->split_keys.end ())
+        return;
+    if (!idx->unkeyed.erase (split))
+    {
+        idx->splits_by_amount.erase (std::make_pair (it->second.amount, split));
+        idx->splits_by_value.erase (std::make_pair (it->second.value, split));
+    }
+    idx->split_keys.erase (it);
+}
+
+static void
+index_add_split (QueryIndex *idx, Split *split)
+{
+    SplitKeys keys {gnc_numeric_abs (xaccSplitGetAmount (split)),
+                    gnc_numeric_abs (xaccSplitGetValue (split))};
+    if (split->acc != split->orig_acc)
+        idx->moving.insert (split);
+    idx->split_keys.emplace (split, keys);
+    if (gnc_numeric_check (keys.amount) || gnc_numeric_check (keys.value))
+    {
+        idx->unkeyed.insert (split);
+        return;
+    }
+    idx->splits_by_amount.emplace (keys.amount, split);
+    idx->splits_by_value.emplace (keys.value, split);
+}
+
+static void
+index_add_trans_cb (QofInstance *inst, gpointer data)
+{
+    index_add_trans (static_cast<QueryIndex*>(data), GNC_TRANSACTION (inst));
+}
+
+static void
+index_add_split_cb (QofInstance *inst, gpointer data)
+{
+    index_add_split (static_cast<QueryIndex*>(data), GNC_SPLIT (inst));
+}
+
+static void
+index_rebuild (QueryIndex *idx, QofBook *book)
+{
+    idx->trans_by_date.clear ();
+    idx->trans_dates.clear ();
+    idx->splits_by_amount.clear ();
+    idx->splits_by_value.clear ();
+    idx->split_keys.clear ();
+    idx->unkeyed.clear ();
+    idx->moving.clear ();
+    idx->pending.clear ();
+
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_TRANS),
+                            index_add_trans_cb, idx);
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_SPLIT),
+                            index_add_split_cb, idx);
+}
+
+/* Re-key everything reported since the last query.  Instances that
+ * aren't the book's registered ones (rollback copies, for instance)
+ * are dropped. */
+static void
+index_flush (QueryIndex *idx, QofBook *book)
+{
+    QofCollection *trans_col = qof_book_get_collection (book, GNC_ID_TRANS);
+    QofCollection *split_col = qof_book_get_collection (book, GNC_ID_SPLIT);
+
+    for (auto inst : idx->pending)
+    {
+        const GncGUID *guid = qof_instance_get_guid (inst);
+        if (GNC_IS_TRANSACTION (inst))
+        {
+            auto trans = GNC_TRANSACTION (inst);
+            index_forget_trans (idx, trans);
+            if (qof_collection_lookup_entity (trans_col, guid) == inst)
+                index_add_trans (idx, trans);
+        }
+        else if (GNC_IS_SPLIT (inst))
+        {
+            auto split = GNC_SPLIT (inst);
+            index_forget_split (idx, split);
+            if (qof_collection_lookup_entity (split_col, guid) == inst)
+                index_add_split (idx, split);
+        }
+    }
+    idx->pending.clear ();
+}
+
+static void
+index_free (QofBook *book, gpointer key, gpointer data)
+{
+    /* The splits and transactions are freed after this, so make sure
+     * nothing reports to the index any more. */
+    qof_book_set_data (book, QUERY_INDEX_KEY, NULL);
+    delete static_cast<QueryIndex*>(data);
+}
+
+/* The book's index, brought up to date. */
+static QueryIndex *
+index_for_book (QofBook *book)
+{
+    auto idx = static_cast<QueryIndex*>(qof_book_get_data (book, QUERY_INDEX_KEY));
+
+    if (!idx)
+    {
+        idx = new QueryIndex;
+        qof_book_set_data_fin (book, QUERY_INDEX_KEY, idx, index_free);
+        index_rebuild (idx, book);
+        return idx;
+    }
+
+    index_flush (idx, book);
+    /* Everything that reaches the collections goes through the hooks
+     * below, but don't hand out wrong answers if something slips by. */
+    if (idx->trans_dates.size () !=
+        qof_collection_count (qof_book_get_collection (book, GNC_ID_TRANS)) ||
+        idx->split_keys.size () !=
+        qof_collection_count (qof_book_get_collection (book, GNC_ID_SPLIT)))
+    {
+        PWARN ("query index out of step with book %p, rebuilding", book);
+        index_rebuild (idx, book);
+    }
+    return idx;
+}
+
+static QueryIndex *
+index_for_instance (QofInstance *inst)
+{
+    QofBook *book = qof_instance_get_book (inst);
+    if (!book || qof_book_shutting_down (book))
+        return NULL;
+    return static_cast<QueryIndex*>(qof_book_get_data (book, QUERY_INDEX_KEY));
+}
+
+void
+gnc_query_index_changed (QofInstance *inst)
+{
+    QueryIndex *idx;
+
+    g_return_if_fail (inst);
+    idx = index_for_instance (inst);
+    if (idx)
+        idx->pending.insert (inst);
+}
+
+void
+gnc_query_index_removed (QofInstance *inst)
+{
+    QueryIndex *idx;
+
+    g_return_if_fail (inst);
+    idx = index_for_instance (inst);
+    if (!idx)
+        return;
+    idx->pending.erase (inst);
+    if (GNC_IS_TRANSACTION (inst))
+        index_forget_trans (idx, GNC_TRANSACTION (inst));
+    else if (GNC_IS_SPLIT (inst))
+        index_forget_split (idx, GNC_SPLIT (inst));
+}
+
+/* ================================================================ */
+/* Recognizing indexable terms */
+
+static gboolean
+term_path_is (const QofQueryTerm *term, const char *first, const char *second)
+{
+    auto path = qof_query_term_get_param_path (term);
+    if (!path || g_strcmp0 (static_cast<const char*>(path->data), first))
+        return FALSE;
+    path = path->next;
+    if (!second)
+        return path == NULL;
+    return path && !g_strcmp0 (static_cast<const char*>(path->data), second) &&
+        !path->next;
+}
+
+static QofQueryPredData *
+term_pred_data (const QofQueryTerm *term, const char *type)
+{
+    if (qof_query_term_is_inverted (term))
+        return NULL;
+    auto pd = qof_query_term_get_pred_data (term);
+    if (!pd || g_strcmp0 (pd->type_name, type))
+        return NULL;
+    return pd;
+}
+
+/* Narrow range by a date term; FALSE if it can't be looked up. */
+static gboolean
+date_term_narrow (QofQueryPredData *pd, KeyRange<time64>& range)
+{
+    auto pdata = reinterpret_cast<query_date_t>(pd);
+    time64 lo = pdata->date.tv_sec - DATE_SLOP;
+    time64 hi = pdata->date.tv_sec + DATE_SLOP;
+    bool set_lo = false, set_hi = false;
+
+    switch (pd->how)
+    {
+    case QOF_COMPARE_LT:
+    case QOF_COMPARE_LTE:
+        set_hi = true;
+        break;
+    case QOF_COMPARE_GT:
+    case QOF_COMPARE_GTE:
+        set_lo = true;
+        break;
+    case QOF_COMPARE_EQUAL:
+        set_lo = set_hi = true;
+        break;
+    default:
+        return FALSE;
+    }
+    if (set_lo && (!range.has_lo || lo > range.lo))
+    {
+        range.has_lo = true;
+        range.lo = lo;
+    }
+    if (set_hi && (!range.has_hi || hi < range.hi))
+    {
+        range.has_hi = true;
+        range.hi = hi;
+    }
+    return TRUE;
+}
+
+/* Narrow range by a numeric term, which compares the absolute value of
+ * the parameter; FALSE if it can't be looked up. */
+static gboolean
+numeric_term_narrow (QofQueryPredData *pd, KeyRange<gnc_numeric>& range)
+{
+    auto pdata = reinterpret_cast<query_numeric_t>(pd);
+    gnc_numeric lo = pdata->amount, hi = pdata->amount;
+    bool set_lo = false, set_hi = false;
+
+    if (gnc_numeric_check (pdata->amount))
+        return FALSE;
+
+    switch (pd->how)
+    {
+    case QOF_COMPARE_LT:
+    case QOF_COMPARE_LTE:
+        set_hi = true;
+        break;
+    case QOF_COMPARE_GT:
+    case QOF_COMPARE_GTE:
+        set_lo = true;
+        break;
+    case QOF_COMPARE_EQUAL:
+    {
+        /* numeric_match_predicate's epsilon is 1/10000, after rounding. */
+        gnc_numeric slop = gnc_numeric_create (2, 10000);
+        gnc_numeric amount = gnc_numeric_abs (pdata->amount);
+        lo = gnc_numeric_sub (amount, slop, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+        hi = gnc_numeric_add (amount, slop, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+        if (gnc_numeric_check (lo) || gnc_numeric_check (hi))
+            return FALSE;
+        set_lo = set_hi = true;
+        break;
+    }
+    default:
+        return FALSE;
+    }
+    if (set_lo && (!range.has_lo || gnc_numeric_compare (lo, range.lo) > 0))
+    {
+        range.has_lo = true;
+        range.lo = lo;
+    }
+    if (set_hi && (!range.has_hi || gnc_numeric_compare (hi, range.hi) < 0))
+    {
+        range.has_hi = true;
+        range.hi = hi;
+    }
+    return TRUE;
+}
+
+/* ================================================================ */
+/* Looking up candidates */
+
+template <typename Func> static void
+trans_in_range (QueryIndex *idx, const KeyRange<time64>& range, Func func)
+{
+    auto it = range.has_lo ?
+        idx->trans_by_date.lower_bound (DateIndex::value_type (range.lo, nullptr)) :
+        idx->trans_by_date.begin ();
+    for (; it != idx->trans_by_date.end (); ++it)
+    {
+        if (range.has_hi && it->first > range.hi)
+            break;
+        func (it->second);
+    }
+}
+
+static GList *
+splits_in_range (QueryIndex *idx, const NumericIndex& index,
+                 const KeyRange<gnc_numeric>& range)
+{
+    GList *splits = NULL;
+    auto it = range.has_lo ?
+        index.lower_bound (NumericIndex::value_type (range.lo, nullptr)) : index.begin ();
+    for (; it != index.end (); ++it)
+    {
+        if (range.has_hi && gnc_numeric_compare (it->first, range.hi) > 0)
+            break;
+        splits = g_list_prepend (splits, it->second);
+    }
+    for (auto split : idx->unkeyed)
+        splits = g_list_prepend (splits, split);
+    return splits;
+}
+
+static GList *
+splits_in_accounts (QofBook *book, QofQueryPredData *pd)
+{
+    auto pdata = reinterpret_cast<query_guid_t>(pd);
+    std::unordered_set<Account*> accounts;
+    GList *splits = NULL;
+
+    for (auto node = pdata->guids; node; node = node->next)
+    {
+        auto acc = xaccAccountLookup (static_cast<GncGUID*>(node->data), book);
+        if (!acc)
+            continue;
+        accounts.insert (acc);
+        for (auto snode = xaccAccountGetSplitList (acc); snode;
+             snode = snode->next)
+            splits = g_list_prepend (splits, snode->data);
+    }
+
+    /* An account's split list changes only when the transaction is
+     * committed.  Add the splits an open edit has moved into one of
+     * the accounts; those it moved out are still listed, and the term
+     * check drops them. */
+    for (auto split : index_for_book (book)->moving)
+        if (accounts.count (xaccSplitGetAccount (split)))
+            splits = g_list_prepend (splits, split);
+    return splits;
+}
+
+/* Account matches are the most selective, so they are preferred; then
+ * date-posted ranges, then amount and value ranges. */
+static GList *
+split_query_candidates (QofBook *book, GList *and_terms, gboolean *served)
+{
+    QofQueryPredData *account_pd = NULL;
+    KeyRange<time64> dates;
+    KeyRange<gnc_numeric> amounts, values;
+    bool have_dates = false, have_amounts = false, have_values = false;
+    QueryIndex *idx;
+    GList *splits = NULL;
+
+    for (auto node = and_terms; node; node = node->next)
+    {
+        auto term = static_cast<const QofQueryTerm*>(node->data);
+        QofQueryPredData *pd;
+
+        if (term_path_is (term, SPLIT_ACCOUNT, QOF_PARAM_GUID) &&
+            (pd = term_pred_data (term, QOF_TYPE_GUID)) &&
+            reinterpret_cast<query_guid_t>(pd)->options == QOF_GUID_MATCH_ANY)
+            account_pd = pd;
+        else if (term_path_is (term, SPLIT_TRANS, TRANS_DATE_POSTED) &&
+                 (pd = term_pred_data (term, QOF_TYPE_DATE)))
+            have_dates |= date_term_narrow (pd, dates);
+        else if (term_path_is (term, SPLIT_AMOUNT, NULL) &&
+                 (pd = term_pred_data (term, QOF_TYPE_NUMERIC)))
+            have_amounts |= numeric_term_narrow (pd, amounts);
+        else if (term_path_is (term, SPLIT_VALUE, NULL) &&
+                 (pd = term_pred_data (term, QOF_TYPE_NUMERIC)))
+            have_values |= numeric_term_narrow (pd, values);
+    }
+
+    if (account_pd)
+    {
+        *served = TRUE;
+        return splits_in_accounts (book, account_pd);
+    }
+    if (!have_dates && !have_amounts && !have_values)
+    {
+        *served = FALSE;
+        return NULL;
+    }
+
+    *served = TRUE;
+    idx = index_for_book (book);
+    if (have_dates)
+    {
+        trans_in_range (idx, dates, [&splits](Transaction *trans)
+        {
+            for (auto node = xaccTransGetSplitList (trans); node;
+                 node = node->next)
+                splits = g_list_prepend (splits, node->data);
+        });
+        return splits;
+    }
+    if (have_amounts)
+        return splits_in_range (idx, idx->splits_by_amount, amounts);
+    return splits_in_range (idx, idx->splits_by_value, values);
+}
+
+static GList *
+trans_query_candidates (QofBook *book, GList *and_terms, gboolean *served)
+{
+    KeyRange<time64> dates;
+    bool have_dates = false;
+    GList *trans_list = NULL;
+
+    for (auto node = and_terms; node; node = node->next)
+    {
+        auto term = static_cast<const QofQueryTerm*>(node->data);
+        QofQueryPredData *pd;
+
+        if (term_path_is (term, TRANS_DATE_POSTED, NULL) &&
+            (pd = term_pred_data (term, QOF_TYPE_DATE)))
+            have_dates |= date_term_narrow (pd, dates);
+    }
+
+    *served = have_dates;
+    if (!have_dates)
+        return NULL;
+
+    trans_in_range (index_for_book (book), dates,
+                    [&trans_list](Transaction *trans)
+                    {
+                        trans_list = g_list_prepend (trans_list, trans);
+                    });
+    return trans_list;
+}
+
+gboolean
+gnc_query_index_register (void)
+{
+    qof_query_register_index (GNC_ID_SPLIT, split_query_candidates);
+    qof_query_register_index (GNC_ID_TRANS, trans_query_candidates);
+    return TRUE;
+}
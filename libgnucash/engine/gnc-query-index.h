@@ -0,0 +1,61 @@
+/********************************************************************
+ * gnc-query-index.h -- secondary indexes for split and transaction *
+ *                      queries                                     *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ *******************************************************************/
+
+/** @file gnc-query-index.h
+ *
+ * This is an engine-private header.  It lets qof_query_run look up
+ * the splits or transactions that can match a query's date-posted,
+ * account and amount terms instead of checking every one in the book.
+ *
+ * The indexes are built per book the first time a query needs them.
+ * After that the engine keeps them current by reporting every split
+ * and transaction it creates, changes or frees; nothing is re-keyed
+ * until the next query, so a burst of edits costs one update each.
+ */
+
+#ifndef GNC_QUERY_INDEX_H
+#define GNC_QUERY_INDEX_H
+
+#include <glib.h>
+#include "qof.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Register the query planners for GNC_ID_SPLIT and GNC_ID_TRANS. */
+gboolean gnc_query_index_register (void);
+
+/** Note that a split or transaction was created or may have changed
+ * one of its indexed values (date posted, account, amount, value). */
+void gnc_query_index_changed (QofInstance *inst);
+
+/** Forget a split or transaction that is being freed. */
+void gnc_query_index_removed (QofInstance *inst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNC_QUERY_INDEX_H */
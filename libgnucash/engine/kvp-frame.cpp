@@ -103,6 +103,7 @@ KvpValue *
 KvpFrame::set_impl (std::string const & key, KvpValue * value) noexcept
 {
     KvpValue * ret {};
+    mark_changed (key);
     auto spot = m_valuemap.find (key.c_str ());
     if (spot != m_valuemap.end ())
     {
@@ -154,6 +155,55 @@ KvpFrameImpl::get_slot (Path path) noexcept
     return nullptr;
 }
 
+bool
+KvpFrameImpl::has_changes () const noexcept
+{
+    if (m_all_changed || (m_changed && !m_changed->empty ()))
+        return true;
+    return std::any_of (m_valuemap.begin (), m_valuemap.end (),
+        [](const map_type::value_type & a)
+        {
+            return a.second->get_type () == KvpValue::Type::FRAME &&
+                a.second->get <KvpFrame*> ()->has_changes ();
+        });
+}
+
+std::vector<std::string>
+KvpFrameImpl::get_changed_keys () const noexcept
+{
+    if (m_all_changed)
+        return get_keys ();
+    std::vector<std::string> ret;
+    if (m_changed)
+        ret.assign (m_changed->begin (), m_changed->end ());
+    for (auto const & a : m_valuemap)
+    {
+        if (slot_replaced (a.first))
+            continue;
+        if (a.second->get_type () == KvpValue::Type::FRAME &&
+            a.second->get <KvpFrame*> ()->has_changes ())
+            ret.emplace_back (a.first);
+    }
+    return ret;
+}
+
+bool
+KvpFrameImpl::slot_replaced (std::string const & key) const noexcept
+{
+    return m_all_changed ||
+        (m_changed && m_changed->find (key) != m_changed->end ());
+}
+
+void
+KvpFrameImpl::clear_changes () noexcept
+{
+    m_changed.reset ();
+    m_all_changed = false;
+    for (auto const & a : m_valuemap)
+        if (a.second->get_type () == KvpValue::Type::FRAME)
+            a.second->get <KvpFrame*> ()->clear_changes ();
+}
+
 std::string
 KvpFrameImpl::to_string() const noexcept
 {
@@ -86,6 +86,8 @@
 
 #include "kvp-value.hpp"
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 #include <cstring>
@@ -226,8 +228,50 @@ struct KvpFrameImpl
     bool empty() const noexcept { return m_valuemap.empty(); }
     friend int compare(const KvpFrameImpl&, const KvpFrameImpl&) noexcept;
 
+    /** @name Change tracking
+     * Each frame records the keys set or deleted in it so that a backend
+     * can write only the slots that changed since it last saved or loaded
+     * the frame. A new or copied frame starts out with everything changed.
+     * @{
+     */
+    /** Record that the slot at key changed. set() and set_path() do this,
+     * but they can't see a value changed in place: code that edits the
+     * GList held by a GLIST value, or adds to a value with
+     * KvpValue::add(), must call this for the slot's key afterwards or the
+     * change won't be saved.
+     */
+    void mark_changed (std::string const & key) noexcept
+    {
+        if (m_all_changed)
+            return;
+        if (!m_changed)
+            m_changed.reset (new std::set<std::string>);
+        m_changed->insert (key);
+    }
+    void mark_all_changed () noexcept { m_all_changed = true; }
+    /** @return true if the whole frame must be treated as changed. */
+    bool all_changed () const noexcept { return m_all_changed; }
+    /** The keys in this frame whose slots changed, including any that
+     * have since been deleted and any holding a frame that changed. Deleted
+     * keys aren't known once the whole frame is changed, so check
+     * all_changed() first.
+     */
+    std::vector<std::string> get_changed_keys () const noexcept;
+    /** @return true if the slot at key was itself set or deleted, as
+     * opposed to only something in a frame below it changing.
+     */
+    bool slot_replaced (std::string const & key) const noexcept;
+    /** Forget all recorded changes here and in every nested frame. */
+    void clear_changes () noexcept;
+    /** @} */
+
     private:
     map_type m_valuemap;
+    /* Allocated on the first change so that unchanged frames stay small. */
+    std::unique_ptr<std::set<std::string>> m_changed;
+    bool m_all_changed {true};
+
+    bool has_changes () const noexcept;
 
     KvpFrame * get_child_frame_or_nullptr (Path const &) noexcept;
     KvpFrame * get_child_frame_or_create (Path const &) noexcept;
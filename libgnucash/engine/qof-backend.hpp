@@ -227,6 +227,25 @@ public:
  *    better to wait for the query).
  */
     virtual void load (QofBook*, QofBackendLoadType) = 0;
+/**
+ *    Called by qof_query_run before it searches the book, so that a backend
+ *    that deferred some of its data at load time can fetch whatever the
+ *    query might match. Backends that load everything need do nothing.
+ */
+    virtual void load_for_query (QofBook*, QofQuery*) {}
+/**
+ *    Sum the amounts of an account's splits by date posted, so that the
+ *    engine needn't have every split in memory to report balances. sums[0]
+ *    gets the total of the splits posted before bounds[0] and sums[i] that
+ *    of the splits posted from bounds[i - 1] up to bounds[i]; bounds is in
+ *    ascending order.
+ *
+ *    Returns false if the engine should add up its own splits instead,
+ *    which is what backends that load everything want.
+ */
+    virtual bool sum_split_amounts (const QofInstance*,
+                                    const std::vector<time64>&,
+                                    std::vector<gnc_numeric>&) { return false; }
 /**
  *    Called when the engine is about to make a change to a data structure. It
  *    could provide an advisory lock on data, but no backend does this.
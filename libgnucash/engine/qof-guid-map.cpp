@@ -0,0 +1,182 @@
+/********************************************************************
+ * qof-guid-map.cpp -- open-addressing table of instances by GUID   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ *******************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <stdint.h>
+#include <string.h>
+}
+
+#include "qof-guid-map.hpp"
+
+#include <algorithm>
+
+static char removed_marker;
+QofInstance* const QofGuidMap::s_removed =
+    reinterpret_cast<QofInstance*>(&removed_marker);
+
+static const std::size_t npos = static_cast<std::size_t>(-1);
+static const std::size_t min_capacity = 16;
+
+static inline std::size_t
+home_slot (const GncGUID& guid, unsigned shift) noexcept
+{
+    uint64_t low, high;
+    memcpy (&low, guid.reserved, sizeof low);
+    memcpy (&high, guid.reserved + sizeof low, sizeof high);
+    return static_cast<std::size_t>(((low ^ high) *
+                                     UINT64_C(0x9e3779b97f4a7c15)) >> shift);
+}
+
+static inline bool
+same_guid (const GncGUID& a, const GncGUID& b) noexcept
+{
+    return memcmp (a.reserved, b.reserved, GUID_DATA_SIZE) == 0;
+}
+
+/* The slot holding guid, or npos if it isn't in the table. */
+std::size_t
+QofGuidMap::find (const GncGUID& guid) const noexcept
+{
+    if (m_slots.empty ())
+        return npos;
+    auto mask = m_slots.size () - 1;
+    for (auto index = home_slot (guid, m_shift); ; index = (index + 1) & mask)
+    {
+        auto& slot = m_slots[index];
+        if (!slot.inst)
+            return npos;
+        if (slot.inst != s_removed && same_guid (slot.guid, guid))
+            return index;
+    }
+}
+
+QofInstance*
+QofGuidMap::lookup (const GncGUID& guid) const noexcept
+{
+    auto index = find (guid);
+    if (index != npos)
+        return m_slots[index].inst;
+    for (auto& slot : m_added)
+        if (same_guid (slot.guid, guid))
+            return slot.inst;
+    return nullptr;
+}
+
+void
+QofGuidMap::insert (const GncGUID& guid, QofInstance* inst)
+{
+    g_return_if_fail (inst && inst != s_removed);
+
+    auto index = find (guid);
+    if (index != npos)
+    {
+        m_slots[index].inst = inst;
+        return;
+    }
+    if (m_walks)
+    {
+        auto added = std::find_if (m_added.begin (), m_added.end (),
+                                   [&guid](const Slot& slot) {
+                                       return same_guid (slot.guid, guid);
+                                   });
+        if (added != m_added.end ())
+            added->inst = inst;
+        else
+            m_added.push_back ({guid, inst});
+        return;
+    }
+
+    /* Keep at least a quarter of the slots empty so probes stay short. */
+    if ((m_used + 1) * 4 > m_slots.size () * 3)
+        rebuild (m_size + 1);
+
+    auto mask = m_slots.size () - 1;
+    index = home_slot (guid, m_shift);
+    while (m_slots[index].inst && m_slots[index].inst != s_removed)
+        index = (index + 1) & mask;
+    if (!m_slots[index].inst)
+        ++m_used;
+    m_slots[index] = {guid, inst};
+    ++m_size;
+}
+
+bool
+QofGuidMap::remove (const GncGUID& guid) noexcept
+{
+    auto index = find (guid);
+    if (index != npos)
+    {
+        /* Emptying the slot would cut the probe chains running through
+         * it, so mark it instead. */
+        m_slots[index].inst = s_removed;
+        --m_size;
+        return true;
+    }
+    auto added = std::find_if (m_added.begin (), m_added.end (),
+                               [&guid](const Slot& slot) {
+                                   return same_guid (slot.guid, guid);
+                               });
+    if (added == m_added.end ())
+        return false;
+    m_added.erase (added);
+    return true;
+}
+
+/* Rehash into a table with room for count instances, dropping the
+ * markers left by removals. */
+void
+QofGuidMap::rebuild (std::size_t count)
+{
+    std::size_t capacity = min_capacity;
+    unsigned shift = 64 - 4;
+    while (capacity < count * 2)
+    {
+        capacity *= 2;
+        --shift;
+    }
+
+    std::vector<Slot> old (capacity, Slot {{}, nullptr});
+    std::swap (old, m_slots);
+    m_shift = shift;
+    m_used = m_size;
+    auto mask = capacity - 1;
+    for (auto& slot : old)
+    {
+        if (!slot.inst || slot.inst == s_removed)
+            continue;
+        auto index = home_slot (slot.guid, m_shift);
+        while (m_slots[index].inst)
+            index = (index + 1) & mask;
+        m_slots[index] = slot;
+    }
+}
+
+void
+QofGuidMap::insert_added ()
+{
+    std::vector<Slot> added;
+    std::swap (added, m_added);
+    for (auto& slot : added)
+        insert (slot.guid, slot.inst);
+}
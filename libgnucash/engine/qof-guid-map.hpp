@@ -0,0 +1,99 @@
+/********************************************************************
+ * qof-guid-map.hpp -- open-addressing table of instances by GUID   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ *******************************************************************/
+
+#ifndef __QOF_GUID_MAP_HPP__
+#define __QOF_GUID_MAP_HPP__
+
+#include "guid.h"
+#include "qofinstance.h"
+
+#include <cstddef>
+#include <vector>
+
+/** @ingroup Entity
+ *  @brief The table of a QofCollection's instances by GUID.
+ *
+ * The GUIDs are stored in the table itself rather than pointed to, and
+ * since they are random their own bits make the hash, with a
+ * multiplication to spread any that weren't. Collisions probe linearly.
+ * A slot holds 24 bytes, so a lookup usually touches one cache line.
+ *
+ * for_each() walks the table in place without copying it. The callback
+ * may remove any instance, which leaves a marker behind until the table
+ * is next rebuilt; instances it adds are held aside until the walk is
+ * over, so like the snapshot the collection used to take, a walk never
+ * visits what was added during it.
+ */
+class QofGuidMap
+{
+public:
+    QofGuidMap() = default;
+    QofGuidMap(const QofGuidMap&) = delete;
+    QofGuidMap& operator=(const QofGuidMap&) = delete;
+
+    /** @return The instance with guid, or nullptr if there isn't one. */
+    QofInstance* lookup (const GncGUID& guid) const noexcept;
+    /** Adds inst under guid, replacing any instance already there. */
+    void insert (const GncGUID& guid, QofInstance* inst);
+    /** @return false if there was no instance with guid. */
+    bool remove (const GncGUID& guid) noexcept;
+    /** @return The number of instances in the table. */
+    std::size_t size () const noexcept { return m_size + m_added.size(); }
+
+    /** Calls func on every instance in the table; see above for what it
+     * may do to the table meanwhile. */
+    template <typename Func> void for_each (Func func)
+    {
+        ++m_walks;
+        for (std::size_t index = 0; index < m_slots.size(); ++index)
+        {
+            auto inst = m_slots[index].inst;
+            if (inst && inst != s_removed)
+                func (inst);
+        }
+        if (--m_walks == 0 && !m_added.empty())
+            insert_added ();
+    }
+
+private:
+    struct Slot
+    {
+        GncGUID guid;
+        QofInstance* inst;  /* nullptr if empty, s_removed if removed */
+    };
+
+    std::size_t find (const GncGUID& guid) const noexcept;
+    void rebuild (std::size_t count);
+    void insert_added ();
+
+    static QofInstance* const s_removed;
+
+    std::vector<Slot> m_slots;
+    unsigned m_shift = 0;       /* 64 less the log2 of the capacity */
+    std::size_t m_size = 0;     /* instances in m_slots */
+    std::size_t m_used = 0;     /* slots that aren't empty */
+    unsigned m_walks = 0;
+    /* Instances added while for_each() is running. */
+    std::vector<Slot> m_added;
+};
+
+#endif /* __QOF_GUID_MAP_HPP__ */
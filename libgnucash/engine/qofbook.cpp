@@ -386,12 +386,17 @@ qof_book_destroy (QofBook *book)
     book->shutting_down = TRUE;
     qof_event_force (&book->inst, QOF_EVENT_DESTROY, NULL);
 
+    /* Everything in the book is about to go: listeners have been told
+     * about the book itself, so spare them an event per instance. */
+    qof_event_suspend ();
+
     /* Call the list of finalizers, let them do their thing.
      * Do this before tearing into the rest of the book.
      */
     g_hash_table_foreach (book->data_table_finalizers, book_final, book);
 
     qof_object_book_end (book);
+    qof_event_resume ();
 
     g_hash_table_destroy (book->data_table_finalizers);
     book->data_table_finalizers = NULL;
@@ -293,7 +293,9 @@ GDate* qof_book_get_autoreadonly_gdate (const QofBook *book);
  *  if it uses transaction number field */
 gboolean qof_book_use_split_action_for_num_field (const QofBook *book);
 
-/** Is the book shutting down? */
+/** Is the book shutting down?  While it is, qof_book_destroy() is
+ *  releasing its instances wholesale: edits no longer reach the backend
+ *  or mark the book dirty, and no per-instance events are sent. */
 gboolean qof_book_shutting_down (const QofBook *book);
 
 /** qof_book_not_saved() returns the value of the session_dirty flag,
@@ -83,6 +83,15 @@ void qof_instance_reset_editlevel (gpointer ptr);
  *  @param value The new value to be set for this object. */
 void qof_instance_set_destroying (gpointer ptr, gboolean value);
 
+/** Set the flag that indicates whether or not this object has yet to be
+ *  saved by the backend. Backends that write an object some time after it
+ *  has been committed use this to have it inserted rather than updated.
+ *
+ *  @param ptr The object whose flag should be set.
+ *
+ *  @param value The new value to be set for this object. */
+void qof_instance_set_infant (gpointer ptr, gboolean value);
+
 /** \brief Set the dirty flag
 Sets this instance AND the collection as dirty.
 */
@@ -595,6 +595,8 @@ qof_instance_set_slots (QofInstance *inst, KvpFrame *frm)
 
     priv->dirty = TRUE;
     inst->kvp_data = frm;
+    if (frm)
+        frm->mark_all_changed ();
 }
 
 void
@@ -728,6 +730,13 @@ qof_instance_get_infant(const QofInstance *inst)
     return GET_PRIVATE(inst)->infant;
 }
 
+void
+qof_instance_set_infant (gpointer ptr, gboolean value)
+{
+    g_return_if_fail(QOF_IS_INSTANCE(ptr));
+    GET_PRIVATE(ptr)->infant = value;
+}
+
 gint32
 qof_instance_get_version (gconstpointer inst)
 {
@@ -969,7 +978,7 @@ qof_begin_edit (QofInstance *inst)
         priv->editlevel = 1;
 
     auto be = qof_book_get_backend(priv->book);
-    if (be)
+    if (be && !qof_book_shutting_down(priv->book))
         be->begin(inst);
     else
         priv->dirty = TRUE;
@@ -1004,15 +1013,18 @@ qof_commit_edit_part2(QofInstance *inst,
     QofInstancePrivate *priv;
 
     priv = GET_PRIVATE(inst);
+    /* A book being destroyed is released wholesale; there's nothing left
+     * to save about it. */
+    auto shutting_down = qof_book_shutting_down(priv->book);
 
-    if (priv->dirty &&
+    if (priv->dirty && !shutting_down &&
         !(priv->infant && priv->do_free)) {
       qof_collection_mark_dirty(priv->collection);
       qof_book_mark_session_dirty(priv->book);
     }
 
     /* See if there's a backend.  If there is, invoke it. */
-    auto be = qof_book_get_backend(priv->book);
+    auto be = shutting_down ? nullptr : qof_book_get_backend(priv->book);
     if (be)
     {
         QofBackendError errcode;
@@ -1121,6 +1133,8 @@ void
 qof_instance_swap_kvp (QofInstance *a, QofInstance *b)
 {
     std::swap(a->kvp_data, b->kvp_data);
+    a->kvp_data->mark_all_changed ();
+    b->kvp_data->mark_all_changed ();
 }
 
 int
@@ -1227,6 +1241,7 @@ qof_instance_kvp_remove_guid (const QofInstance *inst, const char *path,
             {
                 list = g_list_delete_link (list, node);
                 v->set(list);
+                inst->kvp_data->mark_changed (path);
                 delete val;
                 break;
             }
@@ -1256,7 +1271,10 @@ qof_instance_kvp_merge_guids (const QofInstance *target,
     {
     case KvpValue::Type::FRAME:
         if (target_val)
+        {
             target_val->add(v);
+            target->kvp_data->mark_changed (path);
+        }
         else
             target->kvp_data->set_path({path}, v);
         donor->kvp_data->set({path}, nullptr); //Contents moved, Don't delete!
@@ -1267,6 +1285,7 @@ qof_instance_kvp_merge_guids (const QofInstance *target,
             auto list = target_val->get<GList*>();
             list = g_list_concat(list, v->get<GList*>());
             target_val->set(list);
+            target->kvp_data->mark_changed (path);
         }
         else
             target->kvp_data->set({path}, v);
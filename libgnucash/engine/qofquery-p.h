@@ -57,6 +57,22 @@ QofQueryParamList * qof_query_term_get_param_path (const QofQueryTerm *queryterm
 QofQueryPredData *qof_query_term_get_pred_data (const QofQueryTerm *queryterm);
 gboolean qof_query_term_is_inverted (const QofQueryTerm *queryterm);
 
+/* Query indexes.  An object type can register a function that narrows
+ * a search of one book down to the instances that might satisfy a list
+ * of ANDed terms, using whatever indexes it keeps, so that the query
+ * checks its terms against those instead of every instance.
+ *
+ * The function returns the candidates as a list that the caller frees
+ * and sets *served to TRUE; all of the terms are still checked against
+ * each of them.  If none of the terms can be looked up it sets *served
+ * to FALSE and the query scans everything as usual.
+ */
+typedef GList * (*QofQueryIndexFunc) (QofBook *book, GList *and_terms,
+                                      gboolean *served);
+
+void qof_query_register_index (QofIdTypeConst obj_type,
+                               QofQueryIndexFunc func);
+
 
 /* Functions to get and look at QuerySorts */
 
@@ -32,6 +32,9 @@ extern "C"
 #include <string.h>
 }
 
+#include <unordered_set>
+#include <vector>
+
 #include "qof.h"
 #include "qof-backend.hpp"
 #include "qofbook-p.h"
@@ -41,6 +44,9 @@ extern "C"
 
 static QofLogModule log_module = QOF_MOD_QUERY;
 
+/* QofQueryIndexFunc by object type */
+static GHashTable *query_index_funcs = NULL;
+
 struct _QofQueryTerm
 {
     QofQueryParamList *     param_list;
@@ -363,53 +369,53 @@ sort_func (const gconstpointer a, const gconstpointer b, const gpointer q)
  */
 
 static int
-check_object (const QofQuery *q, gpointer object)
+check_and_terms (const GList *and_terms, gpointer object)
 {
     const GList     * and_ptr;
-    const GList     * or_ptr;
     const QofQueryTerm * qt;
-    int       and_terms_ok = 1;
 
-    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    for (and_ptr = and_terms; and_ptr;
+         and_ptr = static_cast<GList*>(and_ptr->next))
     {
-        and_terms_ok = 1;
-        for (and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
-	     and_ptr = static_cast<GList*>(and_ptr->next))
+        qt = (QofQueryTerm *)(and_ptr->data);
+        if (qt->param_fcns && qt->pred_fcn)
         {
-            qt = (QofQueryTerm *)(and_ptr->data);
-            if (qt->param_fcns && qt->pred_fcn)
-            {
-                const GSList *node;
-                QofParam *param = NULL;
-                gpointer conv_obj = object;
+            const GSList *node;
+            QofParam *param = NULL;
+            gpointer conv_obj = object;
 
-                /* iterate through the conversions */
-                for (node = qt->param_fcns; node; node = node->next)
-                {
-                    param = static_cast<QofParam*>(node->data);
-
-                    /* The last term is the actual parameter getter */
-                    if (!node->next) break;
+            /* iterate through the conversions */
+            for (node = qt->param_fcns; node; node = node->next)
+            {
+                param = static_cast<QofParam*>(node->data);
 
-                    conv_obj = param->param_getfcn (conv_obj, param);
-                }
+                /* The last term is the actual parameter getter */
+                if (!node->next) break;
 
-                if (((qt->pred_fcn)(conv_obj, param, qt->pdata)) == qt->invert)
-                {
-                    and_terms_ok = 0;
-                    break;
-                }
-            }
-            else
-            {
-                /* XXX: Don't know how to do this conversion -- do we care? */
+                conv_obj = param->param_getfcn (conv_obj, param);
             }
+
+            if (((qt->pred_fcn)(conv_obj, param, qt->pdata)) == qt->invert)
+                return 0;
         }
-        if (and_terms_ok)
+        else
         {
-            return 1;
+            /* XXX: Don't know how to do this conversion -- do we care? */
         }
     }
+    return 1;
+}
+
+static int
+check_object (const QofQuery *q, gpointer object)
+{
+    const GList     * or_ptr;
+
+    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    {
+        if (check_and_terms (static_cast<GList*>(or_ptr->data), object))
+            return 1;
+    }
 
     /* If there are no terms, assume a "match any" applies.
      * A query with no terms is still meaningful, since the user
@@ -815,6 +821,65 @@ static GList * qof_query_run_internal (QofQuery *q,
     return matching_objects;
 }
 
+/* Check only the instances that the search type's index says might
+ * match each OR-term.  Returns FALSE, having done nothing, if some term
+ * can't be served from the index. */
+static gboolean
+query_run_indexed (QofQueryCB* qcb, QofBook *book)
+{
+    struct Candidates
+    {
+        GList *and_terms;
+        GList *objects;
+    };
+    QofQuery *q = qcb->query;
+    QofQueryIndexFunc index_func;
+    std::vector<Candidates> candidates;
+    std::unordered_set<gpointer> matched;
+
+    if (!query_index_funcs || !q->terms)
+        return FALSE;
+    index_func = reinterpret_cast<QofQueryIndexFunc>(
+        g_hash_table_lookup (query_index_funcs, q->search_for));
+    if (!index_func)
+        return FALSE;
+
+    for (auto or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    {
+        Candidates c {static_cast<GList*>(or_ptr->data), nullptr};
+        gboolean served = FALSE;
+
+        c.objects = index_func (book, c.and_terms, &served);
+        if (!served)
+        {
+            g_list_free (c.objects);
+            for (auto& prev : candidates)
+                g_list_free (prev.objects);
+            return FALSE;
+        }
+        candidates.push_back (c);
+    }
+
+    for (auto& c : candidates)
+    {
+        for (auto node = c.objects; node; node = node->next)
+        {
+            if (!node->data || matched.count (node->data))
+                continue;
+            if (check_and_terms (c.and_terms, node->data))
+            {
+                matched.insert (node->data);
+                qcb->list = g_list_prepend (qcb->list, node->data);
+                qcb->count++;
+            }
+        }
+        g_list_free (c.objects);
+    }
+    PINFO ("index served %d OR-terms, %d matches",
+           static_cast<int>(candidates.size()), qcb->count);
+    return TRUE;
+}
+
 static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
 {
     GList *node;
@@ -840,9 +905,16 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
             }
         }
 #endif
-        /* And then iterate over all the objects */
-        qof_object_foreach (qcb->query->search_for, book,
-                            (QofInstanceForeachCB) check_item_cb, qcb);
+        /* Give a backend that loads on demand the chance to bring in
+         * what the query might match. */
+        if (book->backend)
+            book->backend->load_for_query (book, qcb->query);
+
+        /* And then iterate over all the objects, or over those the
+         * index picks out if it can. */
+        if (!query_run_indexed (qcb, book))
+            qof_object_foreach (qcb->query->search_for, book,
+                                (QofInstanceForeachCB) check_item_cb, qcb);
     }
 }
 
@@ -1350,10 +1422,27 @@ void qof_query_init (void)
 
 void qof_query_shutdown (void)
 {
+    if (query_index_funcs)
+        g_hash_table_destroy (query_index_funcs);
+    query_index_funcs = NULL;
     qof_class_shutdown ();
     qof_query_core_shutdown ();
 }
 
+void qof_query_register_index (QofIdTypeConst obj_type,
+                               QofQueryIndexFunc func)
+{
+    g_return_if_fail (obj_type);
+
+    if (!query_index_funcs)
+        query_index_funcs = g_hash_table_new (g_str_hash, g_str_equal);
+    if (func)
+        g_hash_table_insert (query_index_funcs, (gpointer)obj_type,
+                             reinterpret_cast<gpointer>(func));
+    else
+        g_hash_table_remove (query_index_funcs, obj_type);
+}
+
 int qof_query_get_max_results (const QofQuery *q)
 {
     if (!q) return 0;
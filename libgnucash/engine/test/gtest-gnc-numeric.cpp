@@ -21,6 +21,9 @@
 \********************************************************************/
 
 #include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
 #include "../gnc-numeric.hpp"
 #include "../gnc-rational.hpp"
 
@@ -538,3 +541,130 @@ TEST(gnc_numeric_functions, test_conversion_to_decimal)
     EXPECT_EQ(27434842, r.num());
     EXPECT_EQ(100, r.denom());
 }
+
+/* The sum of values, adding each in turn. gnc_numeric_sum() gives the same
+ * result unless one of the intermediate sums overflows. */
+static gnc_numeric
+fold_sum(const std::vector<gnc_numeric>& values, gint64 denom, gint how)
+{
+    if (values.empty())
+        return gnc_numeric_zero();
+    auto sum = values[0];
+    for (auto iter = values.begin() + 1; iter != values.end(); ++iter)
+        sum = gnc_numeric_add(sum, *iter, denom, how);
+    return sum;
+}
+
+TEST(gnc_numeric_functions, test_add_same_denom)
+{
+    auto fixed = GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER;
+    auto sum = gnc_numeric_add(gnc_numeric_create(150, 100),
+                               gnc_numeric_create(-275, 100),
+                               GNC_DENOM_AUTO, fixed);
+    EXPECT_EQ(-125, sum.num);
+    EXPECT_EQ(100, sum.denom);
+    sum = gnc_numeric_add(gnc_numeric_create(150, 100),
+                          gnc_numeric_create(-150, 100),
+                          GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    EXPECT_EQ(0, sum.num);
+    EXPECT_EQ(1, sum.denom);
+    sum = gnc_numeric_add(gnc_numeric_create(150, 100),
+                          gnc_numeric_create(275, 100),
+                          GNC_DENOM_AUTO, GNC_HOW_DENOM_REDUCE);
+    EXPECT_EQ(17, sum.num);
+    EXPECT_EQ(4, sum.denom);
+    sum = gnc_numeric_add(gnc_numeric_create(INT64_MAX, 100),
+                          gnc_numeric_create(1, 100), GNC_DENOM_AUTO, fixed);
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, gnc_numeric_check(sum));
+}
+
+TEST(gnc_numeric_functions, test_sum)
+{
+    auto fixed = GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER;
+    std::vector<gnc_numeric> values;
+    EXPECT_TRUE(gnc_numeric_zero_p(gnc_numeric_sum(values.data(), 0,
+                                                   GNC_DENOM_AUTO, fixed)));
+
+    values = {gnc_numeric_create(100, 100), gnc_numeric_create(250, 100),
+              gnc_numeric_create(-50, 100)};
+    auto sum = gnc_numeric_sum(values.data(), values.size(), GNC_DENOM_AUTO,
+                               fixed);
+    EXPECT_EQ(300, sum.num);
+    EXPECT_EQ(100, sum.denom);
+
+    /* The fast path never overflows in the middle of a run. */
+    values = {gnc_numeric_create(INT64_MAX, 100), gnc_numeric_create(1, 100),
+              gnc_numeric_create(-2, 100)};
+    sum = gnc_numeric_sum(values.data(), values.size(), GNC_DENOM_AUTO, fixed);
+    EXPECT_EQ(INT64_MAX - 1, sum.num);
+    EXPECT_EQ(100, sum.denom);
+    values.pop_back();
+    sum = gnc_numeric_sum(values.data(), values.size(), GNC_DENOM_AUTO, fixed);
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, gnc_numeric_check(sum));
+
+    values = {gnc_numeric_create(150, 100), gnc_numeric_create(-150, 100)};
+    sum = gnc_numeric_sum(values.data(), values.size(), GNC_DENOM_AUTO,
+                          GNC_HOW_DENOM_EXACT);
+    EXPECT_TRUE(gnc_numeric_eq(fold_sum(values, GNC_DENOM_AUTO,
+                                        GNC_HOW_DENOM_EXACT), sum));
+
+    values = {gnc_numeric_create(100, 100), gnc_numeric_error(GNC_ERROR_ARG),
+              gnc_numeric_create(250, 100)};
+    sum = gnc_numeric_sum(values.data(), values.size(), GNC_DENOM_AUTO, fixed);
+    EXPECT_EQ(GNC_ERROR_ARG, gnc_numeric_check(sum));
+}
+
+TEST(gnc_numeric_functions, test_sum_matches_add)
+{
+    std::vector<gnc_numeric> values;
+    const gint64 denoms[] = {100, 100, 100, 1000, 3, 100, 100, 7};
+    for (int i = 0; i < 1000; ++i)
+        values.push_back(gnc_numeric_create((i * 7919) % 200003 - 100000,
+                                            denoms[(i / 13) % 8]));
+    const gint hows[] = {GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER,
+                         GNC_HOW_DENOM_LCD,
+                         GNC_HOW_DENOM_EXACT,
+                         GNC_HOW_DENOM_REDUCE | GNC_HOW_RND_NEVER};
+    for (auto how : hows)
+    {
+        auto expected = fold_sum(values, GNC_DENOM_AUTO, how);
+        auto sum = gnc_numeric_sum(values.data(), values.size(),
+                                   GNC_DENOM_AUTO, how);
+        EXPECT_TRUE(gnc_numeric_equal(expected, sum));
+    }
+    auto expected = fold_sum(values, 100, GNC_HOW_RND_ROUND_HALF_UP);
+    auto sum = gnc_numeric_sum(values.data(), values.size(), 100,
+                               GNC_HOW_RND_ROUND_HALF_UP);
+    EXPECT_TRUE(gnc_numeric_eq(expected, sum));
+}
+
+/* Compares gnc_numeric_sum() with adding one value at a time. Run it with
+ * --gtest_also_run_disabled_tests. */
+TEST(gnc_numeric_functions, DISABLED_benchmark_sum)
+{
+    constexpr size_t count = 1000000;
+    constexpr int rounds = 20;
+    auto fixed = GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER;
+    std::vector<gnc_numeric> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        values.push_back(gnc_numeric_create(static_cast<gint64>(i % 20011) - 10000,
+                                            100));
+
+    gnc_numeric expected, sum;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round)
+        expected = fold_sum(values, GNC_DENOM_AUTO, fixed);
+    auto fold_time = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round)
+        sum = gnc_numeric_sum(values.data(), values.size(), GNC_DENOM_AUTO,
+                              fixed);
+    auto sum_time = std::chrono::steady_clock::now() - start;
+    EXPECT_TRUE(gnc_numeric_eq(expected, sum));
+
+    using ms = std::chrono::duration<double, std::milli>;
+    std::cout << "Summing " << count << " values: gnc_numeric_add "
+              << ms(fold_time).count() / rounds << " ms, gnc_numeric_sum "
+              << ms(sum_time).count() / rounds << " ms\n";
+}
@@ -392,3 +392,34 @@ TEST_F (ImapBayesTest, get_bayes_info)
     EXPECT_STREQ (info->count, "1");
 }
 
+
+/* Matches made after the account's tokens have been read reflect the
+ * entries added and deleted since. */
+TEST_F (ImapBayesTest, FindAccountBayesAfterChanges)
+{
+    GList * tokens {nullptr};
+    tokens = g_list_prepend (tokens, const_cast<char*> (foo));
+    gnc_account_imap_add_account_bayes (t_imap, t_list1, t_expense_account1);
+    auto account = gnc_account_imap_find_account_bayes (t_imap, tokens);
+    EXPECT_EQ (t_expense_account1, account);
+
+    for (int i = 0; i < 3; ++i)
+        gnc_account_imap_add_account_bayes (t_imap, tokens, t_expense_account2);
+    account = gnc_account_imap_find_account_bayes (t_imap, tokens);
+    EXPECT_EQ (t_expense_account2, account);
+
+    auto acct2_guid = guid_to_string (xaccAccountGetGUID(t_expense_account2));
+    auto path = std::string{IMAP_FRAME_BAYES} + "/" + foo + "/" + acct2_guid;
+    gnc_account_delete_map_entry (t_bank_account, g_strdup (path.c_str ()), FALSE);
+    account = gnc_account_imap_find_account_bayes (t_imap, tokens);
+    EXPECT_EQ (t_expense_account1, account);
+
+    /* Tokens are matched whole, not as a prefix of longer ones. */
+    GList * prefix {nullptr};
+    prefix = g_list_prepend (prefix, const_cast<char*> ("fo"));
+    account = gnc_account_imap_find_account_bayes (t_imap, prefix);
+    EXPECT_EQ (nullptr, account);
+    g_list_free (prefix);
+    g_list_free (tokens);
+    g_free (acct2_guid);
+}
@@ -0,0 +1,190 @@
+/********************************************************************
+ * gtest-qof-guid-map.cpp: Test the collections' GUID table.        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <qof.h>
+}
+
+#include <qof-guid-map.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+/* The table never looks inside its instances, so the tests stand in
+ * addresses of plain ints for them. */
+class GuidMapTest : public testing::Test
+{
+protected:
+    void SetUp() { fill (1000); }
+    /* Adds count GUIDs, moving the markers: fill before inserting. */
+    void fill (size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            m_guids.push_back (guid_new_return ());
+        m_markers.resize (m_guids.size ());
+    }
+    QofInstance* inst (size_t index)
+    {
+        return reinterpret_cast<QofInstance*>(&m_markers[index]);
+    }
+    void insert_all ()
+    {
+        for (size_t i = 0; i < m_guids.size (); ++i)
+            m_map.insert (m_guids[i], inst (i));
+    }
+
+    std::vector<int> m_markers;
+    std::vector<GncGUID> m_guids;
+    QofGuidMap m_map;
+};
+
+TEST_F(GuidMapTest, insert_lookup_remove)
+{
+    EXPECT_EQ(nullptr, m_map.lookup (m_guids[0]));
+    EXPECT_FALSE(m_map.remove (m_guids[0]));
+    insert_all ();
+    EXPECT_EQ(m_guids.size (), m_map.size ());
+    for (size_t i = 0; i < m_guids.size (); ++i)
+        EXPECT_EQ(inst (i), m_map.lookup (m_guids[i]));
+    EXPECT_EQ(nullptr, m_map.lookup (guid_new_return ()));
+
+    for (size_t i = 0; i < m_guids.size (); i += 2)
+        EXPECT_TRUE(m_map.remove (m_guids[i]));
+    EXPECT_EQ(m_guids.size () / 2, m_map.size ());
+    for (size_t i = 0; i < m_guids.size (); ++i)
+        EXPECT_EQ(i % 2 ? inst (i) : nullptr, m_map.lookup (m_guids[i]));
+
+    /* Inserting an existing GUID replaces its instance. */
+    m_map.insert (m_guids[1], inst (0));
+    EXPECT_EQ(inst (0), m_map.lookup (m_guids[1]));
+    EXPECT_EQ(m_guids.size () / 2, m_map.size ());
+
+    /* Removed slots are reused without losing the instances past them. */
+    for (size_t i = 0; i < m_guids.size (); i += 2)
+        m_map.insert (m_guids[i], inst (i));
+    EXPECT_EQ(m_guids.size (), m_map.size ());
+    for (size_t i = 2; i < m_guids.size (); ++i)
+        EXPECT_EQ(inst (i), m_map.lookup (m_guids[i]));
+}
+
+TEST_F(GuidMapTest, for_each)
+{
+    insert_all ();
+    std::vector<int> visits (m_guids.size ());
+    m_map.for_each ([&](QofInstance* ent) {
+            ++visits[reinterpret_cast<int*>(ent) - m_markers.data ()];
+        });
+    for (auto count : visits)
+        EXPECT_EQ(1, count);
+}
+
+TEST_F(GuidMapTest, for_each_removing)
+{
+    insert_all ();
+    size_t visits = 0;
+    m_map.for_each ([&](QofInstance* ent) {
+            auto index = reinterpret_cast<int*>(ent) - m_markers.data ();
+            ++visits;
+            EXPECT_TRUE(m_map.remove (m_guids[index]));
+            /* Take out a neighbour too, which mustn't be visited later. */
+            if (index + 1 < static_cast<ptrdiff_t>(m_guids.size ()))
+                m_map.remove (m_guids[index + 1]);
+        });
+    EXPECT_EQ(0u, m_map.size ());
+    EXPECT_GE(m_guids.size (), visits);
+    EXPECT_LE(m_guids.size () / 2, visits);
+}
+
+TEST_F(GuidMapTest, for_each_adding)
+{
+    auto count = m_guids.size ();
+    fill (count);
+    for (size_t i = 0; i < count; ++i)
+        m_map.insert (m_guids[i], inst (i));
+    size_t visits = 0;
+    m_map.for_each ([&](QofInstance* ent) {
+            auto index = visits++ + count;
+            m_map.insert (m_guids[index], inst (index));
+            EXPECT_EQ(inst (index), m_map.lookup (m_guids[index]));
+            EXPECT_TRUE(m_map.remove (m_guids[index]));
+            m_map.insert (m_guids[index], inst (index));
+        });
+    /* Nothing added during the walk is visited by it. */
+    EXPECT_EQ(count, visits);
+    EXPECT_EQ(2 * count, m_map.size ());
+    for (size_t i = 0; i < m_guids.size (); ++i)
+        EXPECT_EQ(inst (i), m_map.lookup (m_guids[i]));
+}
+
+/* Compares lookups and walks with the GHashTable the collections used to
+ * keep. Run it with --gtest_also_run_disabled_tests. */
+TEST_F(GuidMapTest, DISABLED_benchmark)
+{
+    using ms = std::chrono::duration<double, std::milli>;
+    const size_t count = 1000000;
+    const int rounds = 10;
+    m_guids.clear ();
+    m_markers.clear ();
+    fill (count);
+    insert_all ();
+    auto table = guid_hash_table_new ();
+    for (size_t i = 0; i < count; ++i)
+        g_hash_table_insert (table, &m_guids[i], inst (i));
+
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now ();
+    for (int round = 0; round < rounds; ++round)
+        for (auto& guid : m_guids)
+            found += g_hash_table_lookup (table, &guid) != nullptr;
+    auto table_lookup = std::chrono::steady_clock::now () - start;
+    start = std::chrono::steady_clock::now ();
+    for (int round = 0; round < rounds; ++round)
+        for (auto& guid : m_guids)
+            found += m_map.lookup (guid) != nullptr;
+    auto map_lookup = std::chrono::steady_clock::now () - start;
+    EXPECT_EQ(2 * rounds * count, found);
+
+    size_t visits = 0;
+    start = std::chrono::steady_clock::now ();
+    for (int round = 0; round < rounds; ++round)
+    {
+        auto values = g_hash_table_get_values (table);
+        for (auto node = values; node; node = node->next)
+            ++visits;
+        g_list_free (values);
+    }
+    auto table_walk = std::chrono::steady_clock::now () - start;
+    start = std::chrono::steady_clock::now ();
+    for (int round = 0; round < rounds; ++round)
+        m_map.for_each ([&visits](QofInstance*) { ++visits; });
+    auto map_walk = std::chrono::steady_clock::now () - start;
+    EXPECT_EQ(2 * rounds * count, visits);
+    g_hash_table_destroy (table);
+
+    std::cout << count << " instances, per round: lookups GHashTable "
+              << ms(table_lookup).count () / rounds << " ms, QofGuidMap "
+              << ms(map_lookup).count () / rounds << " ms; walks GHashTable "
+              << ms(table_walk).count () / rounds << " ms, QofGuidMap "
+              << ms(map_walk).count () / rounds << " ms\n";
+}
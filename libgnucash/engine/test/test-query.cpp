@@ -26,9 +26,12 @@ extern "C"
 #include <glib.h>
 #include "qof.h"
 #include "cashobjects.h"
+#include "Query.h"
 #include "Transaction.h"
 #include "TransLog.h"
 #include "gnc-engine.h"
+#include "gnc-query-index.h"
+#include "qofquery-p.h"
 #include "test-engine-stuff.h"
 #include "test-stuff.h"
 }
@@ -67,6 +70,210 @@ test_trans_query (Transaction *trans, gpointer data)
     return 0;
 }
 
+static gint
+compare_pointers (gconstpointer a, gconstpointer b)
+{
+    return (a < b) ? -1 : (a > b) ? 1 : 0;
+}
+
+/* Run q through the indexes and again by scanning the whole book. */
+static void
+check_index_matches_scan (QofQuery *q, const char *what)
+{
+    GList *indexed, *scanned, *a, *b;
+    gboolean same;
+
+    indexed = g_list_sort (g_list_copy (qof_query_run (q)), compare_pointers);
+    qof_query_register_index (GNC_ID_SPLIT, NULL);
+    qof_query_register_index (GNC_ID_TRANS, NULL);
+    scanned = g_list_sort (g_list_copy (qof_query_run (q)), compare_pointers);
+    gnc_query_index_register ();
+
+    same = g_list_length (indexed) == g_list_length (scanned);
+    for (a = indexed, b = scanned; same && a; a = a->next, b = b->next)
+        same = (a->data == b->data);
+
+    if (same)
+        success (what);
+    else
+        failure_args (what, __FILE__, __LINE__,
+                      "index found %d objects, scan found %d",
+                      g_list_length (indexed), g_list_length (scanned));
+    g_list_free (indexed);
+    g_list_free (scanned);
+    qof_query_destroy (q);
+}
+
+static int
+collect_trans (Transaction *trans, gpointer data)
+{
+    GList **list = static_cast<GList**>(data);
+    *list = g_list_prepend (*list, trans);
+    return 0;
+}
+
+static void
+check_indexed_queries (QofBook *book, Account *root)
+{
+    GList *trans_list = NULL;
+    Transaction *t1, *t2;
+    Split *split;
+    time64 start, end;
+    QofQuery *q, *q2;
+
+    xaccAccountTreeForEachTransaction (root, collect_trans, &trans_list);
+    if (g_list_length (trans_list) < 2)
+    {
+        g_list_free (trans_list);
+        return;
+    }
+    t1 = static_cast<Transaction*>(g_list_nth_data (trans_list, 0));
+    t2 = static_cast<Transaction*>(g_list_nth_data (trans_list, 1));
+    start = MIN (xaccTransGetDate (t1), xaccTransGetDate (t2));
+    end = MAX (xaccTransGetDate (t1), xaccTransGetDate (t2));
+    split = xaccTransGetSplit (t1, 0);
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddDateMatchTT (q, TRUE, start, TRUE, end, QOF_QUERY_AND);
+    check_index_matches_scan (q, "split date range");
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddValueMatch (q, gnc_numeric_abs (xaccSplitGetValue (split)),
+                            QOF_NUMERIC_MATCH_ANY, QOF_COMPARE_GTE,
+                            QOF_QUERY_AND);
+    check_index_matches_scan (q, "split value range");
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddSharesMatch (q, xaccSplitGetAmount (split),
+                             QOF_COMPARE_EQUAL, QOF_QUERY_AND);
+    check_index_matches_scan (q, "split amount equal");
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddDateMatchTT (q, FALSE, 0, TRUE, start, QOF_QUERY_AND);
+    q2 = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q2, book);
+    xaccQueryAddSingleAccountMatch (q2, xaccSplitGetAccount (split),
+                                    QOF_QUERY_AND);
+    xaccQueryAddDateMatchTT (q2, TRUE, end, FALSE, 0, QOF_QUERY_AND);
+    check_index_matches_scan (qof_query_merge (q, q2, QOF_QUERY_OR),
+                              "split account or date");
+    qof_query_destroy (q);
+    qof_query_destroy (q2);
+
+    q = qof_query_create_for (GNC_ID_TRANS);
+    qof_query_set_book (q, book);
+    qof_query_add_term (q, qof_query_build_param_list (TRANS_DATE_POSTED, NULL),
+                        qof_query_date_predicate (QOF_COMPARE_LTE,
+                                                  QOF_DATE_MATCH_NORMAL,
+                                                  xaccTransRetDatePostedTS (t2)),
+                        QOF_QUERY_AND);
+    check_index_matches_scan (q, "transaction date range");
+
+    g_list_free (trans_list);
+}
+
+/* Move a split to another account inside an open edit.  The accounts'
+ * split lists don't change until the commit, but the query must find
+ * the split where it now is, as a scan does. */
+static void
+check_account_match_during_edit (QofBook *book, Account *root)
+{
+    GList *trans_list = NULL, *accounts;
+    Transaction *trans;
+    Split *split;
+    Account *from, *to = NULL;
+    QofQuery *q;
+
+    xaccAccountTreeForEachTransaction (root, collect_trans, &trans_list);
+    trans = static_cast<Transaction*>(g_list_nth_data (trans_list, 0));
+    g_list_free (trans_list);
+    if (!trans || xaccTransGetReadOnly (trans))
+        return;
+    split = xaccTransGetSplit (trans, 0);
+    from = xaccSplitGetAccount (split);
+
+    accounts = gnc_account_get_descendants (root);
+    for (auto node = accounts; node && !to; node = node->next)
+        if (node->data != from)
+            to = static_cast<Account*>(node->data);
+    g_list_free (accounts);
+    if (!to)
+        return;
+
+    xaccTransBeginEdit (trans);
+    xaccSplitSetAccount (split, to);
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddSingleAccountMatch (q, to, QOF_QUERY_AND);
+    check_index_matches_scan (q, "split moved into account");
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddSingleAccountMatch (q, from, QOF_QUERY_AND);
+    check_index_matches_scan (q, "split moved out of account");
+
+    xaccTransRollbackEdit (trans);
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddSingleAccountMatch (q, to, QOF_QUERY_AND);
+    check_index_matches_scan (q, "split move rolled back");
+}
+
+/* Change dates and values after the indexes are built, and check that
+ * queries still find what a scan finds. */
+static void
+check_indexes_follow_edits (QofBook *book, Account *root)
+{
+    GList *trans_list = NULL, *node;
+    int i = 0;
+
+    check_indexed_queries (book, root);
+    check_account_match_during_edit (book, root);
+
+    xaccAccountTreeForEachTransaction (root, collect_trans, &trans_list);
+    for (node = trans_list; node; node = node->next, i++)
+    {
+        Transaction *trans = static_cast<Transaction*>(node->data);
+        Split *split = xaccTransGetSplit (trans, 0);
+
+        if (!split || xaccTransGetReadOnly (trans))
+            continue;
+        switch (i % 4)
+        {
+        case 0:
+            xaccTransBeginEdit (trans);
+            xaccTransSetDatePostedSecs (trans,
+                                        xaccTransGetDate (trans) + 86400 * i);
+            xaccTransCommitEdit (trans);
+            break;
+        case 1:
+            xaccTransBeginEdit (trans);
+            xaccSplitSetValue (split, gnc_numeric_create (i, 1));
+            xaccTransRollbackEdit (trans);
+            break;
+        case 2:
+            xaccTransBeginEdit (trans);
+            xaccSplitSetValue (split, gnc_numeric_create (i, 1));
+            xaccSplitSetAmount (split, gnc_numeric_create (i, 1));
+            xaccTransCommitEdit (trans);
+            break;
+        case 3:
+            xaccTransDestroy (trans);
+            break;
+        }
+    }
+    g_list_free (trans_list);
+
+    add_random_transactions_to_book (book, 5);
+    check_indexed_queries (book, root);
+}
+
 static void
 run_test (void)
 {
@@ -81,6 +288,7 @@ run_test (void)
     add_random_transactions_to_book (book, 20);
 
     xaccAccountTreeForEachTransaction (root, test_trans_query, book);
+    check_indexes_follow_edits (book, root);
 
     qof_session_end (session);
 }
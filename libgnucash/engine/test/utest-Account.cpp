@@ -31,6 +31,7 @@ extern "C"
 #include "../Account.h"
 #include "../AccountP.h"
 #include "../Split.h"
+#include "../SplitP.h"
 #include "../Transaction.h"
 #include "../gnc-lot.h"
 
@@ -42,7 +43,9 @@ void test_suite_account (void);
 }
 
 #include <qofinstance-p.h>
+#include <qof-backend.hpp>
 #include <kvp-frame.hpp>
+#include <vector>
 
 typedef struct
 {
@@ -1127,6 +1130,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
 
     /* Check that it works the first time */
     g_assert (gnc_account_insert_split (fixture->acct, split1));
+    g_assert (split1->member_acc == fixture->acct);
     g_assert_cmpuint (g_list_length (priv->splits), == , 1);
     g_assert (!priv->sort_dirty);
     g_assert (priv->balance_dirty);
@@ -1144,14 +1148,15 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     g_assert (priv->balance_dirty);
     test_signal_assert_hits (sig1, 2);
     test_signal_assert_hits (sig3, 1);
-    /* One more add, incrementing the editlevel to get sort_dirty set. */
+    /* One more add, incrementing the editlevel. The split still goes
+     * straight to its place, so sort_dirty stays clear. */
     test_signal_free (sig3);
     sig3 = test_signal_new (&fixture->acct->inst, GNC_EVENT_ITEM_ADDED, split3);
     qof_instance_increase_editlevel (fixture->acct);
     g_assert (gnc_account_insert_split (fixture->acct, split3));
     qof_instance_decrease_editlevel (fixture->acct);
     g_assert_cmpuint (g_list_length (priv->splits), == , 3);
-    g_assert (priv->sort_dirty);
+    g_assert (!priv->sort_dirty);
     g_assert (priv->balance_dirty);
     test_signal_assert_hits (sig1, 3);
     test_signal_assert_hits (sig3, 1);
@@ -1161,8 +1166,9 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     sig3 = test_signal_new (&fixture->acct->inst, GNC_EVENT_ITEM_REMOVED,
                             split3);
     g_assert (gnc_account_remove_split (fixture->acct, split3));
+    g_assert (split3->member_acc == NULL);
     g_assert_cmpuint (g_list_length (priv->splits), == , 2);
-    g_assert (priv->sort_dirty);
+    g_assert (!priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 4);
     test_signal_assert_hits (sig3, 1);
@@ -1170,7 +1176,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
      * already been removed */
     g_assert (!gnc_account_remove_split (fixture->acct, split3));
     g_assert_cmpuint (g_list_length (priv->splits), == , 2);
-    g_assert (priv->sort_dirty);
+    g_assert (!priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 4);
     test_signal_assert_hits (sig3, 1);
@@ -1179,6 +1185,137 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     test_signal_free (sig3);
     test_signal_free (sig1);
 }
+static void
+assert_split_list_sorted (GList *splits)
+{
+    for (auto node = splits; node && node->next; node = node->next)
+    {
+        g_assert (node->next->prev == node);
+        g_assert_cmpint (xaccSplitOrder (static_cast<Split*>(node->data),
+                                         static_cast<Split*>(node->next->data)),
+                         <, 0);
+    }
+}
+
+/* gnc_account_insert_split places each split by binary search, and
+ * xaccAccountSortSplits only moves the ones whose keys changed. */
+static void
+test_gnc_account_insert_split_order (Fixture *fixture, gconstpointer pData)
+{
+    auto book = gnc_account_get_book (fixture->acct);
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    const time64 start = 946684800; /* 2000-01-01 */
+    const guint count = 200;
+    std::vector<Transaction*> txns;
+
+    for (guint ind = 0; ind < count; ind++)
+    {
+        auto txn = xaccMallocTransaction (book);
+        auto split = xaccMallocSplit (book);
+        xaccTransBeginEdit (txn);
+        /* Out of order, with repeats */
+        xaccTransSetDatePostedSecs (txn, start + (ind * 37 % 101) * 86400);
+        xaccSplitSetParent (split, txn);
+        qof_commit_edit (QOF_INSTANCE (txn));
+        g_assert (gnc_account_insert_split (fixture->acct, split));
+        txns.push_back (txn);
+    }
+    g_assert (!priv->sort_dirty);
+    g_assert_cmpuint (g_list_length (priv->splits), ==, count);
+    assert_split_list_sorted (priv->splits);
+
+    /* Move a few transactions and let the sort put their splits back. */
+    for (auto move : {std::make_pair (3, -1), std::make_pair (50, 200),
+                      std::make_pair (120, 50)})
+    {
+        auto txn = txns[move.first];
+        xaccTransBeginEdit (txn);
+        xaccTransSetDatePostedSecs (txn, start + move.second * 86400);
+        qof_commit_edit (QOF_INSTANCE (txn));
+    }
+    gnc_account_set_sort_dirty (fixture->acct);
+    xaccAccountSortSplits (fixture->acct, TRUE);
+    g_assert (!priv->sort_dirty);
+    g_assert_cmpuint (g_list_length (priv->splits), ==, count);
+    assert_split_list_sorted (priv->splits);
+    g_assert (xaccSplitGetParent (static_cast<Split*>(priv->splits->data)) == txns[3]);
+    g_assert (xaccSplitGetParent (static_cast<Split*>(g_list_last (priv->splits)->data)) == txns[50]);
+
+    for (auto node = xaccAccountGetSplitList (fixture->acct); node; )
+    {
+        auto split = static_cast<Split*>(node->data);
+        node = node->next;
+        g_assert (gnc_account_remove_split (fixture->acct, split));
+    }
+    g_assert (priv->splits == NULL);
+}
+
+/* Changes that reorder splits without going through the split's own
+ * setters must still get the split vector re-sorted. */
+static void
+test_gnc_account_split_order_changes (Fixture *fixture, gconstpointer pData)
+{
+    auto book = gnc_account_get_book (fixture->acct);
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    const char *nums[] = {"1", "2", "3", "4", "5", "6"};
+    const guint count = G_N_ELEMENTS (nums);
+    std::vector<Transaction*> txns;
+
+    for (guint ind = 0; ind < count; ind++)
+    {
+        auto txn = xaccMallocTransaction (book);
+        auto split = xaccMallocSplit (book);
+        xaccTransBeginEdit (txn);
+        xaccTransSetDatePostedSecs (txn, 946684800);
+        xaccTransSetDateEnteredSecs (txn, 946684800);
+        xaccTransSetNum (txn, nums[ind]);
+        xaccTransSetDescription (txn, "Waldo");
+        xaccSplitSetParent (split, txn);
+        xaccSplitSetAccount (split, fixture->acct);
+        /* The split actions run the other way. */
+        xaccSplitSetAction (split, nums[count - ind - 1]);
+        qof_commit_edit (QOF_INSTANCE (txn));
+        g_assert (gnc_account_insert_split (fixture->acct, split));
+        txns.push_back (txn);
+    }
+    xaccAccountSortSplits (fixture->acct, TRUE);
+    assert_split_list_sorted (priv->splits);
+    g_assert (xaccSplitGetParent (static_cast<Split*>(priv->splits->data)) == txns[0]);
+
+    qof_book_begin_edit (book);
+    qof_instance_set (QOF_INSTANCE (book),
+                      "split-action-num-field", "t",
+                      NULL);
+    qof_book_commit_edit (book);
+    xaccAccountSortSplits (fixture->acct, TRUE);
+    assert_split_list_sorted (priv->splits);
+    g_assert (xaccSplitGetParent (static_cast<Split*>(priv->splits->data)) == txns[count - 1]);
+
+    qof_book_begin_edit (book);
+    qof_instance_set (QOF_INSTANCE (book),
+                      "split-action-num-field", "f",
+                      NULL);
+    qof_book_commit_edit (book);
+    /* Splits on the same date and num are ordered by description. */
+    xaccTransBeginEdit (txns[1]);
+    xaccTransSetNum (txns[1], "1");
+    qof_commit_edit (QOF_INSTANCE (txns[1]));
+    xaccAccountSortSplits (fixture->acct, TRUE);
+    assert_split_list_sorted (priv->splits);
+    xaccTransBeginEdit (txns[0]);
+    xaccTransSetDescription (txns[0], "Zelig");
+    qof_commit_edit (QOF_INSTANCE (txns[0]));
+    xaccAccountSortSplits (fixture->acct, TRUE);
+    assert_split_list_sorted (priv->splits);
+    g_assert (xaccSplitGetParent (static_cast<Split*>(priv->splits->data)) == txns[1]);
+
+    for (auto node = xaccAccountGetSplitList (fixture->acct); node; )
+    {
+        auto split = static_cast<Split*>(node->data);
+        node = node->next;
+        g_assert (gnc_account_remove_split (fixture->acct, split));
+    }
+}
 /* xaccAccountSortSplits
 void
 xaccAccountSortSplits (Account *acc, gboolean force)// C: 4 in 2
@@ -1958,6 +2095,292 @@ test_xaccAccountGetPresentBalance (Fixture *fixture, gconstpointer pData)
     dval = gnc_numeric_to_double (val);
     g_assert_cmpfloat (dval, == , dbal);
 }
+
+/* The balance index behind xaccAccountGetBalanceAsOfDate is checked
+ * against, and timed against, the linear split-list walk it replaced. */
+static gnc_numeric
+balance_as_of_date_by_walk (Account *acc, time64 date)
+{
+    for (auto node = xaccAccountGetSplitList (acc); node; node = node->next)
+    {
+        auto trans = xaccSplitGetParent (static_cast<Split*>(node->data));
+        if (xaccTransGetDate (trans) < date)
+            continue;
+        if (node->prev)
+            return xaccSplitGetBalance (static_cast<Split*>(node->prev->data));
+        return gnc_numeric_zero ();
+    }
+    return xaccAccountGetBalance (acc);
+}
+
+static void
+add_dated_splits (Account *acct, Account *other, guint count, time64 start)
+{
+    auto book = gnc_account_get_book (acct);
+    xaccAccountBeginEdit (acct);
+    xaccAccountBeginEdit (other);
+    for (guint ind = 0; ind < count; ind++)
+    {
+        auto txn = xaccMallocTransaction (book);
+        gnc_numeric amount = gnc_numeric_create (ind % 97 + 1, 100);
+        gnc_numeric neg_amount = gnc_numeric_neg (amount);
+        xaccTransBeginEdit (txn);
+        /* Several transactions share each day. */
+        xaccTransSetDatePostedSecs (txn, start + ind / 3 * 86400);
+        auto split1 = xaccMallocSplit (book);
+        auto split2 = xaccMallocSplit (book);
+        xaccSplitSetParent (split1, txn);
+        xaccSplitSetParent (split2, txn);
+        g_object_set (split1, "account", acct, "amount", &amount,
+                      "value", &amount, NULL);
+        g_object_set (split2, "account", other, "amount", &neg_amount,
+                      "value", &neg_amount, NULL);
+        gnc_account_insert_split (acct, split1);
+        gnc_account_insert_split (other, split2);
+        qof_commit_edit (QOF_INSTANCE (txn));
+    }
+    xaccAccountCommitEdit (acct);
+    xaccAccountCommitEdit (other);
+    xaccAccountSortSplits (acct, TRUE);
+    xaccAccountSortSplits (other, TRUE);
+    xaccAccountRecomputeBalance (acct);
+    xaccAccountRecomputeBalance (other);
+}
+
+static void
+check_balance_as_of_date_index (guint count)
+{
+    auto book = qof_book_new ();
+    auto root = gnc_account_create_root (book);
+    auto acct = xaccMallocAccount (book);
+    auto other = xaccMallocAccount (book);
+    const time64 start = 946684800; /* 2000-01-01 */
+    const time64 end = start + count / 3 * 86400;
+    const time64 step = (end - start + 2 * 86400) / 600;
+    std::vector<gnc_numeric> indexed, walked;
+    gdouble index_time, walk_time;
+
+    gnc_account_append_child (root, acct);
+    gnc_account_append_child (root, other);
+    add_dated_splits (acct, other, count, start);
+
+    g_test_timer_start ();
+    for (auto date = start - 86400; date <= end + 86400; date += step)
+        indexed.push_back (xaccAccountGetBalanceAsOfDate (acct, date));
+    index_time = g_test_timer_elapsed ();
+
+    g_test_timer_start ();
+    for (auto date = start - 86400; date <= end + 86400; date += step)
+        walked.push_back (balance_as_of_date_by_walk (acct, date));
+    walk_time = g_test_timer_elapsed ();
+
+    g_assert_cmpuint (indexed.size (), ==, walked.size ());
+    for (size_t ind = 0; ind < indexed.size (); ind++)
+        g_assert (gnc_numeric_equal (indexed[ind], walked[ind]));
+    g_assert (gnc_numeric_zero_p (xaccAccountGetBalanceAsOfDate (acct, start)));
+    g_assert (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (acct, end + 1),
+                                 xaccAccountGetBalance (acct)));
+    g_test_message ("%u splits, %" G_GSIZE_FORMAT " as-of-date lookups: index %.6fs, walk %.6fs",
+                    count, indexed.size (), index_time, walk_time);
+    qof_book_destroy (book);
+}
+
+static void
+test_xaccAccountGetBalanceAsOfDate_index (void)
+{
+    check_balance_as_of_date_index (500);
+}
+
+static void
+test_xaccAccountGetBalanceAsOfDate_perf (void)
+{
+    check_balance_as_of_date_index (200000);
+}
+
+/* A backend that sums the splits itself, giving period n a total of
+ * n + 1, so the test can see that the engine took its answer. */
+class AccountSumsMockBackend : public QofBackend
+{
+public:
+    void session_begin(QofSession*, const char*, bool, bool, bool) override {}
+    void session_end() override {}
+    void load(QofBook*, QofBackendLoadType) override {}
+    void sync(QofBook*) override {}
+    void safe_sync(QofBook*) override {}
+    bool sum_split_amounts(const QofInstance*, const std::vector<time64>& bounds,
+                           std::vector<gnc_numeric>& sums) override
+    {
+        ++m_calls;
+        sums.clear ();
+        for (size_t ind = 0; ind < bounds.size (); ind++)
+            sums.push_back (gnc_numeric_create (ind + 1, 1));
+        return true;
+    }
+    int m_calls = 0;
+};
+
+static void
+test_xaccAccountGetBalanceChangesForPeriods (void)
+{
+    auto book = qof_book_new ();
+    auto root = gnc_account_create_root (book);
+    auto acct = xaccMallocAccount (book);
+    auto other = xaccMallocAccount (book);
+    const time64 start = 946684800; /* 2000-01-01 */
+    const int n_dates = 6;
+    time64 dates[n_dates];
+    gnc_numeric changes[n_dates - 1];
+    AccountSumsMockBackend be;
+
+    gnc_account_append_child (root, acct);
+    gnc_account_append_child (root, other);
+    add_dated_splits (acct, other, 300, start);
+    for (int ind = 0; ind < n_dates; ind++)
+        dates[ind] = start - 86400 + ind * 30 * 86400;
+
+    xaccAccountGetBalanceChangesForPeriods (acct, dates, n_dates, changes);
+    for (int ind = 0; ind < n_dates - 1; ind++)
+    {
+        auto sum = gnc_numeric_zero ();
+        for (auto node = xaccAccountGetSplitList (acct); node; node = node->next)
+        {
+            auto split = static_cast<Split*>(node->data);
+            auto date = xaccTransGetDate (xaccSplitGetParent (split));
+            if (date >= dates[ind] && date < dates[ind + 1])
+                sum = gnc_numeric_add_fixed (sum, xaccSplitGetAmount (split));
+        }
+        g_assert (gnc_numeric_equal (changes[ind], sum));
+    }
+
+    /* With a backend that can sum the splits, one call answers. */
+    qof_book_set_backend (book, &be);
+    xaccAccountGetBalanceChangesForPeriods (acct, dates, n_dates, changes);
+    g_assert_cmpint (be.m_calls, ==, 1);
+    for (int ind = 0; ind < n_dates - 1; ind++)
+        g_assert (gnc_numeric_equal (changes[ind],
+                                     gnc_numeric_create (ind + 2, 1)));
+    g_assert (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (acct, start),
+                                 gnc_numeric_create (1, 1)));
+    g_assert_cmpint (be.m_calls, ==, 2);
+    qof_book_set_backend (book, nullptr);
+    qof_book_destroy (book);
+}
+
+/* Edits recompute the running balances only from the changed split
+ * onward; the result must match recomputing the whole account. */
+static std::vector<gnc_numeric>
+split_balances (Account *acc)
+{
+    std::vector<gnc_numeric> balances;
+    for (auto node = xaccAccountGetSplitList (acc); node; node = node->next)
+    {
+        auto split = static_cast<Split*>(node->data);
+        balances.push_back (xaccSplitGetBalance (split));
+        balances.push_back (xaccSplitGetClearedBalance (split));
+        balances.push_back (xaccSplitGetReconciledBalance (split));
+    }
+    return balances;
+}
+
+static void
+assert_balances_match_full_recompute (Account *acc)
+{
+    auto incremental = split_balances (acc);
+    auto balance = xaccAccountGetBalance (acc);
+    gnc_account_set_balance_dirty (acc);
+    xaccAccountRecomputeBalance (acc);
+    auto full = split_balances (acc);
+    g_assert_cmpuint (incremental.size (), ==, full.size ());
+    for (size_t ind = 0; ind < full.size (); ind++)
+        g_assert (gnc_numeric_equal (incremental[ind], full[ind]));
+    g_assert (gnc_numeric_equal (balance, xaccAccountGetBalance (acc)));
+}
+
+static void
+set_split_pair_amount (Split *split, gnc_numeric amount)
+{
+    auto txn = xaccSplitGetParent (split);
+    auto other = xaccSplitGetOtherSplit (split);
+    gnc_numeric neg_amount = gnc_numeric_neg (amount);
+    xaccTransBeginEdit (txn);
+    xaccSplitSetAmount (split, amount);
+    xaccSplitSetValue (split, amount);
+    xaccSplitSetAmount (other, neg_amount);
+    xaccSplitSetValue (other, neg_amount);
+    xaccTransCommitEdit (txn);
+}
+
+static void
+check_incremental_balance (guint count, guint edits)
+{
+    auto book = qof_book_new ();
+    auto root = gnc_account_create_root (book);
+    auto acct = xaccMallocAccount (book);
+    auto other = xaccMallocAccount (book);
+    const time64 start = 946684800; /* 2000-01-01 */
+    gdouble edit_time;
+
+    gnc_account_append_child (root, acct);
+    gnc_account_append_child (root, other);
+    add_dated_splits (acct, other, count, start);
+
+    /* Amount changes near the end, in the middle and at the start */
+    auto splits = xaccAccountGetSplitList (acct);
+    std::vector<Split*> recent;
+    for (auto node = g_list_last (splits); node && recent.size () < 10;
+         node = node->prev)
+        recent.push_back (static_cast<Split*>(node->data));
+    g_test_timer_start ();
+    for (guint ind = 0; ind < edits; ind++)
+        set_split_pair_amount (recent[ind % recent.size ()],
+                               gnc_numeric_create (ind + 1, 100));
+    edit_time = g_test_timer_elapsed ();
+    assert_balances_match_full_recompute (acct);
+    set_split_pair_amount (static_cast<Split*>(g_list_nth_data (splits, count / 2)),
+                           gnc_numeric_create (-12345, 100));
+    assert_balances_match_full_recompute (acct);
+    set_split_pair_amount (static_cast<Split*>(splits->data),
+                           gnc_numeric_create (777, 100));
+    assert_balances_match_full_recompute (acct);
+
+    /* Moving a transaction from the end into the middle */
+    auto last = static_cast<Split*>(g_list_last (splits)->data);
+    auto txn = xaccSplitGetParent (last);
+    xaccTransBeginEdit (txn);
+    xaccTransSetDatePostedSecs (txn, start + count / 6 * 86400);
+    xaccTransCommitEdit (txn);
+    xaccAccountSortSplits (acct, TRUE);
+    xaccAccountRecomputeBalance (acct);
+    assert_split_list_sorted (xaccAccountGetSplitList (acct));
+    assert_balances_match_full_recompute (acct);
+
+    /* Appending and removing a split at the end */
+    add_dated_splits (acct, other, 1, start + count * 86400);
+    assert_balances_match_full_recompute (acct);
+    last = static_cast<Split*>(g_list_last (xaccAccountGetSplitList (acct))->data);
+    txn = xaccSplitGetParent (last);
+    xaccTransBeginEdit (txn);
+    xaccTransDestroy (txn);
+    xaccTransCommitEdit (txn);
+    g_assert_cmpuint (g_list_length (xaccAccountGetSplitList (acct)), ==, count);
+    assert_balances_match_full_recompute (acct);
+
+    g_test_message ("%u splits, %u edits near the end: %.6fs",
+                    count, edits, edit_time);
+    qof_book_destroy (book);
+}
+
+static void
+test_xaccAccountRecomputeBalance_incremental (void)
+{
+    check_incremental_balance (300, 20);
+}
+
+static void
+test_xaccAccountRecomputeBalance_perf (void)
+{
+    check_incremental_balance (100000, 1000);
+}
 /*
  * xaccAccountConvertBalanceToCurrency
  * xaccAccountConvertBalanceToCurrencyAsOfDate are wrappers around
@@ -2558,6 +2981,8 @@ test_suite_account (void)
 // GNC_TEST_ADD (suitename, "xaccAcctChildrenEqual", Fixture, NULL, setup, test_xaccAcctChildrenEqual,  teardown );
 // GNC_TEST_ADD (suitename, "xaccAccountEqual", Fixture, NULL, setup, test_xaccAccountEqual,  teardown );
     GNC_TEST_ADD (suitename, "gnc account insert & remove split", Fixture, NULL, setup, test_gnc_account_insert_remove_split,  teardown );
+    GNC_TEST_ADD (suitename, "gnc account insert split order", Fixture, NULL, setup, test_gnc_account_insert_split_order,  teardown );
+    GNC_TEST_ADD (suitename, "gnc account split order changes", Fixture, NULL, setup, test_gnc_account_split_order_changes,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccount Insert and Remove Lot", Fixture, &good_data, setup, test_xaccAccountInsertRemoveLot,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance,  teardown );
     GNC_TEST_ADD_FUNC (suitename, "xaccAccountOrder", test_xaccAccountOrder );
@@ -2579,6 +3004,9 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "xaccAccountGetProjectedMinimumBalance", Fixture, &some_data, setup, test_xaccAccountGetProjectedMinimumBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetBalanceAsOfDate", Fixture, &some_data, setup, test_xaccAccountGetBalanceAsOfDate,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetPresentBalance", Fixture, &some_data, setup, test_xaccAccountGetPresentBalance,  teardown );
+    GNC_TEST_ADD_FUNC (suitename, "xaccAccountGetBalanceAsOfDate index", test_xaccAccountGetBalanceAsOfDate_index);
+    GNC_TEST_ADD_FUNC (suitename, "xaccAccountGetBalanceChangesForPeriods", test_xaccAccountGetBalanceChangesForPeriods);
+    GNC_TEST_ADD_FUNC (suitename, "xaccAccountRecomputeBalance incremental", test_xaccAccountRecomputeBalance_incremental);
     GNC_TEST_ADD (suitename, "xaccAccountFindOpenLots", Fixture, &complex_data, setup, test_xaccAccountFindOpenLots,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachLot", Fixture, &complex_data, setup, test_xaccAccountForEachLot,  teardown );
 
@@ -2592,5 +3020,10 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "xaccAccountForEachTransaction", Fixture, &complex_data, setup, test_xaccAccountForEachTransaction,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountTreeForEachTransaction", Fixture, &complex_data, setup, test_xaccAccountTreeForEachTransaction,  teardown );
 
+    if (g_test_perf ())
+    {
+        GNC_TEST_ADD_FUNC (suitename, "xaccAccountGetBalanceAsOfDate performance", test_xaccAccountGetBalanceAsOfDate_perf);
+        GNC_TEST_ADD_FUNC (suitename, "xaccAccountRecomputeBalance performance", test_xaccAccountRecomputeBalance_perf);
+    }
 
 }
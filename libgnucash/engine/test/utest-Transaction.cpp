@@ -1783,6 +1783,35 @@ test_xaccTransOrder_num_action (Fixture *fixture, gconstpointer pData)
 
     fixture->func->xaccFreeTransaction (txnB);
 }
+/* The sort keys cached by xaccTransOrder and xaccSplitOrder must follow
+ * the setters. */
+static void
+test_xaccTransOrder_sort_keys (Fixture *fixture, gconstpointer pData)
+{
+    Transaction *txnA = fixture->txn;
+    Transaction *txnB = fixture->func->dupe_trans (txnA);
+    auto split1 = static_cast<Split*>(txnA->splits->data);
+    auto split2 = static_cast<Split*>(txnA->splits->next->data);
+
+    g_assert_cmpint (xaccTransOrder (txnA, txnB), ==,
+                     qof_instance_guid_compare (txnA, txnB));
+    xaccTransSetDescription (txnA, "Zelig");
+    g_assert_cmpint (xaccTransOrder (txnA, txnB), >=, 1);
+    xaccTransSetDescription (txnA, "Annie Hall");
+    g_assert_cmpint (xaccTransOrder (txnA, txnB), <=, -1);
+    xaccTransSetNum (txnA, "124");
+    g_assert_cmpint (xaccTransOrder (txnA, txnB), ==, 1);
+    xaccTransSetNum (txnA, "122");
+    g_assert_cmpint (xaccTransOrder (txnA, txnB), ==, -1);
+
+    xaccSplitSetMemo (split1, "banana");
+    xaccSplitSetMemo (split2, "apple");
+    g_assert_cmpint (xaccSplitOrder (split1, split2), >=, 1);
+    xaccSplitSetMemo (split1, "aardvark");
+    g_assert_cmpint (xaccSplitOrder (split1, split2), <=, -1);
+
+    fixture->func->xaccFreeTransaction (txnB);
+}
 /* xaccTransSetDateInternal Local: 7:0:0
  * set_gains_date_dirty Local: 4:0:0
  * xaccTransSetDatePostedSecs C: 17 in 13  Local: 0:0:0
@@ -2005,11 +2034,80 @@ test_xaccTransScrubGainsDate_gains_dirty (GainsFixture *fixture,
  * program.
  */
 /* xaccTransFindSplitByAccount C: 7 in 5  Local: 0:0:0
- * destroy_tx_on_book_close Local: 0:1:0
- * gnc_transaction_book_end Local: 0:1:0
  * trans_is_balanced_p Local: 0:1:0
  * Trivial pass-through.
  */
+/* forget_gains_on_book_close Local: 0:1:0
+ * free_tx_on_book_close Local: 0:1:0
+ * gnc_transaction_book_end Local: 0:1:0
+ */
+class EditCountingMockBackend : public TransMockBackend
+{
+public:
+    void begin(QofInstance*) override { ++m_edits; }
+    void commit(QofInstance*) override { ++m_edits; }
+    int m_edits = 0;
+};
+
+static void
+count_dirty_cb (QofBook *book, gboolean dirty, gpointer user_data)
+{
+    ++*static_cast<int*>(user_data);
+}
+
+static void
+test_gnc_transaction_book_end (void)
+{
+    auto book = qof_book_new ();
+    auto mbe = new EditCountingMockBackend;
+    auto curr = gnc_commodity_new (book, "Gnu Rand", "CURRENCY", "GNR", "", 240);
+    auto root = gnc_account_create_root (book);
+    auto acc1 = xaccMallocAccount (book);
+    auto acc2 = xaccMallocAccount (book);
+    auto lot = gnc_lot_new (book);
+    Split *splits[4];
+    int dirty_calls = 0;
+
+    gnc_account_append_child (root, acc1);
+    gnc_account_append_child (root, acc2);
+    xaccAccountSetCommodity (acc1, curr);
+    xaccAccountSetCommodity (acc2, curr);
+    for (int i = 0; i < 4; i += 2)
+    {
+        auto txn = xaccMallocTransaction (book);
+        auto amount = gnc_numeric_create (100 * (i + 1), 240);
+        splits[i] = xaccMallocSplit (book);
+        splits[i + 1] = xaccMallocSplit (book);
+        xaccTransBeginEdit (txn);
+        xaccTransSetCurrency (txn, curr);
+        xaccSplitSetParent (splits[i], txn);
+        xaccSplitSetParent (splits[i + 1], txn);
+        xaccSplitSetAccount (splits[i], acc1);
+        xaccSplitSetAccount (splits[i + 1], acc2);
+        xaccSplitSetAmount (splits[i], amount);
+        xaccSplitSetValue (splits[i], amount);
+        xaccSplitSetAmount (splits[i + 1], gnc_numeric_neg (amount));
+        xaccSplitSetValue (splits[i + 1], gnc_numeric_neg (amount));
+        xaccTransCommitEdit (txn);
+    }
+    gnc_lot_add_split (lot, splits[0]);
+    gnc_lot_add_split (lot, splits[2]);
+    /* Gains splits point both ways across transactions. */
+    splits[0]->gains_split = splits[2];
+    splits[2]->gains_split = splits[0];
+
+    qof_book_set_backend (book, mbe);
+    qof_book_mark_session_saved (book);
+    qof_book_set_dirty_cb (book, count_dirty_cb, &dirty_calls);
+    auto sig = test_signal_new (NULL, QOF_EVENT_DESTROY, NULL);
+    qof_book_destroy (book);
+    /* Only the book itself announces its destruction. */
+    test_signal_assert_hits (sig, 1);
+    g_assert_cmpint (mbe->m_edits, ==, 0);
+    g_assert_cmpint (dirty_calls, ==, 0);
+    test_signal_free (sig);
+    delete mbe;
+}
 
 
 void
@@ -2056,11 +2154,13 @@ test_suite_transaction (void)
     GNC_TEST_ADD (suitename, "xaccTransRollbackEdit", Fixture, NULL, setup, test_xaccTransRollbackEdit, teardown);
     GNC_TEST_ADD (suitename, "xaccTransRollbackEdit - Backend Errors", Fixture, NULL, setup, test_xaccTransRollbackEdit_BackendErrors, teardown);
     GNC_TEST_ADD (suitename, "xaccTransOrder_num_action", Fixture, NULL, setup, test_xaccTransOrder_num_action, teardown);
+    GNC_TEST_ADD (suitename, "xaccTransOrder sort keys", Fixture, NULL, setup, test_xaccTransOrder_sort_keys, teardown);
     GNC_TEST_ADD (suitename, "xaccTransGetTxnType", Fixture, NULL, setup, test_xaccTransGetTxnType, teardown);
     GNC_TEST_ADD (suitename, "xaccTransVoid", Fixture, NULL, setup, test_xaccTransVoid, teardown);
     GNC_TEST_ADD (suitename, "xaccTransReverse", Fixture, NULL, setup, test_xaccTransReverse, teardown);
     GNC_TEST_ADD (suitename, "xaccTransScrubGainsDate_no_dirty", GainsFixture, NULL, setup_with_gains, test_xaccTransScrubGainsDate_no_dirty, teardown_with_gains);
     GNC_TEST_ADD (suitename, "xaccTransScrubGainsDate_base_dirty", GainsFixture, NULL, setup_with_gains, test_xaccTransScrubGainsDate_base_dirty, teardown_with_gains);
     GNC_TEST_ADD (suitename, "xaccTransScrubGainsDate_gains_dirty", GainsFixture, NULL, setup_with_gains, test_xaccTransScrubGainsDate_gains_dirty, teardown_with_gains);
+    GNC_TEST_ADD_FUNC (suitename, "gnc_transaction_book_end", test_gnc_transaction_book_end);
 
 }
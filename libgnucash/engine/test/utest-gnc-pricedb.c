@@ -1130,6 +1130,188 @@ test_gnc_pricedb_lookup_nearest_in_time (PriceDBFixture *fixture, gconstpointer
 GNCPrice *
 gnc_pricedb_lookup_latest_before (GNCPriceDB *db,// Local: 0:0:0
 */
+
+/* The lookups by time binary search a per-pair index. Check them against
+ * walks over the merged price lists like the ones the index replaced,
+ * and time both. */
+static gint
+compare_prices_newest_first (gconstpointer a, gconstpointer b)
+{
+    Timespec time_a = gnc_price_get_time ((GNCPrice*)a);
+    Timespec time_b = gnc_price_get_time ((GNCPrice*)b);
+    gint result = -timespec_cmp (&time_a, &time_b);
+    if (result) return result;
+    return guid_compare (qof_instance_get_guid (a), qof_instance_get_guid (b));
+}
+
+static GList *
+merged_price_list (GNCPriceDB *db, gnc_commodity *c, gnc_commodity *cur)
+{
+    GList *prices = g_list_concat (gnc_pricedb_get_prices (db, c, cur),
+                                   gnc_pricedb_get_prices (db, cur, c));
+    return g_list_sort (prices, compare_prices_newest_first);
+}
+
+static GNCPrice *
+nearest_in_time_by_walk (GList *prices, Timespec t)
+{
+    GNCPrice *current = prices ? prices->data : NULL, *next = NULL;
+    Timespec current_t, next_t, diff_current, diff_next, abs_current, abs_next;
+    GList *node;
+
+    for (node = prices; node; node = node->next)
+    {
+        Timespec price_t = gnc_price_get_time (node->data);
+        if (timespec_cmp (&price_t, &t) <= 0)
+        {
+            next = node->data;
+            break;
+        }
+        current = node->data;
+    }
+    if (!next)
+        return current;
+    current_t = gnc_price_get_time (current);
+    next_t = gnc_price_get_time (next);
+    diff_current = timespec_diff (&current_t, &t);
+    diff_next = timespec_diff (&next_t, &t);
+    abs_current = timespec_abs (&diff_current);
+    abs_next = timespec_abs (&diff_next);
+    return timespec_cmp (&abs_current, &abs_next) < 0 ? current : next;
+}
+
+static GNCPrice *
+latest_before_by_walk (GList *prices, Timespec t, gboolean exact)
+{
+    GList *node;
+    for (node = prices; node; node = node->next)
+    {
+        Timespec price_t = gnc_price_get_time (node->data);
+        if (timespec_cmp (&price_t, &t) <= 0)
+            return !exact || timespec_equal (&price_t, &t) ? node->data : NULL;
+    }
+    return NULL;
+}
+
+static void
+add_daily_prices (GNCPriceDB *db, gnc_commodity *c, gnc_commodity *cur,
+                  guint count, time64 start)
+{
+    QofBook *book = qof_instance_get_book (QOF_INSTANCE (db));
+    guint ind;
+
+    gnc_pricedb_set_bulk_update (db, TRUE);
+    for (ind = 0; ind < count; ind++)
+    {
+        Timespec t = {start + ind * 86400, 0};
+        gnc_numeric value = gnc_numeric_create (10000 + ind % 211, 10000);
+        /* Every fifth day there's a price the other way round too, and
+         * every seventh one at the same time as the forward price. */
+        gnc_pricedb_add_price (db, construct_price (book, c, cur, t,
+                                                    PRICE_SOURCE_FQ, value));
+        if (ind % 5 == 0)
+        {
+            Timespec rt = {t.tv_sec + (ind % 7 == 0 ? 0 : 3600), 0};
+            gnc_pricedb_add_price (db, construct_price (book, cur, c, rt,
+                                                        PRICE_SOURCE_FQ,
+                                                        gnc_numeric_invert (value)));
+        }
+    }
+    gnc_pricedb_set_bulk_update (db, FALSE);
+}
+
+static void
+check_lookups_by_time (GNCPriceDB *db, gnc_commodity *c, gnc_commodity *cur,
+                       time64 start, guint days, guint step)
+{
+    GList *prices = merged_price_list (db, c, cur);
+    gdouble index_time, walk_time;
+    time64 secs;
+    guint lookups = 0;
+
+    g_test_timer_start ();
+    for (secs = start - 86400; secs < start + (days + 1) * 86400; secs += step)
+    {
+        Timespec t = {secs, 0};
+        gnc_price_unref (gnc_pricedb_lookup_nearest_in_time (db, c, cur, t));
+        gnc_price_unref (gnc_pricedb_lookup_latest_before (db, c, cur, t));
+        gnc_price_unref (gnc_pricedb_lookup_at_time (db, c, cur, t));
+        lookups++;
+    }
+    index_time = g_test_timer_elapsed ();
+
+    g_test_timer_start ();
+    for (secs = start - 86400; secs < start + (days + 1) * 86400; secs += step)
+    {
+        Timespec t = {secs, 0};
+        nearest_in_time_by_walk (prices, t);
+        latest_before_by_walk (prices, t, FALSE);
+        latest_before_by_walk (prices, t, TRUE);
+    }
+    walk_time = g_test_timer_elapsed ();
+
+    for (secs = start - 86400; secs < start + (days + 1) * 86400; secs += step)
+    {
+        Timespec t = {secs, 0};
+        GNCPrice *nearest = gnc_pricedb_lookup_nearest_in_time (db, c, cur, t);
+        GNCPrice *before = gnc_pricedb_lookup_latest_before (db, c, cur, t);
+        GNCPrice *at_time = gnc_pricedb_lookup_at_time (db, c, cur, t);
+        g_assert (nearest == nearest_in_time_by_walk (prices, t));
+        g_assert (before == latest_before_by_walk (prices, t, FALSE));
+        g_assert (at_time == latest_before_by_walk (prices, t, TRUE));
+        gnc_price_unref (nearest);
+        gnc_price_unref (before);
+        gnc_price_unref (at_time);
+    }
+    g_test_message ("%u prices, %u lookups of each kind: index %.6fs, walk %.6fs",
+                    g_list_length (prices), lookups, index_time, walk_time);
+    gnc_price_list_destroy (prices);
+}
+
+static void
+test_gnc_pricedb_lookup_by_time_index (PriceDBFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    gnc_commodity *eur = fixture->com->eur, *gbp = fixture->com->gbp;
+    const time64 start = 1262347200; /* 2010-01-01 12:00 UTC */
+    GList *prices, *node;
+    guint ind;
+
+    add_daily_prices (db, eur, gbp, 400, start);
+    check_lookups_by_time (db, eur, gbp, start, 400, 7919);
+    check_lookups_by_time (db, gbp, eur, start, 400, 86400);
+
+    /* Removing and moving prices has to keep the index in step. */
+    prices = gnc_pricedb_get_prices (db, eur, gbp);
+    for (node = prices, ind = 0; node; node = node->next, ind++)
+    {
+        GNCPrice *p = node->data;
+        if (ind % 3 == 0)
+            gnc_pricedb_remove_price (db, p);
+        else if (ind % 3 == 1)
+        {
+            Timespec t = gnc_price_get_time (p);
+            t.tv_sec += 43200;
+            gnc_price_set_time (p, t);
+        }
+    }
+    gnc_price_list_destroy (prices);
+    check_lookups_by_time (db, eur, gbp, start, 400, 7919);
+    g_assert (gnc_pricedb_lookup_nearest_in_time (db, eur, fixture->com->dkk,
+                                                  timespec_now ()) == NULL);
+}
+
+static void
+test_gnc_pricedb_lookup_by_time_perf (PriceDBFixture *fixture, gconstpointer pData)
+{
+    GNCPriceDB *db = fixture->pricedb;
+    const time64 start = 1262347200; /* 2010-01-01 12:00 UTC */
+    const guint days = 2500;
+
+    add_daily_prices (db, fixture->com->eur, fixture->com->gbp, days, start);
+    check_lookups_by_time (db, fixture->com->eur, fixture->com->gbp,
+                           start, days, 86400 / 4);
+}
 /* direct_balance_conversion
 static gnc_numeric
 direct_balance_conversion (GNCPriceDB *db, gnc_numeric bal,// Local: 2:0:0
@@ -1236,6 +1418,85 @@ test_gnc_pricedb_convert_balance_nearest_price (PriceDBFixture *fixture, gconstp
     g_assert_cmpint(result.denom, ==, 100);
 
 }
+
+/* gnc_pricedb_convert_balances_nearest_price
+void
+gnc_pricedb_convert_balances_nearest_price(GNCPriceDB *pdb,// Local: 0:0:0
+*/
+/* Each batch result has to match the one-at-a-time conversion. */
+static void
+check_convert_balances (GNCPriceDB *db, GNCPriceConversion *conv, guint n,
+                        const gnc_commodity *to)
+{
+    gnc_numeric *single = g_new (gnc_numeric, n);
+    gdouble single_time, batch_time;
+    guint ind;
+
+    g_test_timer_start ();
+    for (ind = 0; ind < n; ind++)
+        single[ind] =
+            gnc_pricedb_convert_balance_nearest_price (db, conv[ind].balance,
+                                                       conv[ind].commodity,
+                                                       to, conv[ind].time);
+    single_time = g_test_timer_elapsed ();
+
+    g_test_timer_start ();
+    gnc_pricedb_convert_balances_nearest_price (db, conv, n, to);
+    batch_time = g_test_timer_elapsed ();
+
+    for (ind = 0; ind < n; ind++)
+        g_assert (gnc_numeric_equal (conv[ind].result, single[ind]));
+    g_test_message ("%u conversions: one at a time %.6fs, batch %.6fs",
+                    n, single_time, batch_time);
+    g_free (single);
+}
+
+static void
+test_gnc_pricedb_convert_balances_nearest_price (PriceDBFixture *fixture, gconstpointer pData)
+{
+    Commodities *c = fixture->com;
+    const gnc_commodity *from[] = {c->usd, c->gbp, c->amzn, c->eur, c->dkk,
+                                   c->aud, c->bgn};
+    const guint n_from = G_N_ELEMENTS (from), n_dates = 40;
+    GNCPriceConversion conv[G_N_ELEMENTS (from) * 40];
+    guint ind;
+
+    /* Every two months or so from 2007 to 2015, interleaved so that the
+     * batch has to sort them. */
+    for (ind = 0; ind < G_N_ELEMENTS (conv); ind++)
+    {
+        conv[ind].commodity = from[ind % n_from];
+        conv[ind].balance = gnc_numeric_create (ind % 11 ? 10000 + ind : 0, 100);
+        conv[ind].time = gnc_dmy2timespec (1 + ind % 28,
+                                           1 + (ind * 7 / n_from) % 12,
+                                           2007 + (ind * 13 % n_dates) / 5);
+    }
+    check_convert_balances (fixture->pricedb, conv, G_N_ELEMENTS (conv), c->aud);
+    check_convert_balances (fixture->pricedb, conv, G_N_ELEMENTS (conv), c->usd);
+    check_convert_balances (fixture->pricedb, conv, G_N_ELEMENTS (conv), c->gbp);
+}
+
+static void
+test_gnc_pricedb_convert_balances_perf (PriceDBFixture *fixture, gconstpointer pData)
+{
+    Commodities *c = fixture->com;
+    const time64 start = 1262347200; /* 2010-01-01 12:00 UTC */
+    const guint days = 2500, n = 20000;
+    GNCPriceConversion *conv = g_new (GNCPriceConversion, n);
+    guint ind;
+
+    add_daily_prices (fixture->pricedb, c->eur, c->gbp, days, start);
+    add_daily_prices (fixture->pricedb, c->dkk, c->gbp, days, start);
+    for (ind = 0; ind < n; ind++)
+    {
+        conv[ind].commodity = ind % 2 ? c->eur : c->dkk;
+        conv[ind].balance = gnc_numeric_create (10000 + ind, 100);
+        conv[ind].time.tv_sec = start + (ind * 7919 % days) * 86400 + ind % 86400;
+        conv[ind].time.tv_nsec = 0;
+    }
+    check_convert_balances (fixture->pricedb, conv, n, c->gbp);
+    g_free (conv);
+}
 /* pricedb_foreach_pricelist
 static void
 pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)// Local: 0:1:0
@@ -1486,12 +1747,14 @@ test_suite_gnc_pricedb (void)
     GNC_TEST_ADD (suitename, "gnc pricedb lookup day", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_day, teardown);
 // GNC_TEST_ADD (suitename, "lookup nearest in time", Fixture, NULL, setup, test_lookup_nearest_in_time, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup nearest in time", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_nearest_in_time, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb lookup by time index", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_by_time_index, teardown);
 // GNC_TEST_ADD (suitename, "direct balance conversion", Fixture, NULL, setup, test_direct_balance_conversion, teardown);
 // GNC_TEST_ADD (suitename, "extract common prices", Fixture, NULL, setup, test_extract_common_prices, teardown);
 // GNC_TEST_ADD (suitename, "convert balance", Fixture, NULL, setup, test_convert_balance, teardown);
 // GNC_TEST_ADD (suitename, "indirect balance conversion", Fixture, NULL, setup, test_indirect_balance_conversion, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb convert balance latest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_latest_price, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb convert balance nearest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_nearest_price, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb convert balances nearest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balances_nearest_price, teardown);
 // GNC_TEST_ADD (suitename, "pricedb foreach pricelist", Fixture, NULL, setup, test_pricedb_foreach_pricelist, teardown);
 // GNC_TEST_ADD (suitename, "pricedb foreach currencies hash", Fixture, NULL, setup, test_pricedb_foreach_currencies_hash, teardown);
 // GNC_TEST_ADD (suitename, "unstable price traversal", Fixture, NULL, setup, test_unstable_price_traversal, teardown);
@@ -1513,4 +1776,10 @@ test_suite_gnc_pricedb (void)
 // GNC_TEST_ADD (suitename, "price printable", Fixture, NULL, setup, test_price_printable, teardown);
 // GNC_TEST_ADD (suitename, "gnc pricedb register", Fixture, NULL, setup, test_gnc_pricedb_register, teardown);
 
+    if (g_test_perf ())
+    {
+        GNC_TEST_ADD (suitename, "gnc pricedb lookup by time performance", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_by_time_perf, teardown);
+        GNC_TEST_ADD (suitename, "gnc pricedb convert balances performance", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balances_perf, teardown);
+    }
+
 }